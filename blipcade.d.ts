@@ -46,12 +46,42 @@ declare global {
         /**
          * Draws a sprite on the canvas.
          */
-        function drawSprite(x: number, y: number, spriteIndex: number, spriteSheet?: string, flipX?: boolean, flipY?: boolean): void;
+        function drawSprite(x: number, y: number, spriteIndex: number, spriteSheet?: string, flipX?: boolean, flipY?: boolean, paletteRow?: number): void;
 
         /**
          * Draws a sprite on the canvas.
          */
-        function drawSpriteEx(x: number, y: number, spriteIndex: number, spriteSheet?: string, flipX?: boolean, flipY?: boolean, scale?: number, originX?: number, originY?: number): void;
+        function drawSpriteEx(x: number, y: number, spriteIndex: number, spriteSheet?: string, flipX?: boolean, flipY?: boolean, scale?: number, originX?: number, originY?: number, paletteRow?: number): void;
+
+        /**
+         * Starts recording a cached layer. Draw calls until `endLayer` go into the layer, in world coordinates. Returns `false` while the layer still holds valid content, in which case nothing should be drawn and `endLayer` need not be called. Changing the layer rect invalidates it.
+         */
+        function beginLayer(layer: number, x?: number, y?: number, width?: number, height?: number): boolean;
+
+        /**
+         * Finishes recording the layer started by `beginLayer`; later draw calls go to the screen again.
+         */
+        function endLayer(): void;
+
+        /**
+         * Draws a cached layer at its world position, offset by the camera. Does nothing if the layer has not been recorded.
+         */
+        function drawLayer(layer: number): void;
+
+        /**
+         * Marks a cached layer as stale, so the next `beginLayer` records it again.
+         */
+        function invalidateLayer(layer?: number): void;
+
+        /**
+         * Only re-composites the parts of the frame whose draw calls changed since the previous frame. `draw()` still runs every frame; lighting, post-processing (unless the shader uses `TIME`) and the software canvas upload are limited to the changed region, and skipped entirely when nothing changed. Suited to mostly static screens.
+         */
+        function setPartialRedraw(enabled?: boolean): void;
+
+        /**
+         * Registers a palette remap and returns its palette row, to be passed to `drawSprite`/`drawSpriteEx`. Identical remaps share a row, so sprites drawn with different remaps still batch together. Up to 64 rows exist; past that the least recently used row is handed to the new remap, so a kept row can end up showing another remap. Asking again each frame is cheap and always safe. A row that was never returned draws with the plain palette.
+         */
+        function createPaletteRemap(pairs: any[]): number;
 
         /**
          * Puts a pixel on the canvas.
@@ -79,10 +109,23 @@ declare global {
         function drawCircle(center_x: number, center_y: number, radius: number, color: number, params: object): void;
 
         /**
-         * Sets the postprocessing shader.
+         * Sets the postprocessing shader, replacing any chain. Compiled shaders are cached, so switching
+         * back to a shader that was used or precompiled before does not recompile it.
          */
         function setPostprocessingShader(shaderPath: string): void;
 
+        /**
+         * Runs several postprocessing shaders one after another, each reading the previous one's output.
+         * An empty array shows the frame unchanged.
+         */
+        function setPostprocessingChain(shaderPaths: any[]): void;
+
+        /**
+         * Compiles a postprocessing shader without using it, so a later `setPostprocessingShader` or
+         * `setPostprocessingChain` with it is instant. Call it at load time.
+         */
+        function precompilePostprocessingShader(shaderPath: string): void;
+
     }
 
     namespace Lighting {
@@ -182,6 +225,46 @@ declare global {
          */
         function checkCollisionPoint(x: number, y: number, resourcePath: string): boolean;
 
+        /**
+         * Checks many points against one collider in a single call.
+         */
+        function checkCollisionPoints(points: any[], resourcePath: string): any[];
+
+        /**
+         * Places a collider into the collision world, so it can be found by `queryPoint`, `queryRect` and `querySegment`. The same collider resource can be placed several times.
+         */
+        function addBody(resourcePath: string, x?: number, y?: number): number;
+
+        /**
+         * Removes a body from the collision world.
+         */
+        function removeBody(id: number): void;
+
+        /**
+         * Moves a body in the collision world.
+         */
+        function setBodyPosition(id: number, x: number, y: number): void;
+
+        /**
+         * Removes every body from the collision world, e.g. when a level is unloaded.
+         */
+        function clearBodies(): void;
+
+        /**
+         * Finds every body in the collision world containing the point.
+         */
+        function queryPoint(x: number, y: number): any[];
+
+        /**
+         * Finds every body in the collision world overlapping the rectangle.
+         */
+        function queryRect(x: number, y: number, width: number, height: number): any[];
+
+        /**
+         * Finds every body in the collision world touched by the segment.
+         */
+        function querySegment(x1: number, y1: number, x2: number, y2: number): any[];
+
     }
 
     namespace Pathfinding {
@@ -195,18 +278,68 @@ declare global {
          */
         function getNavMesh(resourcePath: string): any[];
 
+        /**
+         * Gets the path cache counters of the navigation mesh. Repeated `findPath` queries between the same regions and points are served from this cache.
+         */
+        function getPathCacheStats(navigationMeshPath: string): object;
+
+        /**
+         * Builds the hierarchical layer of the navigation mesh. Long-distance `findPath` queries then search the cluster graph first and refine locally. Meshes with 64 or more regions get one automatically on load.
+         */
+        function buildNavMeshHierarchy(navigationMeshPath: string, maxClusterSize?: number): number;
+
+        /**
+         * Finds the first navigation mesh boundary edge crossed between the two points.
+         */
+        function raycastNavMesh(x1: number, y1: number, x2: number, y2: number, navigationMeshPath: string): object;
+
+        /**
+         * Checks whether the straight segment between the two points stays clear of the navigation mesh boundary.
+         */
+        function hasLineOfSight(x1: number, y1: number, x2: number, y2: number, navigationMeshPath: string): boolean;
+
+        /**
+         * Moves a circle from the start to the end point and finds where it first touches the navigation mesh boundary.
+         */
+        function sweepCircleNavMesh(x1: number, y1: number, x2: number, y2: number, radius: number, navigationMeshPath: string): object;
+
     }
 
     namespace Sound {
+        /**
+         * Gets what the audio engine measured about itself since it started or was last reset. Times are in
+         * milliseconds. `callbackHistogram` counts mixer callbacks by the share of their budget they took (the time their
+         * audio takes to play): each bucket holds callbacks `below` its bound, the last one those over budget. `load` is
+         * mixing time over mixed time, `underruns` the callbacks over budget (heard as gaps), `streamUnderruns` the
+         * blocks music ran short, and `buses` the effect time of every bus. `JSON.stringify` the result to log it.
+         * `worstCallbackTime`, `load`, `underruns`, `streamUnderruns`, `activeVoices`, `peakVoices`, `culledVoices`,
+         * `maxVoices`, `stolenVoices`, `droppedVoices`, `droppedCommands`, `headless`, `musicPlaying` and `buses`.
+         */
+        function getStats(): object;
+
+        /**
+         * Zeroes the audio engine's counters, histogram and peaks, e.g. to measure one scene on its own.
+         */
+        function resetStats(): void;
+
         /**
          * Loads a sound file.
          */
         function loadSound(path: string): number;
 
         /**
-         * Plays a sound.
+         * Plays a sound. Each call starts a new instance, so the same sound can overlap itself.
+         */
+        function playSound(soundId: number, volume?: number, pan?: number, pitch?: number, loop?: boolean, delay?: number): number;
+
+        /**
+         * Plays a sound at a point in the world. It is louder the closer it is to the middle of the screen
+         * and panned to the side it is on, following the camera. Out of range it costs no mixing time. Entities with an
+         * `AudioEmitter` component (`{sound, x, y, radius, falloff, volume, loop}`, `radius` defaulting to the canvas width)
+         * get such a voice automatically; a looping one is restarted if another sound steals its voice, trying again
+         * every 30 frames while none is free.
          */
-        function playSound(soundId: number): void;
+        function playSoundAt(soundId: number, x: number, y: number, radius: number, falloff?: number, volume?: number, loop?: boolean): number;
 
         /**
          * Stops a sound.
@@ -218,11 +351,111 @@ declare global {
          */
         function toggleSound(soundId: number): void;
 
+        /**
+         * Stops one playing instance of a sound. Does nothing if it already ended.
+         */
+        function stopVoice(voiceId: number): void;
+
+        /**
+         * Changes one playing instance of a sound. Does nothing if it already ended.
+         */
+        function setVoiceParams(voiceId: number, volume: number, pan?: number, pitch?: number): void;
+
+        /**
+         * Moves a sound played with `playSoundAt`. Does nothing for other instances or if it already ended.
+         */
+        function setVoicePosition(voiceId: number, x: number, y: number): void;
+
         /**
          * Sets the volume of a sound.
          */
         function setSoundVolume(soundId: number, volume: number): void;
 
+        /**
+         * Creates a mixer bus, e.g. a shared room reverb that sounds send to. `music`, `sfx`, `ambience` and
+         * `ui` always exist. Creating a bus whose name is taken returns the existing one.
+         */
+        function createBus(name: string): number;
+
+        /**
+         * Looks up a mixer bus by name. Every function taking a bus also accepts its name directly.
+         */
+        function getBus(name: string): number;
+
+        /**
+         * Sets the volume of everything playing through a bus.
+         */
+        function setBusVolume(bus: number | string, volume: number): void;
+
+        /**
+         * echo: `delay` (seconds, up to 2), `feedback` (-0.95 to 0.95), `mix` (0 to 1). lowpass: `cutoff` (Hz).
+         * compressor: `threshold` (dB), `ratio`, `attack` and `release` (seconds), `makeup` (dB).
+         * Appends an effect to a bus. Effects run in the order they were added. Out-of-range parameters are
+         * clamped; parameters that are not finite numbers throw.
+         */
+        function addBusEffect(bus: number | string, type: string, params?: object): void;
+
+        /**
+         * Removes every effect from a bus.
+         */
+        function clearBusEffects(bus: number | string): void;
+
+        /**
+         * Routes future instances of a sound to a bus. Sounds start on `sfx`.
+         */
+        function setSoundBus(soundId: number, bus: number | string): void;
+
+        /**
+         * Sends future instances of a sound to a second bus as well, e.g. a room reverb shared by all
+         * sounds in the room.
+         */
+        function setSoundSend(soundId: number, bus: number | string, level: number): void;
+
+        /**
+         * Changes a send of one playing instance.
+         */
+        function setVoiceSend(voiceId: number, bus: number | string, level: number): void;
+
+        /**
+         * Streams a music track on the music bus, decoding it in the background instead of loading it
+         * whole. Replaces the current track.
+         */
+        function playMusic(path: string, loop?: boolean, fade?: number, volume?: number): void;
+
+        /**
+         * Stops the current music track.
+         */
+        function stopMusic(fade?: number): void;
+
+        /**
+         * Changes the volume of the current music track.
+         */
+        function setMusicVolume(volume: number): void;
+
+        /**
+         * Checks whether a music track is playing.
+         */
+        function isMusicPlaying(): boolean;
+
+        /**
+         * `duty` (share of a square period spent high, 0.01 to 0.99), `attack`, `decay` and `release` (seconds, up to
+         * 30), `sustain` (level, 0 to 1), `slide` (semitones per second), `arpeggio` (Array of up to 8 semitone offsets),
+         * `arpeggioRate` (steps per second, up to 1000), `volume` and `bus` (ID or name, `sfx` by default).
+         * Creates a synth instrument. Its notes are generated by the mixer, so sound effects need no sample
+         * files. Out-of-range settings are clamped; settings that are not finite numbers throw.
+         */
+        function createInstrument(params?: object): number;
+
+        /**
+         * Plays a note on a synth instrument.
+         */
+        function playNote(instrumentId: number, note: number | string, duration?: number, volume?: number, pan?: number, delay?: number): number;
+
+        /**
+         * Plays a run of notes, each scheduled to the sample, like a fantasy console sound effect.
+         */
+        function playSequence(instrumentId: number, notes: any[], step?: number, volume?: number, delay?: number): void;
+
     }
 
     interface AddlighteffectParamsParams {
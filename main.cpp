@@ -1,3 +1,7 @@
+#include <cstdlib>
+#include <cstring>
+#include <headless.h>
+#include <iostream>
 #include <renderer.h>
 #include <quickjs.hpp>
 #include <runtime.h>
@@ -20,7 +24,36 @@ static constexpr uint32_t HEIGHT = 240;
 
 static constexpr uint32_t SCALE = 3;
 
-int main() {
+// blipcade_cmake --headless [--frames N] [--output frame.png]
+//   Runs N frames (default 1) on the software canvas without opening a window and writes the last one as a PNG
+int main(const int argc, char **argv) {
+    bool headless = false;
+    long frames = 1;
+    std::string output = "frame.png";
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--headless [--frames N] [--output frame.png]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (headless) {
+        if (frames < 1) {
+            std::cerr << "--frames must be at least 1" << std::endl;
+            return 1;
+        }
+
+        const blipcade::graphics::Headless runner(WIDTH, HEIGHT);
+        return runner.run(static_cast<uint32_t>(frames), output) ? 0 : 1;
+    }
+
     const auto renderer = new blipcade::graphics::Renderer(WIDTH, HEIGHT, SCALE);
 
     renderer->createWindow();
@@ -4,149 +4,258 @@
 
 #include "audio.h"
 
-#include <echo.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <reverb.h>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
 
 // It is definitely the most basic v1.0 implementation of the Audio class.
 namespace blipcade::audio {
-    static int soundCount = 0;
-    Reverb reverb(1.0f, 0.1f);
-    Echo echo(0.1f, 0.5f, 0.5f);
+    Audio *Audio::streamOwner = nullptr;
 
-    void generateSamples(void *buffer, unsigned int frames) {
-        float *d = (float *) buffer;
+    // Runs on the audio device thread whenever the stream needs more frames
+    void Audio::streamCallback(void *buffer, const unsigned int frames) {
+        if (streamOwner) {
+            streamOwner->mixer.render(static_cast<float *>(buffer), frames);
+        }
+    }
 
-        for (unsigned int i = 0; i < frames; i++) {
-            // Make this sine wave louder
-            // d[i] = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-            d[i] = d[i] * 0.1f;
+    Audio::Audio() {
+        if (!IsAudioDeviceReady()) {
+            std::cerr << "Audio device is not ready, mixing headless" << std::endl;
+            offline = std::make_unique<OfflineRenderer>(mixer);
+            return;
         }
+
+        // raylib callbacks carry no user data, so the mixer is reached through the one stream owner
+        streamOwner = this;
+
+        stream = LoadAudioStream(Mixer::SAMPLE_RATE, 32, Mixer::CHANNELS);
+        SetAudioStreamCallback(stream, streamCallback);
+        PlayAudioStream(stream);
     }
 
-    // Cycles per second (hz)
-    float frequency = 440.0f;
+    Audio::~Audio() {
+        if (streamOwner == this) {
+            UnloadAudioStream(stream);
+            streamOwner = nullptr;
+        }
+    }
 
-    // Audio frequency, for smoothing
-    float audioFrequency = 440.0f;
+    SoundHandle Audio::LoadSound(const std::string &path) {
+        // Levels load the same files again, so each is decoded and converted once
+        if (const auto cached = sampleCache.find(path); cached != sampleCache.end()) {
+            return mixer.addSound(cached->second);
+        }
 
-    // Previous value, used to test if sine needs to be rewritten, and to smoothly modulate frequency
-    float oldFrequency = 1.0f;
+        const auto wave = ::LoadWave(path.c_str());
+        if (wave.frameCount == 0) {
+            throw std::runtime_error("Failed to load sound: " + path);
+        }
 
-    // Index for audio rendering
-    float sineIdx = 0.0f;
+        // Normalized floats whatever the file's bit depth, then resampled to the device rate
+        float *samples = ::LoadWaveSamples(wave);
+        auto data = Mixer::convertSamples(samples, wave.frameCount, wave.channels, wave.sampleRate);
 
-    // Audio input processing callback
-    void AudioInputCallback(void *buffer, unsigned int frames) {
-        audioFrequency = frequency + (audioFrequency - frequency) * 0.95f;
-        float incr = audioFrequency / 48000.0f;
+        ::UnloadWaveSamples(samples);
+        ::UnloadWave(wave);
 
-        // Stereo sine
-        for (unsigned int i = 0; i < frames * 2; i += 2) {
-            ((float *) buffer)[i] = sinf(2 * PI * sineIdx); // Range -1.0f to 1.0f
-            ((float *) buffer)[i + 1] = sinf(2 * PI * sineIdx); // Range -1.0f to 1.0f
+        sampleCache.emplace(path, data);
+        return mixer.addSound(std::move(data));
+    }
 
-            sineIdx += incr;
-            if (sineIdx > 1.0f) sineIdx -= 1.0f;
+    uint64_t Audio::startFrame(const float delay) const {
+        // Also catches NaN, which compares false either way
+        if (!(delay > 0.0f) || !std::isfinite(delay)) {
+            return 0;
         }
 
-        // Instead of stereo sine, this crap should be a mixer.
+        const auto frames = std::min(static_cast<double>(delay) * Mixer::SAMPLE_RATE, MAX_DELAY_FRAMES);
+        return mixer.getTime() + static_cast<uint64_t>(frames);
     }
 
-    static float *delayBuffer = NULL;
-    static unsigned int delayBufferSize = 0;
-    static unsigned int delayReadIndex = 2;
-    static unsigned int delayWriteIndex = 0;
-    // Allocate buffer for the delay effect
+    VoiceHandle Audio::PlaySound(const SoundHandle sound, const VoiceParams &params, const float delay) {
+        return mixer.play(sound, params, startFrame(delay));
+    }
 
-    static void AudioProcessEffectDelay(void *buffer, unsigned int frames) {
-        for (unsigned int i = 0; i < frames * 2; i += 2) {
-            float leftDelay = delayBuffer[delayReadIndex++]; // ERROR: Reading buffer -> WHY??? Maybe thread related???
-            float rightDelay = delayBuffer[delayReadIndex++];
+    VoiceHandle Audio::PlaySoundAt(const SoundHandle sound, const Emitter &emitter, const VoiceParams &params,
+                                   const float delay) {
+        return mixer.playAt(sound, emitter, params, startFrame(delay));
+    }
 
-            if (delayReadIndex == delayBufferSize) delayReadIndex = 0;
+    void Audio::SetVoicePosition(const VoiceHandle voice, const float x, const float y) {
+        mixer.setVoicePosition(voice, x, y);
+    }
 
-            ((float *) buffer)[i] = 0.5f * ((float *) buffer)[i] + 0.5f * leftDelay;
-            ((float *) buffer)[i + 1] = 0.5f * ((float *) buffer)[i + 1] + 0.5f * rightDelay;
+    void Audio::SetListener(const float x, const float y, const float panWidth) {
+        mixer.setListener(x, y, panWidth);
+    }
 
-            delayBuffer[delayWriteIndex++] = ((float *) buffer)[i];
-            delayBuffer[delayWriteIndex++] = ((float *) buffer)[i + 1];
-            if (delayWriteIndex == delayBufferSize) delayWriteIndex = 0;
+    void Audio::ToggleSound(const SoundHandle sound) {
+        if (mixer.isSoundPlaying(sound)) {
+            mixer.stopSound(sound);
+        } else {
+            mixer.play(sound);
         }
     }
 
-    static Echo echoEff(0.1f, 0.5f, 0.5f);
-
-    static void EffectChain(void *buffer, unsigned int frames) {
-        // Process audio buffer with reverb effect
-        // reverb.ProcessAudioEffect(buffer, frames);
+    void Audio::StopSound(const SoundHandle sound) {
+        mixer.stopSound(sound);
+    }
 
-        // Process audio buffer with echo effect
-        // echo.ProcessAudioEffect(buffer, frames);
+    void Audio::SetSoundVolume(const SoundHandle sound, const float volume) {
+        mixer.setSoundGain(sound, volume);
+    }
 
-        echoEff.AudioProcessEffectDelay(buffer, frames);
+    void Audio::StopVoice(const VoiceHandle voice) {
+        mixer.stop(voice);
     }
 
-    Audio::Audio() {
-        // delayBufferSize = 48000 * 2; // 1 second delay (device sampleRate*channels)
-        // delayBuffer = (float *) RL_CALLOC(delayBufferSize, sizeof(float));
+    bool Audio::IsVoicePlaying(const VoiceHandle voice) const {
+        return mixer.isVoicePlaying(voice);
+    }
 
-        // AudioStream fuck = LoadAudioStream(48000, 32, 2);
+    void Audio::SetVoiceParams(const VoiceHandle voice, const float volume, const float pan, const float pitch) {
+        mixer.setVoiceParams(voice, volume, pan, pitch);
+    }
 
-        // auto wave = ::LoadWave("resources/music1.mp3");
+    BusHandle Audio::CreateBus(const std::string &name) {
+        return mixer.createBus(name);
+    }
 
-        // SetAudioStreamCallback(fuck, AudioInputCallback);
+    BusHandle Audio::FindBus(const std::string &name) const {
+        return mixer.findBus(name);
+    }
 
-        // PlayAudioStream(fuck);
+    void Audio::SetBusVolume(const BusHandle bus, const float volume) {
+        mixer.setBusGain(bus, volume);
+    }
 
-        // Music music = LoadMusicStream("resources/music-1.mp3");
-        // PlayMusicStream(music);
-        // AttachAudioStreamProcessor(music.stream, AudioProcessEffectDelay); // This works
+    void Audio::AddBusEffect(const BusHandle bus, std::unique_ptr<Effect> effect) {
+        mixer.addBusEffect(bus, std::move(effect));
+    }
 
-        // AttachAudioStreamProcessor(music.stream, EffectChain); // This does not
+    void Audio::ClearBusEffects(const BusHandle bus) {
+        mixer.clearBusEffects(bus);
+    }
 
-        // musicStream = fuck;
+    void Audio::SetSoundBus(const SoundHandle sound, const BusHandle bus) {
+        mixer.setSoundBus(sound, bus);
     }
 
-    Audio::~Audio() {
-        std::cout << "Audio destructor" << std::endl;
-        // CloseAudioStream(stream);
+    void Audio::SetSoundSend(const SoundHandle sound, const BusHandle bus, const float level) {
+        mixer.setSoundSend(sound, bus, level);
     }
 
-    SoundHandle Audio::LoadSound(const std::string &path) {
-        auto sound = ::LoadSound(path.c_str());
+    void Audio::SetVoiceSend(const VoiceHandle voice, const BusHandle bus, const float level) {
+        mixer.setVoiceSend(voice, bus, level);
+    }
 
-        // AttachAudioStreamProcessor(sound.stream, AudioProcessEffectDelay);
+    InstrumentHandle Audio::CreateInstrument(const Instrument &instrument, const BusHandle bus) {
+        return mixer.addInstrument(instrument, bus);
+    }
 
-        // unsigned int sampleSize;    // Bit depth (bits per sample): 8, 16, 32 (24 not supported)
+    VoiceHandle Audio::PlayNote(const InstrumentHandle instrument, const float note, const float duration,
+                                const VoiceParams &params, const float delay) {
+        return mixer.playNote(instrument, note, duration, params, startFrame(delay));
+    }
 
-        std::cout << "Sample rate: " << sound.stream.sampleRate << std::endl;
-        std::cout << "Sample size: " << sound.stream.sampleSize << std::endl;
+    void Audio::PlaySequence(const InstrumentHandle instrument, const std::vector<float> &notes, const float step,
+                             const VoiceParams &params, const float delay) {
+        // Every note is scheduled against one start time, so the rhythm does not drift with frame timing
+        const auto start = mixer.getTime() + static_cast<uint64_t>(std::max(0.0f, delay) * Mixer::SAMPLE_RATE);
+        const auto stepFrames = static_cast<uint64_t>(step * Mixer::SAMPLE_RATE);
 
-        sounds.insert(std::make_pair(soundCount, sound));
-        return soundCount++;
+        for (std::size_t i = 0; i < notes.size(); ++i) {
+            if (notes[i] >= 0.0f) {
+                mixer.playNote(instrument, notes[i], step, params, start + i * stepFrames);
+            }
+        }
     }
 
-    void Audio::PlaySound(const SoundHandle sound) const {
-        if (!::IsSoundPlaying(sounds.at(sound))) {
-            ::PlaySound(sounds.at(sound));
+    void Audio::PlayMusic(const std::string &path, const bool loop, const float fade, const float volume) {
+        if (!music.play(path, loop, fade, volume)) {
+            throw std::runtime_error("Failed to play music: " + path);
         }
     }
 
-    void Audio::ToggleSound(const SoundHandle sound) const {
-        if (::IsSoundPlaying(sounds.at(sound))) {
-            ::StopSound(sounds.at(sound));
-        } else {
-            ::PlaySound(sounds.at(sound));
+    void Audio::StopMusic(const float fade) {
+        music.stop(fade);
+    }
+
+    void Audio::SetMusicVolume(const float volume) {
+        music.setVolume(volume);
+    }
+
+    bool Audio::IsMusicPlaying() const {
+        return music.isPlaying();
+    }
+
+    void Audio::Update(const float deltaTime) {
+        if (offline) {
+            offline->advance(deltaTime);
         }
+
+        music.update();
+    }
+
+    bool Audio::IsHeadless() const {
+        return offline != nullptr;
     }
 
-    void Audio::StopSound(const SoundHandle sound) const {
-        ::StopSound(sounds.at(sound));
+    MixerStats Audio::GetStats() const {
+        return mixer.getStats();
+    }
+
+    nlohmann::json Audio::GetStatsJson() const {
+        const auto stats = mixer.getStats();
+        constexpr auto milliseconds = 1000.0;
+
+        auto histogram = nlohmann::json::array();
+        for (uint32_t i = 0; i < MixerStats::HISTOGRAM_BUCKETS; ++i) {
+            // Upper bound as a share of the callback budget; the last bucket has none
+            auto bucket = nlohmann::json{{"below", nullptr}, {"count", stats.callbackHistogram[i]}};
+            if (i < MixerStats::BUCKET_LIMITS.size()) {
+                bucket["below"] = MixerStats::BUCKET_LIMITS[i];
+            }
+            histogram.push_back(bucket);
+        }
+
+        auto buses = nlohmann::json::array();
+        for (const auto &bus: stats.buses) {
+            buses.push_back({
+                {"name", bus.name},
+                {"effects", bus.effects},
+                {"effectTime", bus.effectSeconds * milliseconds},
+            });
+        }
+
+        return {
+            {"headless", IsHeadless()},
+            {"sampleRate", Mixer::SAMPLE_RATE},
+            {"callbacks", stats.callbacks},
+            {"mixedTime", stats.mixedSeconds * milliseconds},
+            {"callbackHistogram", histogram},
+            {"lastCallbackTime", stats.lastCallbackSeconds * milliseconds},
+            {"worstCallbackTime", stats.worstCallbackSeconds * milliseconds},
+            {"load", stats.load},
+            {"underruns", stats.underruns},
+            {"streamUnderruns", stats.streamUnderruns},
+            {"activeVoices", stats.activeVoices},
+            {"peakVoices", stats.peakVoices},
+            {"culledVoices", stats.culledVoices},
+            {"maxVoices", Mixer::MAX_VOICES},
+            {"stolenVoices", stats.stolenVoices},
+            {"droppedVoices", stats.droppedVoices},
+            {"droppedCommands", stats.droppedCommands},
+            {"musicPlaying", music.isPlaying()},
+            {"buses", buses},
+        };
     }
 
-    void Audio::SetSoundVolume(const SoundHandle sound, const float volume) const {
-        ::SetSoundVolume(sounds.at(sound), volume);
+    void Audio::ResetStats() {
+        mixer.resetStats();
     }
 } // audio
 // blipcade
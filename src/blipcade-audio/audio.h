@@ -4,34 +4,120 @@
 
 #ifndef AUDIO_H
 #define AUDIO_H
+#include <memory>
+#include <nlohmann/json_fwd.hpp>
 #include <raylib.h>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "mixer.h"
+#include "music.h"
+#include "offline.h"
 
-namespace blipcade::audio {
-    using SoundHandle = uint32_t;
 
+namespace blipcade::audio {
     class Audio {
     public:
         Audio();
 
         ~Audio();
 
+        // Every call returns a new sound with its own volume and bus, but the samples of a path are shared
         SoundHandle LoadSound(const std::string &path);
 
-        void PlaySound(SoundHandle sound) const;
+        // Every call starts another voice, so the same sound can overlap itself. A positive `delay` (seconds)
+        // starts it that long after the audio already mixed, to the sample.
+        VoiceHandle PlaySound(SoundHandle sound, const VoiceParams &params = {}, float delay = 0.0f);
+
+        // Plays the sound at a point in the world, attenuated and panned around the listener
+        VoiceHandle PlaySoundAt(SoundHandle sound, const Emitter &emitter, const VoiceParams &params = {},
+                                float delay = 0.0f);
+
+        void SetVoicePosition(VoiceHandle voice, float x, float y);
+
+        // Where positional sounds are heard from, with the distance at which they pan fully to a side
+        void SetListener(float x, float y, float panWidth);
+
+        void ToggleSound(SoundHandle sound);
+
+        void StopSound(SoundHandle sound);
+
+        void SetSoundVolume(SoundHandle sound, float volume);
+
+        void StopVoice(VoiceHandle voice);
+
+        // See Mixer::isVoicePlaying
+        [[nodiscard]] bool IsVoicePlaying(VoiceHandle voice) const;
+
+        void SetVoiceParams(VoiceHandle voice, float volume, float pan, float pitch);
+
+        BusHandle CreateBus(const std::string &name);
+
+        [[nodiscard]] BusHandle FindBus(const std::string &name) const;
+
+        void SetBusVolume(BusHandle bus, float volume);
+
+        void AddBusEffect(BusHandle bus, std::unique_ptr<Effect> effect);
+
+        void ClearBusEffects(BusHandle bus);
 
-        void ToggleSound(SoundHandle sound) const;
+        void SetSoundBus(SoundHandle sound, BusHandle bus);
 
-        void StopSound(SoundHandle sound) const;
+        void SetSoundSend(SoundHandle sound, BusHandle bus, float level);
 
-        void SetSoundVolume(SoundHandle sound, float volume) const;
+        void SetVoiceSend(VoiceHandle voice, BusHandle bus, float level);
 
-        AudioStream musicStream;
+        InstrumentHandle CreateInstrument(const Instrument &instrument, BusHandle bus = BUS_SFX);
+
+        // `note` is a MIDI note number; a `duration` of 0 holds it until StopVoice
+        VoiceHandle PlayNote(InstrumentHandle instrument, float note, float duration, const VoiceParams &params = {},
+                             float delay = 0.0f);
+
+        // One note every `step` seconds, timed to the sample; negative notes are rests
+        void PlaySequence(InstrumentHandle instrument, const std::vector<float> &notes, float step,
+                          const VoiceParams &params = {}, float delay = 0.0f);
+
+        // Streams the file on the music bus, crossfading from the current track over `fade` seconds
+        void PlayMusic(const std::string &path, bool loop = true, float fade = 0.0f, float volume = 1.0f);
+
+        void StopMusic(float fade = 0.0f);
+
+        void SetMusicVolume(float volume);
+
+        [[nodiscard]] bool IsMusicPlaying() const;
+
+        // Once per frame with the frame's duration in seconds. Without an audio device this is what advances the
+        // mixer, so voices still finish and music still streams.
+        void Update(float deltaTime);
+
+        // True when no audio device was available
+        [[nodiscard]] bool IsHeadless() const;
+
+        [[nodiscard]] MixerStats GetStats() const;
+
+        // GetStats plus music and device state, with times in milliseconds, for logs and bug reports
+        [[nodiscard]] nlohmann::json GetStatsJson() const;
+
+        void ResetStats();
 
     private:
-        std::unordered_map<SoundHandle, ::Sound> sounds;
+        Mixer mixer;
+        MusicPlayer music{mixer};
+        std::unique_ptr<OfflineRenderer> offline;
+        // Converted samples by path
+        std::unordered_map<std::string, std::shared_ptr<const SampleData>> sampleCache;
+        AudioStream stream{};
+
+        static Audio *streamOwner;
+
+        // Longer delays are cut to a day, which keeps the frame count from overflowing
+        static constexpr double MAX_DELAY_FRAMES = 24.0 * 60.0 * 60.0 * Mixer::SAMPLE_RATE;
+
+        // Mixer time `delay` seconds from now, or 0 for as soon as possible (also for a non-finite delay)
+        [[nodiscard]] uint64_t startFrame(float delay) const;
+
+        static void streamCallback(void *buffer, unsigned int frames);
     };
 } // audio
 // blipcade
@@ -0,0 +1,65 @@
+// compressor.cpp
+
+#include "compressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace blipcade::audio {
+    namespace {
+        float timeCoefficient(const float seconds) {
+            return seconds <= 0.0f ? 0.0f : std::exp(-1.0f / (seconds * SAMPLE_RATE));
+        }
+    }
+
+    Compressor::Compressor(const float threshold, const float ratio, const float attack, const float release,
+                           const float makeup)
+        : threshold(threshold), ratio(std::max(1.0f, ratio)), attackCoefficient(timeCoefficient(attack)),
+          releaseCoefficient(timeCoefficient(release)), makeupGain(std::pow(10.0f, makeup / 20.0f)) {
+    }
+
+    float Compressor::targetGain() const {
+        if (envelope <= 1e-6f) {
+            return makeupGain;
+        }
+
+        const auto level = 20.0f * std::log10(envelope);
+        const auto over = level - threshold;
+        if (over <= 0.0f) {
+            return makeupGain;
+        }
+
+        const auto reduction = over - over / ratio;
+        return std::pow(10.0f, -reduction / 20.0f) * makeupGain;
+    }
+
+    void Compressor::process(float *frames, const uint32_t frameCount) {
+        for (uint32_t start = 0; start < frameCount; start += CONTROL_FRAMES) {
+            const auto count = std::min(CONTROL_FRAMES, frameCount - start);
+            auto *block = frames + start * 2;
+
+            for (uint32_t i = 0; i < count; ++i) {
+                const auto peak = std::max(std::fabs(block[i * 2]), std::fabs(block[i * 2 + 1]));
+                const auto coefficient = peak > envelope ? attackCoefficient : releaseCoefficient;
+                envelope = peak + coefficient * (envelope - peak);
+            }
+
+            const auto target = targetGain();
+            const auto step = (target - gain) / static_cast<float>(count);
+
+            for (uint32_t i = 0; i < count; ++i) {
+                gain += step;
+                block[i * 2] *= gain;
+                block[i * 2 + 1] *= gain;
+            }
+
+            gain = target;
+        }
+    }
+
+    void Compressor::reset() {
+        envelope = 0.0f;
+        gain = 1.0f;
+    }
+} // audio
+// blipcade
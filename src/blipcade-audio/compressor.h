@@ -0,0 +1,38 @@
+// compressor.h
+
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include "effect.h"
+
+namespace blipcade::audio {
+    // Stereo-linked peak compressor. The envelope follows every sample, but the gain is recomputed once per
+    // CONTROL_FRAMES and ramped in between, which keeps the logarithms out of the per-sample loop.
+    class Compressor : public Effect {
+    public:
+        // Threshold and makeup are in dB, attack and release in seconds
+        Compressor(float threshold = -12.0f, float ratio = 4.0f, float attack = 0.005f, float release = 0.1f,
+                   float makeup = 0.0f);
+
+        void process(float *frames, uint32_t frameCount) override;
+
+        void reset() override;
+
+        static constexpr uint32_t CONTROL_FRAMES = 16;
+
+    private:
+        float threshold;
+        float ratio;
+        float attackCoefficient;
+        float releaseCoefficient;
+        float makeupGain;
+
+        float envelope = 0.0f;
+        float gain = 1.0f;
+
+        [[nodiscard]] float targetGain() const;
+    };
+} // audio
+// blipcade
+
+#endif // COMPRESSOR_H
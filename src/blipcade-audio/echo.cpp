@@ -4,53 +4,92 @@
 
 #include "echo.h"
 
-#include <raylib.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
 
 namespace blipcade {
 namespace audio {
+    namespace {
+        // read[i] holds the echo for samples[i]; the ranges never overlap, so each step is independent
+        void feedbackDelay(const float *read, float *write, float *samples, const uint32_t count,
+                           const float feedback, const float dry, const float wet) {
+            uint32_t i = 0;
 
-    Echo::Echo(float delaySeconds, float feedback, float mix)
-    : mixLevel(mix), feedbackFactor(feedback) {
-        // Initialize delay lines with slightly different delay times for a richer echo
-        float delays[2] = {delaySeconds, delaySeconds + 0.015f}; // in seconds
-        for(int i = 0; i < 2; ++i) {
-            delayLines.emplace_back(new DelayLineStruct(delays[i], feedbackFactor));
-        }
+#if defined(__SSE2__)
+            const auto fb = _mm_set1_ps(feedback);
+            const auto dryGain = _mm_set1_ps(dry);
+            const auto wetGain = _mm_set1_ps(wet);
 
-        delayBufferSize = 48000*2;      // 1 second delay (device sampleRate*channels)
-        delayBuffer = (float *)RL_CALLOC(delayBufferSize, sizeof(float));
-    }
+            for (; i + 4 <= count; i += 4) {
+                const auto delayed = _mm_loadu_ps(read + i);
+                const auto input = _mm_loadu_ps(samples + i);
+                _mm_storeu_ps(write + i, _mm_add_ps(input, _mm_mul_ps(delayed, fb)));
+                _mm_storeu_ps(samples + i, _mm_add_ps(_mm_mul_ps(input, dryGain), _mm_mul_ps(delayed, wetGain)));
+            }
+#endif
 
-    Echo::~Echo() {
-        for(auto& dl : delayLines) {
-            delete dl;
+            for (; i < count; ++i) {
+                const auto delayed = read[i];
+                const auto input = samples[i];
+                write[i] = input + delayed * feedback;
+                samples[i] = input * dry + delayed * wet;
+            }
         }
     }
 
-    float Echo::ProcessSample(float inputSample) {
+    Echo::Echo(float delaySeconds, float feedback, float mix) {
+        // A zero delay still rounds up to one sample below
+        delaySeconds = std::isnan(delaySeconds) ? 0.0f : std::clamp(delaySeconds, 0.0f, MAX_DELAY_SECONDS);
+        feedbackFactor = std::isnan(feedback) ? 0.0f : std::clamp(feedback, -MAX_FEEDBACK, MAX_FEEDBACK);
+        mixLevel = std::isnan(mix) ? 0.0f : std::clamp(mix, 0.0f, 1.0f);
 
+        // Slightly different delay times per channel for a richer echo
+        const float delays[2] = {delaySeconds, delaySeconds + 0.015f}; // in seconds
+
+        for (int i = 0; i < 2; ++i) {
+            auto &line = delayLines[i];
+            line.delay = std::max(1u, static_cast<uint32_t>(delays[i] * SAMPLE_RATE));
+            line.buffer.assign(ringSize(line.delay + 1), 0.0f);
+            line.mask = static_cast<uint32_t>(line.buffer.size()) - 1;
+        }
     }
 
+    void Echo::processChannel(DelayLine &line, float *samples, const uint32_t count) {
+        const auto size = static_cast<uint32_t>(line.buffer.size());
+        uint32_t done = 0;
 
-    unsigned int delayReadIndex = 2;
-    unsigned int delayWriteIndex = 0;
+        // Runs are cut at both wrap points and at the delay length, so reads only see samples written by
+        // earlier runs
+        while (done < count) {
+            const auto readIndex = (line.writeIndex - line.delay) & line.mask;
+            const auto length = std::min({count - done, line.delay, size - readIndex, size - line.writeIndex});
 
-    void Echo::AudioProcessEffectDelay(void *buffer, unsigned int frames)
-    {
-        for (unsigned int i = 0; i < frames*2; i += 2)
-        {
-            float leftDelay = delayBuffer[delayReadIndex++];    // ERROR: Reading buffer -> WHY??? Maybe thread related???
-            float rightDelay = delayBuffer[delayReadIndex++];
+            feedbackDelay(line.buffer.data() + readIndex, line.buffer.data() + line.writeIndex, samples + done, length,
+                          feedbackFactor, 1.0f - mixLevel, mixLevel);
 
-            if (delayReadIndex == delayBufferSize) delayReadIndex = 0;
+            line.writeIndex = (line.writeIndex + length) & line.mask;
+            done += length;
+        }
+    }
+
+    void Echo::process(float *frames, const uint32_t frameCount) {
+        deinterleave(frames, left.data(), right.data(), frameCount);
 
-            ((float *)buffer)[i] = 0.5f*((float *)buffer)[i] + 0.5f*leftDelay;
-            ((float *)buffer)[i + 1] = 0.5f*((float *)buffer)[i + 1] + 0.5f*rightDelay;
+        processChannel(delayLines[0], left.data(), frameCount);
+        processChannel(delayLines[1], right.data(), frameCount);
+
+        interleave(left.data(), right.data(), frames, frameCount);
+    }
 
-            delayBuffer[delayWriteIndex++] = ((float *)buffer)[i];
-            delayBuffer[delayWriteIndex++] = ((float *)buffer)[i + 1];
-            if (delayWriteIndex == delayBufferSize) delayWriteIndex = 0;
+    void Echo::reset() {
+        for (auto &line: delayLines) {
+            std::fill(line.buffer.begin(), line.buffer.end(), 0.0f);
+            line.writeIndex = 0;
         }
     }
 } // audio
-} // blipcade
\ No newline at end of file
+} // blipcade
@@ -5,49 +5,45 @@
 #ifndef ECHO_H
 #define ECHO_H
 #include "effect.h"
+
+#include <array>
 #include <vector>
-#include <cstring> // For memset
 
 namespace blipcade {
     namespace audio {
+        // Feedback delay. The right channel repeats slightly later than the left for a wider echo.
         class Echo : public Effect {
         public:
-            Echo(float delaySeconds = 0.3f, float feedback = 0.5f, float mix = 0.3f);
+            // Bounds the delay buffer allocated on the game thread
+            static constexpr float MAX_DELAY_SECONDS = 2.0f;
+            // Repeats must decay, or the bus rings forever and grows without limit
+            static constexpr float MAX_FEEDBACK = 0.95f;
 
-            ~Echo();
+            // Out-of-range values are clamped: delay to (0, MAX_DELAY_SECONDS], |feedback| to MAX_FEEDBACK, mix to
+            // [0, 1]. NaN delay and mix fall back to their lower bound, NaN feedback to 0.
+            Echo(float delaySeconds = 0.3f, float feedback = 0.5f, float mix = 0.3f);
 
-            float ProcessSample(float inputSample) override;
+            void process(float *frames, uint32_t frameCount) override;
 
-            void AudioProcessEffectDelay(void *buffer, unsigned int frames);
+            void reset() override;
 
         private:
-            struct DelayLineStruct {
-                float *buffer;
-                int size;
-                int writeIndex;
-                float feedback;
-
-                DelayLineStruct(float delaySeconds, float feedbackFactor)
-                    : size(static_cast<int>(delaySeconds * SAMPLE_RATE)),
-                      writeIndex(0),
-                      feedback(feedbackFactor) {
-                    buffer = new float[size];
-                    std::memset(buffer, 0, sizeof(float) * size);
-                }
-
-                ~DelayLineStruct() {
-                    delete[] buffer;
-                }
+            struct DelayLine {
+                std::vector<float> buffer;
+                uint32_t mask;
+                uint32_t delay;
+                uint32_t writeIndex = 0;
             };
 
-            std::vector<DelayLineStruct *> delayLines;
+            std::array<DelayLine, 2> delayLines;
             float mixLevel;
             float feedbackFactor;
 
+            // Channel scratch, so a block never allocates
+            std::array<float, MAX_BLOCK_FRAMES> left{};
+            std::array<float, MAX_BLOCK_FRAMES> right{};
 
-
-            float *delayBuffer = nullptr;
-            unsigned int delayBufferSize = 0;
+            void processChannel(DelayLine &line, float *samples, uint32_t count);
         };
     }
 } // blipcade
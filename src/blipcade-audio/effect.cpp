@@ -3,7 +3,54 @@
 //
 
 #include "effect.h"
-namespace blipcade {
-namespace audio {
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace blipcade::audio {
+    void deinterleave(const float *frames, float *left, float *right, const uint32_t frameCount) {
+        uint32_t i = 0;
+
+#if defined(__SSE2__)
+        for (; i + 4 <= frameCount; i += 4) {
+            const auto a = _mm_loadu_ps(frames + i * 2);
+            const auto b = _mm_loadu_ps(frames + i * 2 + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+#endif
+
+        for (; i < frameCount; ++i) {
+            left[i] = frames[i * 2];
+            right[i] = frames[i * 2 + 1];
+        }
+    }
+
+    void interleave(const float *left, const float *right, float *frames, const uint32_t frameCount) {
+        uint32_t i = 0;
+
+#if defined(__SSE2__)
+        for (; i + 4 <= frameCount; i += 4) {
+            const auto l = _mm_loadu_ps(left + i);
+            const auto r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(frames + i * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(frames + i * 2 + 4, _mm_unpackhi_ps(l, r));
+        }
+#endif
+
+        for (; i < frameCount; ++i) {
+            frames[i * 2] = left[i];
+            frames[i * 2 + 1] = right[i];
+        }
+    }
+
+    uint32_t ringSize(const uint32_t frames) {
+        uint32_t size = 1;
+        while (size < frames) {
+            size <<= 1;
+        }
+        return size;
+    }
 } // audio
-} // blipcade
\ No newline at end of file
+// blipcade
@@ -2,17 +2,40 @@
 // Created by Pavlo Yevsehnieiev
 //
 
-// Effect.hpp
-#ifndef EFFECT_HPP
-#define EFFECT_HPP
+#ifndef EFFECT_H
+#define EFFECT_H
 
-constexpr int SAMPLE_RATE = 44100; // TODO: Get this from the audio engine
+#include <cstdint>
 
-class Effect {
-public:
-    virtual ~Effect() = default;
-    // Process a single sample. Should be overridden by derived effects.
-    virtual float ProcessSample(float inputSample) = 0;
-};
+namespace blipcade::audio {
+    // Rate the device stream is opened at. Sounds are converted to it when loaded, so voices, effects and synths
+    // all count time in the same frames.
+    constexpr uint32_t SAMPLE_RATE = 48000;
 
-#endif // EFFECT_HPP#endif //EFFECT_H
+    // Longest block an effect is handed at once; the mixer splits longer renders
+    constexpr uint32_t MAX_BLOCK_FRAMES = 512;
+
+    // Effects work in place on whole blocks of interleaved stereo frames, so the per-call cost is paid once per
+    // block rather than once per sample.
+    class Effect {
+    public:
+        virtual ~Effect() = default;
+
+        // `frameCount` is at most MAX_BLOCK_FRAMES
+        virtual void process(float *frames, uint32_t frameCount) = 0;
+
+        // Clears delay lines and filter state
+        virtual void reset() = 0;
+    };
+
+    // Splits interleaved stereo into two channel buffers and back, with SSE where available
+    void deinterleave(const float *frames, float *left, float *right, uint32_t frameCount);
+
+    void interleave(const float *left, const float *right, float *frames, uint32_t frameCount);
+
+    // Smallest power of two holding `frames`, so ring buffers wrap with a mask instead of a modulo
+    uint32_t ringSize(uint32_t frames);
+} // audio
+// blipcade
+
+#endif // EFFECT_H
@@ -0,0 +1,35 @@
+// lowpass.cpp
+
+#include "lowpass.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace blipcade::audio {
+    LowPass::LowPass(const float cutoff) {
+        const auto nyquist = SAMPLE_RATE * 0.5f;
+        coefficient = 1.0f - std::exp(-2.0f * 3.14159265f * std::clamp(cutoff, 1.0f, nyquist) / SAMPLE_RATE);
+    }
+
+    void LowPass::process(float *frames, const uint32_t frameCount) {
+        // Each output feeds the next, so this runs serially; both channels share the step
+        auto l = left;
+        auto r = right;
+
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            l += coefficient * (frames[i * 2] - l);
+            r += coefficient * (frames[i * 2 + 1] - r);
+            frames[i * 2] = l;
+            frames[i * 2 + 1] = r;
+        }
+
+        left = l;
+        right = r;
+    }
+
+    void LowPass::reset() {
+        left = 0.0f;
+        right = 0.0f;
+    }
+} // audio
+// blipcade
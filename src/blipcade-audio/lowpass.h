@@ -0,0 +1,26 @@
+// lowpass.h
+
+#ifndef LOWPASS_H
+#define LOWPASS_H
+
+#include "effect.h"
+
+namespace blipcade::audio {
+    // One-pole low-pass per channel; muffles a bus, e.g. for sound heard through a wall
+    class LowPass : public Effect {
+    public:
+        explicit LowPass(float cutoff = 1000.0f);
+
+        void process(float *frames, uint32_t frameCount) override;
+
+        void reset() override;
+
+    private:
+        float coefficient;
+        float left = 0.0f;
+        float right = 0.0f;
+    };
+} // audio
+// blipcade
+
+#endif // LOWPASS_H
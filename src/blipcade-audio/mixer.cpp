@@ -0,0 +1,1152 @@
+// mixer.cpp
+
+#include "mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "resampler.h"
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace blipcade::audio {
+    namespace {
+        // Equal-power pan law, so a centered voice is as loud as one panned hard to a side
+        void panGains(const float gain, const float pan, float &left, float &right) {
+            const auto angle = (std::clamp(pan, -1.0f, 1.0f) + 1.0f) * 0.25f * 3.14159265f;
+            left = gain * std::cos(angle);
+            right = gain * std::sin(angle);
+        }
+
+        // dst[i] += src[i] * gain
+        void accumulate(float *dst, const float *src, const uint32_t count, const float gain) {
+            uint32_t i = 0;
+
+#if defined(__SSE2__)
+            const auto scale = _mm_set1_ps(gain);
+            for (; i + 4 <= count; i += 4) {
+                const auto sum = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), scale));
+                _mm_storeu_ps(dst + i, sum);
+            }
+#endif
+
+            for (; i < count; ++i) {
+                dst[i] += src[i] * gain;
+            }
+        }
+
+        uint64_t nanosSince(const std::chrono::steady_clock::time_point start) {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+        constexpr const char *DEFAULT_BUS_NAMES[] = {"music", "sfx", "ambience", "ui"};
+    }
+
+    Mixer::Mixer() {
+        for (BusHandle bus = 0; bus < std::size(DEFAULT_BUS_NAMES); ++bus) {
+            busStates[bus].name = DEFAULT_BUS_NAMES[bus];
+            busStates[bus].created = true;
+            buses[bus].active = true;
+        }
+
+        busStates[MASTER_INDEX].name = "master";
+        busStates[MASTER_INDEX].created = true;
+        buses[MASTER_INDEX].active = true;
+    }
+
+    std::shared_ptr<const SampleData> Mixer::convertSamples(const float *frames, const uint32_t frameCount,
+                                                            const uint32_t channels, const uint32_t sampleRate) {
+        auto data = std::make_shared<SampleData>();
+        data->channels = std::min(channels, CHANNELS);
+
+        if (data->channels == 0 || frameCount == 0) {
+            return data;
+        }
+
+        // Drop extra channels first so the resampler only filters what is kept
+        std::vector<float> kept;
+        const auto *source = frames;
+        if (channels > data->channels) {
+            kept.resize(static_cast<std::size_t>(frameCount) * data->channels);
+            for (uint32_t frame = 0; frame < frameCount; ++frame) {
+                const auto *from = frames + static_cast<std::size_t>(frame) * channels;
+                std::copy(from, from + data->channels, kept.begin() + frame * data->channels);
+            }
+            source = kept.data();
+        }
+
+        data->frames = resample(source, frameCount, data->channels, sampleRate, SAMPLE_RATE);
+        data->frameCount = static_cast<uint32_t>(data->frames.size() / data->channels);
+        return data;
+    }
+
+    SoundHandle Mixer::addSound(std::shared_ptr<const SampleData> data) {
+        auto sound = std::make_unique<Sound>();
+        sound->data = std::move(data);
+
+        sounds.push_back(std::move(sound));
+        return static_cast<SoundHandle>(sounds.size() - 1);
+    }
+
+    SoundHandle Mixer::addSound(const float *frames, const uint32_t frameCount, const uint32_t channels,
+                                const uint32_t sampleRate) {
+        return addSound(convertSamples(frames, frameCount, channels, sampleRate));
+    }
+
+    bool Mixer::send(const Command &command) {
+        if (!commands.push(command)) {
+            ++droppedCommands;
+            return false;
+        }
+
+        ++sentCommands;
+        return true;
+    }
+
+    VoiceHandle Mixer::play(const SoundHandle sound, const VoiceParams &params, const uint64_t atFrame) {
+        return playSound(sound, params, atFrame, nullptr);
+    }
+
+    VoiceHandle Mixer::playAt(const SoundHandle sound, const Emitter &emitter, const VoiceParams &params,
+                              const uint64_t atFrame) {
+        return playSound(sound, params, atFrame, &emitter);
+    }
+
+    VoiceHandle Mixer::playSound(const SoundHandle sound, const VoiceParams &params, const uint64_t atFrame,
+                                 const Emitter *emitter) {
+        if (sound >= sounds.size() || sounds[sound]->data->frameCount == 0) {
+            return NO_VOICE;
+        }
+
+        const auto voice = nextVoice;
+        if (++nextVoice == NO_VOICE) {
+            nextVoice = 1;
+        }
+
+        Command command;
+        command.type = Command::Type::Play;
+        command.time = atFrame;
+        command.voice = voice;
+        command.soundHandle = sound;
+        command.sound = sounds[sound].get();
+        command.params = params;
+        command.params.pitch = clampPitch(params.pitch);
+        command.bus = sounds[sound]->bus;
+        command.sends = sounds[sound]->sends;
+
+        if (emitter) {
+            command.positional = true;
+            command.emitter = *emitter;
+        }
+
+        return send(command) ? voice : NO_VOICE;
+    }
+
+    float Mixer::clampPitch(const float pitch) {
+        return std::isfinite(pitch) ? std::clamp(pitch, MIN_PITCH, MAX_PITCH) : 1.0f;
+    }
+
+    void Mixer::setVoicePosition(const VoiceHandle voice, const float x, const float y) {
+        Command command;
+        command.type = Command::Type::SetVoicePosition;
+        command.voice = voice;
+        command.emitter.x = x;
+        command.emitter.y = y;
+        send(command);
+    }
+
+    void Mixer::setListener(const float x, const float y, const float panWidth) {
+        Command command;
+        command.type = Command::Type::SetListener;
+        command.emitter.x = x;
+        command.emitter.y = y;
+        command.emitter.radius = panWidth;
+        send(command);
+    }
+
+    void Mixer::stop(const VoiceHandle voice, const uint64_t atFrame) {
+        Command command;
+        command.type = Command::Type::Stop;
+        command.time = atFrame;
+        command.voice = voice;
+        send(command);
+    }
+
+    void Mixer::setVoiceParams(const VoiceHandle voice, const float gain, const float pan, const float pitch) {
+        Command command;
+        command.type = Command::Type::SetVoiceParams;
+        command.voice = voice;
+        command.params.gain = gain;
+        command.params.pan = pan;
+        command.params.pitch = clampPitch(pitch);
+        send(command);
+    }
+
+    void Mixer::stopSound(const SoundHandle sound) {
+        Command command;
+        command.type = Command::Type::StopSound;
+        command.soundHandle = sound;
+        send(command);
+    }
+
+    bool Mixer::isSoundPlaying(const SoundHandle sound) const {
+        return sound < sounds.size() && sounds[sound]->activeVoices.load(std::memory_order_relaxed) > 0;
+    }
+
+    bool Mixer::isVoicePlaying(const VoiceHandle voice) const {
+        if (voice == NO_VOICE) {
+            return false;
+        }
+
+        // Handles are handed out in order, so anything newer than the last one received is still queued
+        const auto received = receivedVoice.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(voice - received) > 0) {
+            return true;
+        }
+
+        return std::any_of(voiceHandles.begin(), voiceHandles.end(), [voice](const auto &handle) {
+            return handle.load(std::memory_order_relaxed) == voice;
+        });
+    }
+
+    void Mixer::setSoundGain(const SoundHandle sound, const float gain) {
+        if (sound >= sounds.size()) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::SetSoundGain;
+        command.sound = sounds[sound].get();
+        command.params.gain = gain;
+        send(command);
+    }
+
+    void Mixer::setStealPolicy(const StealPolicy policy) {
+        Command command;
+        command.type = Command::Type::SetStealPolicy;
+        command.policy = policy;
+        send(command);
+    }
+
+    InstrumentHandle Mixer::addInstrument(const Instrument &instrument, const BusHandle bus) {
+        auto entry = std::make_unique<InstrumentEntry>();
+        entry->instrument = clampInstrument(instrument);
+        entry->bus = busIndex(bus, false) >= 0 ? bus : BUS_SFX;
+
+        instruments.push_back(std::move(entry));
+        return static_cast<InstrumentHandle>(instruments.size() - 1);
+    }
+
+    VoiceHandle Mixer::playNote(const InstrumentHandle instrument, const float note, const float duration,
+                                const VoiceParams &params, const uint64_t atFrame) {
+        if (instrument >= instruments.size()) {
+            return NO_VOICE;
+        }
+
+        const auto voice = nextVoice;
+        if (++nextVoice == NO_VOICE) {
+            nextVoice = 1;
+        }
+
+        Command command;
+        command.type = Command::Type::PlayNote;
+        command.time = atFrame;
+        command.voice = voice;
+        command.instrument = &instruments[instrument]->instrument;
+        command.note = note;
+        // At least a frame, since 0 means held
+        command.holdFrames = duration > 0.0f ? std::max(1u, static_cast<uint32_t>(duration * SAMPLE_RATE)) : 0;
+        command.params = params;
+        command.params.pitch = clampPitch(params.pitch);
+        command.bus = instruments[instrument]->bus;
+
+        return send(command) ? voice : NO_VOICE;
+    }
+
+    int Mixer::busIndex(const BusHandle bus, const bool allowMaster) const {
+        if (bus == MASTER_BUS) {
+            return allowMaster ? static_cast<int>(MASTER_INDEX) : -1;
+        }
+
+        return bus < MAX_BUSES && busStates[bus].created ? static_cast<int>(bus) : -1;
+    }
+
+    void Mixer::setSend(Sends &sends, const BusHandle bus, const float level) {
+        auto *slot = std::find_if(sends.begin(), sends.end(), [bus](const Send &send) { return send.bus == bus; });
+
+        if (slot == sends.end()) {
+            if (level <= 0.0f) {
+                return;
+            }
+
+            slot = std::find_if(sends.begin(), sends.end(), [](const Send &send) { return send.bus == NO_BUS; });
+            if (slot == sends.end()) {
+                return;
+            }
+        }
+
+        *slot = level > 0.0f ? Send{bus, level} : Send{};
+    }
+
+    void Mixer::setSoundBus(const SoundHandle sound, const BusHandle bus) {
+        if (sound < sounds.size() && busIndex(bus, false) >= 0) {
+            sounds[sound]->bus = bus;
+        }
+    }
+
+    void Mixer::setSoundSend(const SoundHandle sound, const BusHandle bus, const float level) {
+        if (sound < sounds.size() && busIndex(bus, false) >= 0) {
+            setSend(sounds[sound]->sends, bus, level);
+        }
+    }
+
+    void Mixer::setVoiceSend(const VoiceHandle voice, const BusHandle bus, const float level) {
+        if (busIndex(bus, false) < 0) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::SetVoiceSend;
+        command.voice = voice;
+        command.bus = bus;
+        command.params.gain = level;
+        send(command);
+    }
+
+    BusHandle Mixer::createBus(const std::string &name) {
+        if (const auto existing = findBus(name); existing != NO_BUS) {
+            return existing;
+        }
+
+        for (BusHandle bus = 0; bus < MAX_BUSES; ++bus) {
+            if (busStates[bus].created) {
+                continue;
+            }
+
+            Command command;
+            command.type = Command::Type::CreateBus;
+            command.bus = bus;
+
+            if (!send(command)) {
+                return NO_BUS;
+            }
+
+            busStates[bus].name = name;
+            busStates[bus].created = true;
+            return bus;
+        }
+
+        return NO_BUS;
+    }
+
+    BusHandle Mixer::findBus(const std::string &name) const {
+        for (uint32_t index = 0; index <= MAX_BUSES; ++index) {
+            if (busStates[index].created && busStates[index].name == name) {
+                return index == MASTER_INDEX ? MASTER_BUS : index;
+            }
+        }
+
+        return NO_BUS;
+    }
+
+    void Mixer::setBusGain(const BusHandle bus, const float gain) {
+        if (busIndex(bus, true) < 0) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::SetBusGain;
+        command.bus = bus;
+        command.params.gain = gain;
+        send(command);
+    }
+
+    void Mixer::addBusEffect(const BusHandle bus, std::unique_ptr<Effect> effect) {
+        releaseRetiredEffects();
+
+        const auto index = busIndex(bus, true);
+        if (index < 0 || busStates[index].effects.size() >= MAX_BUS_EFFECTS) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::AddEffect;
+        command.bus = bus;
+        command.effect = effect.get();
+
+        if (send(command)) {
+            busStates[index].effects.push_back(std::move(effect));
+        }
+    }
+
+    void Mixer::clearBusEffects(const BusHandle bus) {
+        releaseRetiredEffects();
+
+        const auto index = busIndex(bus, true);
+        if (index < 0) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::ClearEffects;
+        command.bus = bus;
+
+        if (!send(command)) {
+            return;
+        }
+
+        auto &effects = busStates[index].effects;
+        for (auto &effect: effects) {
+            retiredEffects.emplace_back(sentCommands, std::move(effect));
+        }
+        effects.clear();
+    }
+
+    void Mixer::releaseRetiredEffects() {
+        const auto received = receivedCommands.load(std::memory_order_acquire);
+
+        std::erase_if(retiredEffects, [received](const auto &retired) {
+            return retired.first <= received;
+        });
+    }
+
+    bool Mixer::startStream(const uint32_t slot, const uint32_t id, SampleRing *ring, const std::atomic<bool> *ended,
+                            const BusHandle bus, const float gain, const uint32_t fadeFrames) {
+        if (slot >= MAX_STREAMS || id == 0 || !ring || !ended || busIndex(bus, false) < 0) {
+            return false;
+        }
+
+        Command command;
+        command.type = Command::Type::StartStream;
+        command.slot = slot;
+        command.stream = id;
+        command.ring = ring;
+        command.ended = ended;
+        command.bus = bus;
+        command.params.gain = gain;
+        command.fadeFrames = fadeFrames;
+        return send(command);
+    }
+
+    void Mixer::fadeStream(const uint32_t slot, const float gain, const uint32_t fadeFrames,
+                           const bool stopWhenSilent) {
+        if (slot >= MAX_STREAMS) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::FadeStream;
+        command.slot = slot;
+        command.params.gain = gain;
+        command.fadeFrames = fadeFrames;
+        command.stopWhenSilent = stopWhenSilent;
+        send(command);
+    }
+
+    void Mixer::stopStream(const uint32_t slot) {
+        if (slot >= MAX_STREAMS) {
+            return;
+        }
+
+        Command command;
+        command.type = Command::Type::StopStream;
+        command.slot = slot;
+        send(command);
+    }
+
+    uint32_t Mixer::getActiveStream(const uint32_t slot) const {
+        return slot < MAX_STREAMS ? activeStreams[slot].load(std::memory_order_acquire) : 0;
+    }
+
+    uint64_t Mixer::getTime() const {
+        return clock.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Mixer::getDroppedCommands() const {
+        return droppedCommands;
+    }
+
+    MixerStats Mixer::getStats() const {
+        constexpr auto order = std::memory_order_relaxed;
+        constexpr auto seconds = 1e-9;
+
+        MixerStats stats;
+        stats.callbacks = counters.callbacks.load(order);
+        for (uint32_t i = 0; i < MixerStats::HISTOGRAM_BUCKETS; ++i) {
+            stats.callbackHistogram[i] = counters.callbackHistogram[i].load(order);
+        }
+
+        stats.lastCallbackSeconds = static_cast<double>(counters.lastCallbackNanos.load(order)) * seconds;
+        stats.worstCallbackSeconds = static_cast<double>(counters.worstCallbackNanos.load(order)) * seconds;
+
+        stats.mixedSeconds = static_cast<double>(counters.callbackFrames.load(order)) / SAMPLE_RATE;
+        if (stats.mixedSeconds > 0.0) {
+            stats.load = static_cast<double>(counters.callbackNanos.load(order)) * seconds / stats.mixedSeconds;
+        }
+
+        stats.underruns = counters.underruns.load(order);
+        stats.streamUnderruns = counters.streamUnderruns.load(order);
+        stats.activeVoices = counters.activeVoices.load(order);
+        stats.peakVoices = counters.peakVoices.load(order);
+        stats.culledVoices = counters.culledVoices.load(order);
+        stats.stolenVoices = counters.stolenVoices.load(order);
+        stats.droppedVoices = counters.droppedVoices.load(order);
+        stats.droppedCommands = droppedCommands;
+
+        for (uint32_t index = 0; index <= MAX_BUSES; ++index) {
+            if (!busStates[index].created) {
+                continue;
+            }
+
+            const auto effectNanos = counters.effectNanos[index].load(order);
+            stats.buses.push_back({busStates[index].name, static_cast<uint32_t>(busStates[index].effects.size()),
+                                   static_cast<double>(effectNanos) * seconds});
+        }
+
+        return stats;
+    }
+
+    void Mixer::resetStats() {
+        Command command;
+        command.type = Command::Type::ResetStats;
+        send(command);
+    }
+
+    uint64_t Mixer::getSentCommands() const {
+        return sentCommands;
+    }
+
+    uint64_t Mixer::getReceivedCommands() const {
+        return receivedCommands.load(std::memory_order_acquire);
+    }
+
+    void Mixer::drainCommands() {
+        uint64_t received = 0;
+
+        while (const auto command = commands.pop()) {
+            ++received;
+
+            // Nowhere left to wait, so a late command runs early rather than being lost
+            if (command->time <= time || scheduledCount == MAX_SCHEDULED) {
+                apply(*command);
+            } else {
+                auto slot = scheduledCount++;
+                for (; slot > 0 && scheduled[slot - 1].time > command->time; --slot) {
+                    scheduled[slot] = scheduled[slot - 1];
+                }
+                scheduled[slot] = *command;
+            }
+
+            // After apply, so isVoicePlaying never sees the handle received but not yet active
+            if (command->type == Command::Type::Play || command->type == Command::Type::PlayNote) {
+                receivedVoice.store(command->voice, std::memory_order_release);
+            }
+        }
+
+        if (received > 0) {
+            receivedCommands.fetch_add(received, std::memory_order_release);
+        }
+
+        uint32_t due = 0;
+        while (due < scheduledCount && scheduled[due].time <= time) {
+            apply(scheduled[due++]);
+        }
+
+        if (due > 0) {
+            std::move(scheduled.begin() + due, scheduled.begin() + scheduledCount, scheduled.begin());
+            scheduledCount -= due;
+        }
+    }
+
+    void Mixer::apply(const Command &command) {
+        switch (command.type) {
+            case Command::Type::Play: {
+                auto *voice = allocateVoice();
+                if (!voice) {
+                    break;
+                }
+
+                releaseVoice(*voice);
+
+                voice->sound = command.sound;
+                voice->instrument = nullptr;
+                voice->soundHandle = command.soundHandle;
+                voice->handle = command.voice;
+                voice->position = 0.0;
+                voice->gain = command.params.gain;
+                voice->pan = command.params.pan;
+                voice->pitch = command.params.pitch;
+                voice->loop = command.params.loop;
+                voice->bus = command.bus;
+                voice->sends = command.sends;
+                voice->active = true;
+                voice->startedAt = startCounter++;
+                voice->positional = command.positional;
+                voice->emitter = command.emitter;
+                voice->attenuation = 1.0f;
+                voice->spatialPan = 0.0f;
+                voice->rendered = false;
+
+                voice->sound->activeVoices.fetch_add(1, std::memory_order_relaxed);
+                voiceHandles[voice - voices.data()].store(command.voice, std::memory_order_relaxed);
+                break;
+            }
+            case Command::Type::PlayNote: {
+                auto *voice = allocateVoice();
+                if (!voice) {
+                    break;
+                }
+
+                releaseVoice(*voice);
+
+                voice->sound = nullptr;
+                voice->instrument = command.instrument;
+                voice->synth.start(*command.instrument, command.note, command.holdFrames, SAMPLE_RATE);
+                voice->handle = command.voice;
+                voice->gain = command.params.gain;
+                voice->pan = command.params.pan;
+                voice->pitch = command.params.pitch;
+                voice->loop = false;
+                voice->bus = command.bus;
+                voice->sends = {};
+                voice->active = true;
+                voice->startedAt = startCounter++;
+                voice->positional = false;
+                voice->attenuation = 1.0f;
+                voice->spatialPan = 0.0f;
+                voice->rendered = false;
+
+                voiceHandles[voice - voices.data()].store(command.voice, std::memory_order_relaxed);
+                break;
+            }
+            case Command::Type::Stop:
+                if (auto *voice = findVoice(command.voice)) {
+                    if (voice->instrument) {
+                        voice->synth.release();
+                    } else {
+                        releaseVoice(*voice);
+                    }
+                }
+                break;
+            case Command::Type::SetVoiceParams:
+                if (auto *voice = findVoice(command.voice)) {
+                    voice->gain = command.params.gain;
+                    voice->pan = command.params.pan;
+                    voice->pitch = command.params.pitch;
+                }
+                break;
+            case Command::Type::StopSound:
+                for (auto &voice: voices) {
+                    if (voice.active && voice.sound && voice.soundHandle == command.soundHandle) {
+                        releaseVoice(voice);
+                    }
+                }
+                break;
+            case Command::Type::SetSoundGain:
+                command.sound->gain = command.params.gain;
+                break;
+            case Command::Type::SetStealPolicy:
+                stealPolicy = command.policy;
+                break;
+            case Command::Type::SetVoiceSend:
+                if (auto *voice = findVoice(command.voice)) {
+                    setSend(voice->sends, command.bus, command.params.gain);
+                }
+                break;
+            case Command::Type::CreateBus:
+                buses[command.bus].active = true;
+                break;
+            case Command::Type::SetBusGain:
+                buses[command.bus == MASTER_BUS ? MASTER_INDEX : command.bus].gain = command.params.gain;
+                break;
+            case Command::Type::AddEffect: {
+                auto &bus = buses[command.bus == MASTER_BUS ? MASTER_INDEX : command.bus];
+                if (bus.effectCount < MAX_BUS_EFFECTS) {
+                    bus.effects[bus.effectCount++] = command.effect;
+                }
+                break;
+            }
+            case Command::Type::ClearEffects:
+                buses[command.bus == MASTER_BUS ? MASTER_INDEX : command.bus].effectCount = 0;
+                break;
+            case Command::Type::StartStream: {
+                auto &stream = streams[command.slot];
+                stream = Stream{};
+                stream.ring = command.ring;
+                stream.ended = command.ended;
+                stream.id = command.stream;
+                stream.bus = command.bus;
+
+                if (command.fadeFrames > 0) {
+                    stream.target = command.params.gain;
+                    stream.rampFrames = command.fadeFrames;
+                    stream.step = stream.target / static_cast<float>(command.fadeFrames);
+                } else {
+                    stream.gain = stream.target = command.params.gain;
+                }
+
+                activeStreams[command.slot].store(command.stream, std::memory_order_release);
+                break;
+            }
+            case Command::Type::FadeStream: {
+                auto &stream = streams[command.slot];
+                if (!stream.ring) {
+                    break;
+                }
+
+                stream.target = command.params.gain;
+                stream.stopWhenSilent = command.stopWhenSilent;
+                stream.rampFrames = command.fadeFrames;
+
+                if (command.fadeFrames > 0) {
+                    stream.step = (stream.target - stream.gain) / static_cast<float>(command.fadeFrames);
+                } else {
+                    stream.gain = stream.target;
+                }
+                break;
+            }
+            case Command::Type::StopStream:
+                releaseStream(command.slot);
+                break;
+            case Command::Type::SetVoicePosition:
+                if (auto *voice = findVoice(command.voice); voice && voice->positional) {
+                    voice->emitter.x = command.emitter.x;
+                    voice->emitter.y = command.emitter.y;
+                }
+                break;
+            case Command::Type::SetListener:
+                listenerX = command.emitter.x;
+                listenerY = command.emitter.y;
+                listenerPanWidth = command.emitter.radius;
+                break;
+            case Command::Type::ResetStats:
+                resetCounters();
+                break;
+        }
+    }
+
+    void Mixer::resetCounters() {
+        constexpr auto order = std::memory_order_relaxed;
+
+        counters.callbacks.store(0, order);
+        for (auto &bucket: counters.callbackHistogram) {
+            bucket.store(0, order);
+        }
+        counters.lastCallbackNanos.store(0, order);
+        counters.worstCallbackNanos.store(0, order);
+        counters.callbackNanos.store(0, order);
+        counters.callbackFrames.store(0, order);
+        counters.underruns.store(0, order);
+        counters.streamUnderruns.store(0, order);
+        // Voices still playing count towards the new peak
+        counters.peakVoices.store(counters.activeVoices.load(order), order);
+        counters.stolenVoices.store(0, order);
+        counters.droppedVoices.store(0, order);
+        for (auto &effectNanos: counters.effectNanos) {
+            effectNanos.store(0, order);
+        }
+    }
+
+    void Mixer::recordCallback(const uint32_t frameCount, const uint64_t nanos) {
+        constexpr auto order = std::memory_order_relaxed;
+
+        const auto budget = static_cast<double>(frameCount) * 1e9 / SAMPLE_RATE;
+        const auto share = static_cast<float>(static_cast<double>(nanos) / budget);
+
+        uint32_t bucket = 0;
+        while (bucket < MixerStats::BUCKET_LIMITS.size() && share >= MixerStats::BUCKET_LIMITS[bucket]) {
+            ++bucket;
+        }
+
+        counters.callbacks.fetch_add(1, order);
+        counters.callbackHistogram[bucket].fetch_add(1, order);
+        counters.lastCallbackNanos.store(nanos, order);
+        counters.callbackNanos.fetch_add(nanos, order);
+        counters.callbackFrames.fetch_add(frameCount, order);
+
+        // Only this thread writes the counters, so the read and the store cannot race each other
+        if (nanos > counters.worstCallbackNanos.load(order)) {
+            counters.worstCallbackNanos.store(nanos, order);
+        }
+
+        if (bucket == MixerStats::HISTOGRAM_BUCKETS - 1) {
+            counters.underruns.fetch_add(1, order);
+        }
+    }
+
+    void Mixer::releaseStream(const uint32_t slot) {
+        streams[slot] = Stream{};
+        activeStreams[slot].store(0, std::memory_order_release);
+    }
+
+    Mixer::Voice *Mixer::allocateVoice() {
+        for (auto &voice: voices) {
+            if (!voice.active) {
+                return &voice;
+            }
+        }
+
+        Voice *stolen = nullptr;
+
+        switch (stealPolicy) {
+            case StealPolicy::Oldest:
+                stolen = &*std::min_element(voices.begin(), voices.end(), [](const Voice &a, const Voice &b) {
+                    return a.startedAt < b.startedAt;
+                });
+                break;
+            case StealPolicy::Quietest:
+                stolen = &*std::min_element(voices.begin(), voices.end(), [](const Voice &a, const Voice &b) {
+                    const auto gainA = a.gain * a.attenuation * (a.sound ? a.sound->gain : a.instrument->gain);
+                    const auto gainB = b.gain * b.attenuation * (b.sound ? b.sound->gain : b.instrument->gain);
+                    return gainA < gainB;
+                });
+                break;
+            case StealPolicy::Never:
+                break;
+        }
+
+        (stolen ? counters.stolenVoices : counters.droppedVoices).fetch_add(1, std::memory_order_relaxed);
+        return stolen;
+    }
+
+    Mixer::Voice *Mixer::findVoice(const VoiceHandle handle) {
+        if (handle == NO_VOICE) {
+            return nullptr;
+        }
+
+        for (auto &voice: voices) {
+            if (voice.active && voice.handle == handle) {
+                return &voice;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void Mixer::releaseVoice(Voice &voice) {
+        if (!voice.active) {
+            return;
+        }
+
+        voice.active = false;
+        if (voice.sound) {
+            voice.sound->activeVoices.fetch_sub(1, std::memory_order_relaxed);
+        }
+        voiceHandles[&voice - voices.data()].store(NO_VOICE, std::memory_order_relaxed);
+    }
+
+    void Mixer::placeVoice(Voice &voice) const {
+        const auto dx = voice.emitter.x - listenerX;
+        const auto dy = voice.emitter.y - listenerY;
+        const auto distance = std::sqrt(dx * dx + dy * dy);
+
+        // The pan is kept when out of range, so a voice fading out does not swing to the center
+        if (distance >= voice.emitter.radius) {
+            voice.attenuation = 0.0f;
+            return;
+        }
+
+        voice.attenuation = std::pow(1.0f - distance / voice.emitter.radius, voice.emitter.falloff);
+        voice.spatialPan = listenerPanWidth > 0.0f ? std::clamp(dx / listenerPanWidth, -1.0f, 1.0f) : 0.0f;
+    }
+
+    void Mixer::skipVoice(Voice &voice, float *scratch, const uint32_t frameCount) {
+        // Back in range the voice ramps up from silence
+        voice.rendered = true;
+        voice.leftGain = 0.0f;
+        voice.rightGain = 0.0f;
+
+        if (voice.instrument) {
+            if (!voice.synth.render(scratch, frameCount, voice.pitch)) {
+                releaseVoice(voice);
+            }
+            return;
+        }
+
+        const auto length = static_cast<double>(voice.sound->data->frameCount);
+        voice.position += static_cast<double>(voice.pitch) * frameCount;
+
+        if (voice.position >= length) {
+            if (voice.loop) {
+                voice.position = std::fmod(voice.position, length);
+            } else {
+                releaseVoice(voice);
+            }
+        }
+    }
+
+    void Mixer::rampGains(Voice &voice, const float gain, const uint32_t frameCount, float &left, float &right,
+                          float &leftStep, float &rightStep) {
+        float targetLeft, targetRight;
+        panGains(gain * voice.attenuation, voice.pan + voice.spatialPan, targetLeft, targetRight);
+
+        // A new voice starts on its gains instead of fading in
+        if (!voice.rendered) {
+            voice.leftGain = targetLeft;
+            voice.rightGain = targetRight;
+            voice.rendered = true;
+        }
+
+        left = voice.leftGain;
+        right = voice.rightGain;
+        leftStep = (targetLeft - left) / static_cast<float>(frameCount);
+        rightStep = (targetRight - right) / static_cast<float>(frameCount);
+
+        voice.leftGain = targetLeft;
+        voice.rightGain = targetRight;
+    }
+
+    void Mixer::mixSynthVoice(Voice &voice, float *out, const uint32_t frameCount) {
+        float leftGain, rightGain, leftStep, rightStep;
+        rampGains(voice, voice.gain, frameCount, leftGain, rightGain, leftStep, rightStep);
+
+        // Mono into the front of `out`, then spread to stereo from the back so no sample is overwritten unread
+        if (!voice.synth.render(out, frameCount, voice.pitch)) {
+            releaseVoice(voice);
+        }
+
+        for (auto i = frameCount; i-- > 0;) {
+            const auto sample = out[i];
+            out[i * 2] = sample * (leftGain + leftStep * static_cast<float>(i));
+            out[i * 2 + 1] = sample * (rightGain + rightStep * static_cast<float>(i));
+        }
+    }
+
+    void Mixer::mixVoice(Voice &voice, float *out, const uint32_t frameCount) {
+        if (voice.instrument) {
+            mixSynthVoice(voice, out, frameCount);
+            return;
+        }
+
+        const auto &sound = *voice.sound;
+        const auto &data = *sound.data;
+        const auto *frames = data.frames.data();
+        const auto stereo = data.channels >= 2;
+        const auto channels = data.channels;
+        const auto last = data.frameCount - 1;
+
+        float leftGain, rightGain, leftStep, rightStep;
+        rampGains(voice, voice.gain * sound.gain, frameCount, leftGain, rightGain, leftStep, rightStep);
+
+        auto position = voice.position;
+
+        // Unpitched voices sit on whole frames, since sounds are already at the mixer rate, and just copy
+        if (voice.pitch == 1.0f && position == std::floor(position)) {
+            auto index = static_cast<uint32_t>(position);
+
+            for (uint32_t i = 0; i < frameCount; ++i) {
+                if (index >= data.frameCount) {
+                    if (!voice.loop) {
+                        releaseVoice(voice);
+                        std::fill(out + i * 2, out + frameCount * 2, 0.0f);
+                        break;
+                    }
+                    index = 0;
+                }
+
+                const auto *frame = frames + static_cast<std::size_t>(index) * channels;
+                out[i * 2] = frame[0] * leftGain;
+                out[i * 2 + 1] = (stereo ? frame[1] : frame[0]) * rightGain;
+                leftGain += leftStep;
+                rightGain += rightStep;
+                ++index;
+            }
+
+            voice.position = index;
+            return;
+        }
+
+        const auto step = static_cast<double>(voice.pitch);
+
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            if (position >= data.frameCount) {
+                if (!voice.loop) {
+                    releaseVoice(voice);
+                    std::fill(out + i * 2, out + frameCount * 2, 0.0f);
+                    break;
+                }
+                position = std::fmod(position, static_cast<double>(data.frameCount));
+            }
+
+            const auto index = static_cast<uint32_t>(position);
+            const auto next = index < last ? index + 1 : (voice.loop ? 0 : last);
+            const auto fraction = static_cast<float>(position - index);
+
+            const auto *a = frames + static_cast<std::size_t>(index) * channels;
+            const auto *b = frames + static_cast<std::size_t>(next) * channels;
+
+            const auto left = a[0] + (b[0] - a[0]) * fraction;
+            const auto right = stereo ? a[1] + (b[1] - a[1]) * fraction : left;
+
+            out[i * 2] = left * leftGain;
+            out[i * 2 + 1] = right * rightGain;
+            leftGain += leftStep;
+            rightGain += rightStep;
+
+            position += step;
+        }
+
+        voice.position = position;
+    }
+
+    void Mixer::mixStream(const uint32_t slot, float *out, const uint32_t frameCount) {
+        auto &stream = streams[slot];
+
+        // Read before the ring, so a writer finishing in between is never mistaken for having run dry
+        const auto ended = stream.ended->load(std::memory_order_acquire);
+        const auto read = stream.ring->read(out, frameCount);
+        std::fill(out + read * CHANNELS, out + frameCount * CHANNELS, 0.0f);
+
+        if (read < frameCount && !ended) {
+            counters.streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint32_t i = 0;
+        for (; i < frameCount && stream.rampFrames > 0; ++i, --stream.rampFrames) {
+            stream.gain += stream.step;
+            out[i * 2] *= stream.gain;
+            out[i * 2 + 1] *= stream.gain;
+        }
+
+        if (stream.rampFrames == 0) {
+            // Lands exactly on the target whatever rounding the steps accumulated
+            stream.gain = stream.target;
+
+            for (; i < frameCount; ++i) {
+                out[i * 2] *= stream.gain;
+                out[i * 2 + 1] *= stream.gain;
+            }
+        }
+
+        if ((stream.stopWhenSilent && stream.rampFrames == 0 && stream.gain <= 0.0f) ||
+            (ended && stream.ring->readable() == 0)) {
+            releaseStream(slot);
+        }
+    }
+
+    void Mixer::processEffects(const uint32_t index, float *buffer, const uint32_t frameCount) {
+        const auto &bus = buses[index];
+        if (bus.effectCount == 0) {
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < bus.effectCount; ++i) {
+            bus.effects[i]->process(buffer, frameCount);
+        }
+
+        counters.effectNanos[index].fetch_add(nanosSince(start), std::memory_order_relaxed);
+    }
+
+    void Mixer::renderBlock(float *out, const uint32_t frameCount) {
+        const auto samples = frameCount * CHANNELS;
+
+        std::memset(out, 0, sizeof(float) * samples);
+
+        for (uint32_t bus = 0; bus < MAX_BUSES; ++bus) {
+            if (buses[bus].active) {
+                std::memset(busBuffers[bus].data(), 0, sizeof(float) * samples);
+            }
+        }
+
+        uint32_t activeVoices = 0;
+        uint32_t culledVoices = 0;
+
+        // Each voice is rendered once, then added to its bus and to every bus it sends to
+        for (auto &voice: voices) {
+            if (!voice.active) {
+                continue;
+            }
+
+            ++activeVoices;
+
+            if (voice.positional) {
+                placeVoice(voice);
+            }
+
+            // Out of range and already faded out, so nothing would be heard
+            if (voice.attenuation == 0.0f && (!voice.rendered || (voice.leftGain == 0.0f && voice.rightGain == 0.0f))) {
+                skipVoice(voice, voiceBuffer.data(), frameCount);
+                ++culledVoices;
+                continue;
+            }
+
+            mixVoice(voice, voiceBuffer.data(), frameCount);
+            accumulate(busBuffers[voice.bus].data(), voiceBuffer.data(), samples, 1.0f);
+
+            for (const auto &send: voice.sends) {
+                if (send.bus != NO_BUS) {
+                    accumulate(busBuffers[send.bus].data(), voiceBuffer.data(), samples, send.level);
+                }
+            }
+        }
+
+        counters.activeVoices.store(activeVoices, std::memory_order_relaxed);
+        counters.culledVoices.store(culledVoices, std::memory_order_relaxed);
+        if (activeVoices > counters.peakVoices.load(std::memory_order_relaxed)) {
+            counters.peakVoices.store(activeVoices, std::memory_order_relaxed);
+        }
+
+        for (uint32_t slot = 0; slot < MAX_STREAMS; ++slot) {
+            if (!streams[slot].ring) {
+                continue;
+            }
+
+            const auto bus = streams[slot].bus;
+            mixStream(slot, voiceBuffer.data(), frameCount);
+            accumulate(busBuffers[bus].data(), voiceBuffer.data(), samples, 1.0f);
+        }
+
+        for (uint32_t index = 0; index < MAX_BUSES; ++index) {
+            const auto &bus = buses[index];
+            if (!bus.active) {
+                continue;
+            }
+
+            processEffects(index, busBuffers[index].data(), frameCount);
+            accumulate(out, busBuffers[index].data(), samples, bus.gain);
+        }
+
+        processEffects(MASTER_INDEX, out, frameCount);
+
+        const auto &master = buses[MASTER_INDEX];
+        for (uint32_t i = 0; i < samples; ++i) {
+            out[i] = std::clamp(out[i] * master.gain, -1.0f, 1.0f);
+        }
+    }
+
+    void Mixer::render(float *out, const uint32_t frameCount) {
+        if (frameCount == 0) {
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        uint32_t offset = 0;
+
+        while (offset < frameCount) {
+            drainCommands();
+
+            auto length = std::min(MAX_BLOCK_FRAMES, frameCount - offset);
+
+            // Cut the block where the next scheduled command is due
+            if (scheduledCount > 0) {
+                length = static_cast<uint32_t>(std::min<uint64_t>(length, scheduled[0].time - time));
+            }
+
+            renderBlock(out + offset * CHANNELS, length);
+
+            offset += length;
+            time += length;
+        }
+
+        clock.store(time, std::memory_order_relaxed);
+        recordCallback(frameCount, nanosSince(start));
+    }
+} // audio
+// blipcade
@@ -0,0 +1,511 @@
+// mixer.h
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "effect.h"
+#include "samplering.h"
+#include "spscqueue.h"
+#include "synth.h"
+
+namespace blipcade::audio {
+    using SoundHandle = uint32_t;
+
+    // Identifies one play call. Handed out by the game thread and matched against voices on the audio thread, so a
+    // handle simply stops matching once its voice finishes or is stolen. Zero is never a valid handle.
+    using VoiceHandle = uint32_t;
+
+    constexpr VoiceHandle NO_VOICE = 0;
+
+    using InstrumentHandle = uint32_t;
+
+    using BusHandle = uint32_t;
+
+    // Buses every mixer starts with
+    constexpr BusHandle BUS_MUSIC = 0;
+    constexpr BusHandle BUS_SFX = 1;
+    constexpr BusHandle BUS_AMBIENCE = 2;
+    constexpr BusHandle BUS_UI = 3;
+
+    // The sum of all buses, for effects that should hear everything
+    constexpr BusHandle MASTER_BUS = 0xfffffffe;
+    constexpr BusHandle NO_BUS = 0xffffffff;
+
+    // Copies a voice into another bus on top of its own, e.g. a shared room reverb
+    struct Send {
+        BusHandle bus = NO_BUS;
+        float level = 0.0f;
+    };
+
+    // A sound converted to the mixer's format: float frames at SAMPLE_RATE, mono or stereo. Shared by every sound
+    // loaded from the same file.
+    struct SampleData {
+        std::vector<float> frames;
+        uint32_t channels = 0;
+        uint32_t frameCount = 0;
+    };
+
+    struct VoiceParams {
+        float gain = 1.0f;
+        // -1 is hard left, 1 is hard right
+        float pan = 0.0f;
+        // Playback rate, 2 is an octave up
+        float pitch = 1.0f;
+        bool loop = false;
+    };
+
+    // Where a positional voice sits, in the same world units as the listener
+    struct Emitter {
+        float x = 0.0f;
+        float y = 0.0f;
+        // Silent from this distance on
+        float radius = 0.0f;
+        // Exponent of the attenuation curve; 1 fades linearly to the radius, higher values fall off sooner
+        float falloff = 1.0f;
+    };
+
+    // What the audio thread reports about its own work, as of the last block it rendered
+    struct MixerStats {
+        static constexpr uint32_t HISTOGRAM_BUCKETS = 6;
+
+        // Upper bounds of the callback time buckets, as a share of the callback's budget: the time its frames take to
+        // play. The last bucket holds every callback over budget.
+        static constexpr std::array<float, HISTOGRAM_BUCKETS - 1> BUCKET_LIMITS = {0.125f, 0.25f, 0.5f, 0.75f, 1.0f};
+
+        struct Bus {
+            std::string name;
+            uint32_t effects = 0;
+            // Spent in the bus's effect chain
+            double effectSeconds = 0.0;
+        };
+
+        uint64_t callbacks = 0;
+        // Audio the callbacks produced
+        double mixedSeconds = 0.0;
+        std::array<uint64_t, HISTOGRAM_BUCKETS> callbackHistogram{};
+        double lastCallbackSeconds = 0.0;
+        double worstCallbackSeconds = 0.0;
+        // Time spent mixing over the time the mixed audio plays for; 1 or more cannot keep up
+        double load = 0.0;
+        // Callbacks over budget, each most likely heard as a gap where the device ran dry
+        uint64_t underruns = 0;
+        // Blocks a music stream padded with silence because its decoder fell behind
+        uint64_t streamUnderruns = 0;
+        uint32_t activeVoices = 0;
+        uint32_t peakVoices = 0;
+        // Positional voices out of range of the listener
+        uint32_t culledVoices = 0;
+        uint64_t stolenVoices = 0;
+        // Sounds not played because the pool was full and the steal policy is Never
+        uint64_t droppedVoices = 0;
+        uint64_t droppedCommands = 0;
+        // Every created bus, then the master chain
+        std::vector<Bus> buses;
+    };
+
+    // Software mixer rendering every playing sound into one interleaved stereo float stream.
+    // Voices come from a fixed pool allocated up front; playing the same sound again starts another voice instead
+    // of restarting the first one. When the pool is full a voice is stolen according to the steal policy.
+    //
+    // Each voice plays into one bus and may send to up to MAX_SENDS more. Every bus runs its own effect chain and
+    // gain before the buses are summed into the master chain.
+    //
+    // Voices can also be synth notes, generated on the audio thread from an instrument instead of read from a sound.
+    //
+    // Positional voices are placed in the world around a listener. Their attenuation and pan are worked out again at
+    // the start of every block, and a voice out of range of the listener is culled: it keeps its place in the sound
+    // but is neither rendered nor mixed until it is audible again.
+    //
+    // Long music plays from streams instead: the audio thread pulls already decoded stereo frames out of a ring that
+    // another thread keeps filled, so a track never has to be decoded in full.
+    //
+    // The game thread never touches voices directly. Its calls become commands on a lock-free queue that the audio
+    // thread drains between blocks, so the audio path takes no locks. Commands may carry a time on the mixer clock;
+    // the audio thread splits its blocks at those times so they land on the exact sample.
+    class Mixer {
+    public:
+        static constexpr uint32_t SAMPLE_RATE = audio::SAMPLE_RATE;
+        static constexpr uint32_t CHANNELS = 2;
+        static constexpr uint32_t MAX_VOICES = 32;
+        static constexpr uint32_t MAX_BUSES = 8;
+        static constexpr uint32_t MAX_BUS_EFFECTS = 4;
+        static constexpr uint32_t MAX_SENDS = 2;
+        static constexpr uint32_t MAX_STREAMS = 4;
+        // Playback rates are clamped to this range, and a non-finite one plays at 1
+        static constexpr float MIN_PITCH = 0.01f;
+        static constexpr float MAX_PITCH = 8.0f;
+
+        enum class StealPolicy {
+            // The voice that started first
+            Oldest,
+            // The voice with the lowest gain
+            Quietest,
+            // Drop the new sound instead
+            Never,
+        };
+
+        Mixer();
+
+        // Game thread API
+
+        // Converts `frameCount` interleaved frames to SampleData: resampled to SAMPLE_RATE, and channels past the
+        // first two dropped. Mono sounds are played on both channels.
+        static std::shared_ptr<const SampleData> convertSamples(const float *frames, uint32_t frameCount,
+                                                                uint32_t channels, uint32_t sampleRate);
+
+        SoundHandle addSound(std::shared_ptr<const SampleData> data);
+
+        // Shorthand for addSound(convertSamples(...))
+        SoundHandle addSound(const float *frames, uint32_t frameCount, uint32_t channels, uint32_t sampleRate);
+
+        // `atFrame` is a time on the mixer clock (see getTime); 0 or a time already passed starts on the next block.
+        // The handle is valid right away even though the voice only starts on the audio thread.
+        VoiceHandle play(SoundHandle sound, const VoiceParams &params = {}, uint64_t atFrame = 0);
+
+        // Plays the sound as a positional voice; an emitter with no radius is never heard
+        VoiceHandle playAt(SoundHandle sound, const Emitter &emitter, const VoiceParams &params = {},
+                           uint64_t atFrame = 0);
+
+        // Moves a positional voice; ignored for other voices
+        void setVoicePosition(VoiceHandle voice, float x, float y);
+
+        // Positional voices are heard from (x, y). An emitter `panWidth` away to a side is panned fully to it.
+        void setListener(float x, float y, float panWidth);
+
+        // Synth notes go into their release rather than cutting off
+        void stop(VoiceHandle voice, uint64_t atFrame = 0);
+
+        void setVoiceParams(VoiceHandle voice, float gain, float pan, float pitch);
+
+        // Stops every voice playing the sound
+        void stopSound(SoundHandle sound);
+
+        // As of the last block the audio thread rendered, so a sound played just now may not report yet
+        [[nodiscard]] bool isSoundPlaying(SoundHandle sound) const;
+
+        // True until the voice ends, is stopped or stolen, or turns out not to have started because no voice was
+        // free. A voice the audio thread has not got to yet counts as playing; one waiting for a later `atFrame`
+        // does not, until it starts.
+        [[nodiscard]] bool isVoicePlaying(VoiceHandle voice) const;
+
+        // Scales every voice of the sound, current and future
+        void setSoundGain(SoundHandle sound, float gain);
+
+        void setStealPolicy(StealPolicy policy);
+
+        // Instruments are never removed, like sounds. Out-of-range settings are clamped, see clampInstrument.
+        InstrumentHandle addInstrument(const Instrument &instrument, BusHandle bus = BUS_SFX);
+
+        // `note` is a MIDI note number, fractional for detuning. The note is released after `duration` seconds, or
+        // held until stop when it is 0. `params.loop` is ignored.
+        VoiceHandle playNote(InstrumentHandle instrument, float note, float duration, const VoiceParams &params = {},
+                             uint64_t atFrame = 0);
+
+        // Bus for new voices of the sound; BUS_SFX until changed
+        void setSoundBus(SoundHandle sound, BusHandle bus);
+
+        // Send for new voices of the sound. A level of 0 removes the send.
+        void setSoundSend(SoundHandle sound, BusHandle bus, float level);
+
+        void setVoiceSend(VoiceHandle voice, BusHandle bus, float level);
+
+        // Returns the existing bus if the name is taken, NO_BUS once all MAX_BUSES are in use
+        BusHandle createBus(const std::string &name);
+
+        // "music", "sfx", "ambience", "ui", "master" or a created bus; NO_BUS if unknown
+        [[nodiscard]] BusHandle findBus(const std::string &name) const;
+
+        void setBusGain(BusHandle bus, float gain);
+
+        // Effects run in the order added. MASTER_BUS runs them on the final mix.
+        void addBusEffect(BusHandle bus, std::unique_ptr<Effect> effect);
+
+        void clearBusEffects(BusHandle bus);
+
+        // Plays `ring` in stream slot `slot`, replacing whatever the slot held, ramping in from silence over
+        // `fadeFrames`. The ring and `ended` must stay alive until getActiveStream(slot) no longer returns `id`
+        // after the command was received (see getReceivedCommands). Once `ended` is set and the ring runs dry the
+        // stream stops by itself; until then an empty ring plays silence.
+        bool startStream(uint32_t slot, uint32_t id, SampleRing *ring, const std::atomic<bool> *ended, BusHandle bus,
+                         float gain, uint32_t fadeFrames);
+
+        // Ramps the stream's gain to `gain` over `fadeFrames`; with `stopWhenSilent` it stops on reaching zero
+        void fadeStream(uint32_t slot, float gain, uint32_t fadeFrames, bool stopWhenSilent = false);
+
+        void stopStream(uint32_t slot);
+
+        // Id of the stream the audio thread is playing in the slot, 0 if none
+        [[nodiscard]] uint32_t getActiveStream(uint32_t slot) const;
+
+        // Frames rendered so far
+        [[nodiscard]] uint64_t getTime() const;
+
+        // Commands lost because the queue was full
+        [[nodiscard]] uint64_t getDroppedCommands() const;
+
+        [[nodiscard]] MixerStats getStats() const;
+
+        // Zeroes what the audio thread counts, once it gets to the command; dropped commands keep counting
+        void resetStats();
+
+        // Commands queued so far; once getReceivedCommands reaches a value read right after a call, the audio thread
+        // has applied it
+        [[nodiscard]] uint64_t getSentCommands() const;
+
+        [[nodiscard]] uint64_t getReceivedCommands() const;
+
+        // Audio thread: mixes `frameCount` interleaved stereo frames into `out`, overwriting it. Work is done in
+        // blocks of at most MAX_BLOCK_FRAMES.
+        void render(float *out, uint32_t frameCount);
+
+    private:
+        static constexpr std::size_t COMMAND_CAPACITY = 1024;
+        static constexpr uint32_t MAX_SCHEDULED = 256;
+
+        // Index of the master chain in the per-bus arrays
+        static constexpr uint32_t MASTER_INDEX = MAX_BUSES;
+
+        using Sends = std::array<Send, MAX_SENDS>;
+
+        struct Sound {
+            std::shared_ptr<const SampleData> data;
+            // Game thread only, copied into each new voice
+            BusHandle bus = BUS_SFX;
+            Sends sends;
+            // Audio thread only
+            float gain = 1.0f;
+            // Written by the audio thread, read by isSoundPlaying
+            std::atomic<uint32_t> activeVoices{0};
+        };
+
+        struct InstrumentEntry {
+            Instrument instrument;
+            BusHandle bus = BUS_SFX;
+        };
+
+        struct Voice {
+            // Exactly one of sound and instrument is set
+            Sound *sound = nullptr;
+            const Instrument *instrument = nullptr;
+            Synth synth;
+            SoundHandle soundHandle = 0;
+            VoiceHandle handle = NO_VOICE;
+            // Fractional frame into the sound
+            double position = 0.0;
+            float gain = 1.0f;
+            float pan = 0.0f;
+            float pitch = 1.0f;
+            bool loop = false;
+            bool active = false;
+            BusHandle bus = BUS_SFX;
+            Sends sends;
+            // Order the voice was started in, for stealing the oldest
+            uint64_t startedAt = 0;
+            bool positional = false;
+            Emitter emitter;
+            // Distance gain and pan from the listener, updated every block; 1 and 0 for other voices
+            float attenuation = 1.0f;
+            float spatialPan = 0.0f;
+            // Channel gains the last block ended on. Each block ramps from them, so gain and pan changes do not click.
+            float leftGain = 0.0f;
+            float rightGain = 0.0f;
+            bool rendered = false;
+        };
+
+        struct Command {
+            enum class Type : uint8_t {
+                Play,
+                Stop,
+                SetVoiceParams,
+                PlayNote,
+                StopSound,
+                SetSoundGain,
+                SetStealPolicy,
+                SetVoiceSend,
+                CreateBus,
+                SetBusGain,
+                AddEffect,
+                ClearEffects,
+                StartStream,
+                FadeStream,
+                StopStream,
+                SetVoicePosition,
+                SetListener,
+                ResetStats,
+            };
+
+            Type type = Type::Play;
+            // Mixer clock frame to apply at, 0 for as soon as possible
+            uint64_t time = 0;
+            VoiceHandle voice = NO_VOICE;
+            SoundHandle soundHandle = 0;
+            Sound *sound = nullptr;
+            VoiceParams params;
+            const Instrument *instrument = nullptr;
+            float note = 0.0f;
+            uint32_t holdFrames = 0;
+            StealPolicy policy = StealPolicy::Oldest;
+            // Target of bus commands, and the voice's bus for Play
+            BusHandle bus = NO_BUS;
+            Sends sends;
+            Effect *effect = nullptr;
+            // Stream commands
+            uint32_t slot = 0;
+            uint32_t stream = 0;
+            SampleRing *ring = nullptr;
+            const std::atomic<bool> *ended = nullptr;
+            uint32_t fadeFrames = 0;
+            bool stopWhenSilent = false;
+            // Positional commands; SetListener keeps its pan width in the radius
+            Emitter emitter;
+            bool positional = false;
+        };
+
+        struct BusState {
+            std::string name;
+            bool created = false;
+            std::vector<std::unique_ptr<Effect>> effects;
+        };
+
+        struct Stream {
+            SampleRing *ring = nullptr;
+            const std::atomic<bool> *ended = nullptr;
+            uint32_t id = 0;
+            BusHandle bus = BUS_MUSIC;
+            float gain = 0.0f;
+            float target = 0.0f;
+            float step = 0.0f;
+            uint32_t rampFrames = 0;
+            bool stopWhenSilent = false;
+        };
+
+        // Audio thread counters behind MixerStats, updated as it renders
+        struct Counters {
+            std::atomic<uint64_t> callbacks{0};
+            std::array<std::atomic<uint64_t>, MixerStats::HISTOGRAM_BUCKETS> callbackHistogram{};
+            std::atomic<uint64_t> lastCallbackNanos{0};
+            std::atomic<uint64_t> worstCallbackNanos{0};
+            std::atomic<uint64_t> callbackNanos{0};
+            std::atomic<uint64_t> callbackFrames{0};
+            std::atomic<uint64_t> underruns{0};
+            std::atomic<uint64_t> streamUnderruns{0};
+            std::atomic<uint32_t> activeVoices{0};
+            std::atomic<uint32_t> peakVoices{0};
+            std::atomic<uint32_t> culledVoices{0};
+            std::atomic<uint64_t> stolenVoices{0};
+            std::atomic<uint64_t> droppedVoices{0};
+            std::array<std::atomic<uint64_t>, MAX_BUSES + 1> effectNanos{};
+        };
+
+        struct Bus {
+            bool active = false;
+            float gain = 1.0f;
+            std::array<Effect *, MAX_BUS_EFFECTS> effects{};
+            uint32_t effectCount = 0;
+        };
+
+        // Game thread state. Sounds are never unloaded, so voices keep plain pointers into them.
+        std::vector<std::unique_ptr<Sound>> sounds;
+        std::vector<std::unique_ptr<InstrumentEntry>> instruments;
+        // MAX_BUSES buses, then the master chain
+        std::array<BusState, MAX_BUSES + 1> busStates;
+        // Cleared effects wait here until the audio thread has seen the command detaching them
+        std::vector<std::pair<uint64_t, std::unique_ptr<Effect>>> retiredEffects;
+        VoiceHandle nextVoice = 1;
+        uint64_t sentCommands = 0;
+        uint64_t droppedCommands = 0;
+
+        SpscQueue<Command, COMMAND_CAPACITY> commands;
+        std::atomic<uint64_t> receivedCommands{0};
+        std::atomic<uint64_t> clock{0};
+        std::array<std::atomic<uint32_t>, MAX_STREAMS> activeStreams{};
+        // Handle of each voice while it is active, else NO_VOICE, and the newest handle whose play command the
+        // audio thread has handled; read by isVoicePlaying
+        std::array<std::atomic<VoiceHandle>, MAX_VOICES> voiceHandles{};
+        std::atomic<VoiceHandle> receivedVoice{NO_VOICE};
+        Counters counters;
+
+        // Audio thread state
+        std::array<Voice, MAX_VOICES> voices;
+        std::array<Stream, MAX_STREAMS> streams;
+        // Commands waiting for their time, sorted by it
+        std::array<Command, MAX_SCHEDULED> scheduled;
+        uint32_t scheduledCount = 0;
+        std::array<Bus, MAX_BUSES + 1> buses;
+        std::array<std::array<float, MAX_BLOCK_FRAMES * CHANNELS>, MAX_BUSES> busBuffers{};
+        std::array<float, MAX_BLOCK_FRAMES * CHANNELS> voiceBuffer{};
+        StealPolicy stealPolicy = StealPolicy::Oldest;
+        float listenerX = 0.0f;
+        float listenerY = 0.0f;
+        float listenerPanWidth = 0.0f;
+        uint64_t startCounter = 0;
+        uint64_t time = 0;
+
+        bool send(const Command &command);
+
+        VoiceHandle playSound(SoundHandle sound, const VoiceParams &params, uint64_t atFrame, const Emitter *emitter);
+
+        // A negative or NaN rate would walk the read position out of the sample buffer
+        static float clampPitch(float pitch);
+
+        // Index into the per-bus arrays, or -1 when the bus does not exist; MASTER_BUS only with `allowMaster`
+        [[nodiscard]] int busIndex(BusHandle bus, bool allowMaster) const;
+
+        static void setSend(Sends &sends, BusHandle bus, float level);
+
+        void releaseRetiredEffects();
+
+        // Audio thread: pops every queued command, applying the due ones and scheduling the rest
+        void drainCommands();
+
+        void apply(const Command &command);
+
+        // Free voice, else one to steal, else nullptr
+        Voice *allocateVoice();
+
+        Voice *findVoice(VoiceHandle handle);
+
+        void releaseVoice(Voice &voice);
+
+        void renderBlock(float *out, uint32_t frameCount);
+
+        // Runs the bus's effect chain (MASTER_INDEX for the master chain) over `buffer`, timing it
+        void processEffects(uint32_t index, float *buffer, uint32_t frameCount);
+
+        void recordCallback(uint32_t frameCount, uint64_t nanos);
+
+        void resetCounters();
+
+        // Attenuation and pan of a positional voice as heard from the listener
+        void placeVoice(Voice &voice) const;
+
+        // Moves a culled voice on by `frameCount` as if it had played, releasing it if that ends it. Synth notes
+        // still render into `scratch` so their envelope runs.
+        void skipVoice(Voice &voice, float *scratch, uint32_t frameCount);
+
+        // Writes the voice's panned output to `out`, zero-filling whatever follows its end
+        void mixVoice(Voice &voice, float *out, uint32_t frameCount);
+
+        void mixSynthVoice(Voice &voice, float *out, uint32_t frameCount);
+
+        // Gains the block starts on and their per-frame steps towards this block's gain and pan
+        static void rampGains(Voice &voice, float gain, uint32_t frameCount, float &left, float &right,
+                              float &leftStep, float &rightStep);
+
+        // Same for a stream; a ring that ran short is padded with silence
+        void mixStream(uint32_t slot, float *out, uint32_t frameCount);
+
+        void releaseStream(uint32_t slot);
+    };
+} // audio
+// blipcade
+
+#endif // MIXER_H
@@ -0,0 +1,232 @@
+// music.cpp
+
+#include "music.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace blipcade::audio {
+    MusicPlayer::MusicPlayer(Mixer &mixer) : mixer(mixer) {
+#ifndef EMSCRIPTEN
+        worker = std::thread(&MusicPlayer::workerLoop, this);
+#endif
+    }
+
+    MusicPlayer::~MusicPlayer() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    bool MusicPlayer::play(const std::string &path, const bool loop, const float fade, const float volume) {
+        auto decoder = StreamDecoder::open(path);
+        if (!decoder) {
+            return false;
+        }
+
+        auto track = std::make_shared<Track>();
+        track->step = static_cast<double>(decoder->sampleRate()) / Mixer::SAMPLE_RATE;
+        track->source.resize(static_cast<std::size_t>(CHUNK_FRAMES) * decoder->channels());
+        track->output.resize(static_cast<std::size_t>(CHUNK_FRAMES) * Mixer::CHANNELS);
+        track->decoder = std::move(decoder);
+        track->loop = loop;
+        track->volume = volume;
+
+        // A little audio up front so the first blocks do not underrun while the worker catches up. The track is
+        // not listed yet, so nothing else touches it and the decode needs no lock.
+        fill(*track, CHUNK_FRAMES * 2);
+
+        std::lock_guard lock(mutex);
+
+        track->slot = freeSlot();
+        track->id = nextId;
+        if (++nextId == 0) {
+            nextId = 1;
+        }
+
+        if (current) {
+            mixer.fadeStream(current->slot, 0.0f, fadeFrames(fade), true);
+        }
+
+        if (!mixer.startStream(track->slot, track->id, &track->ring, &track->ended, BUS_MUSIC, volume,
+                               fadeFrames(fade))) {
+            current = nullptr;
+            return false;
+        }
+        track->startSeq = mixer.getSentCommands();
+
+        current = track.get();
+        tracks.push_back(std::move(track));
+        wake.notify_one();
+        return true;
+    }
+
+    void MusicPlayer::stop(const float fade) {
+        std::lock_guard lock(mutex);
+
+        if (!current) {
+            return;
+        }
+
+        if (fade > 0.0f) {
+            mixer.fadeStream(current->slot, 0.0f, fadeFrames(fade), true);
+        } else {
+            mixer.stopStream(current->slot);
+        }
+        current = nullptr;
+    }
+
+    void MusicPlayer::setVolume(const float volume) {
+        std::lock_guard lock(mutex);
+
+        if (current) {
+            current->volume = volume;
+            // A few milliseconds of ramp so the step does not click
+            mixer.fadeStream(current->slot, volume, fadeFrames(0.01f));
+        }
+    }
+
+    bool MusicPlayer::isPlaying() const {
+        std::lock_guard lock(mutex);
+        return current != nullptr;
+    }
+
+    void MusicPlayer::update() {
+        {
+            std::lock_guard lock(mutex);
+
+            const auto received = mixer.getReceivedCommands();
+            std::erase_if(tracks, [this, received](const std::shared_ptr<Track> &track) {
+                const auto finished = received >= track->startSeq && mixer.getActiveStream(track->slot) != track->id;
+                if (finished && track.get() == current) {
+                    current = nullptr;
+                }
+                return finished;
+            });
+        }
+
+#ifdef EMSCRIPTEN
+        pump();
+#endif
+    }
+
+    void MusicPlayer::workerLoop() {
+        while (true) {
+            {
+                // Rings hold about a second, so waking every few milliseconds keeps them well ahead of the audio
+                // thread
+                std::unique_lock lock(mutex);
+                wake.wait_for(lock, std::chrono::milliseconds(10), [this] { return stopping; });
+                if (stopping) {
+                    break;
+                }
+            }
+
+            pump();
+        }
+    }
+
+    void MusicPlayer::pump() {
+        {
+            std::lock_guard lock(mutex);
+            claimed.assign(tracks.begin(), tracks.end());
+        }
+
+        // A track dropped by update() meanwhile is kept alive by `claimed` and released below
+        for (const auto &track: claimed) {
+            fill(*track, RING_FRAMES);
+        }
+        claimed.clear();
+    }
+
+    void MusicPlayer::fill(Track &track, const uint32_t maxFrames) {
+        uint32_t produced = 0;
+
+        while (!track.exhausted && produced < maxFrames && track.ring.writable() >= CHUNK_FRAMES) {
+            if (!track.primed) {
+                track.primed = true;
+                if (!nextFrame(track, track.previous) || !nextFrame(track, track.current)) {
+                    track.exhausted = true;
+                    break;
+                }
+            }
+
+            auto *out = track.output.data();
+            uint32_t count = 0;
+
+            while (count < CHUNK_FRAMES) {
+                const auto fraction = static_cast<float>(track.position);
+                out[count * 2] = track.previous[0] + (track.current[0] - track.previous[0]) * fraction;
+                out[count * 2 + 1] = track.previous[1] + (track.current[1] - track.previous[1]) * fraction;
+                ++count;
+
+                track.position += track.step;
+                while (track.position >= 1.0 && !track.exhausted) {
+                    track.position -= 1.0;
+                    track.previous[0] = track.current[0];
+                    track.previous[1] = track.current[1];
+                    track.exhausted = !nextFrame(track, track.current);
+                }
+
+                if (track.exhausted) {
+                    break;
+                }
+            }
+
+            track.ring.write(out, count);
+            produced += count;
+        }
+
+        // Only after the last frames are in the ring, so the audio thread never sees the end before them
+        if (track.exhausted) {
+            track.ended.store(true, std::memory_order_release);
+        }
+    }
+
+    bool MusicPlayer::nextFrame(Track &track, float *frame) {
+        auto &decoder = *track.decoder;
+
+        if (track.sourceOffset == track.sourceFrames) {
+            track.sourceOffset = 0;
+            track.sourceFrames = decoder.read(track.source.data(), CHUNK_FRAMES);
+
+            // Rewinding into the same ring keeps the loop seamless
+            if (track.sourceFrames == 0 && track.loop && decoder.rewind()) {
+                track.sourceFrames = decoder.read(track.source.data(), CHUNK_FRAMES);
+            }
+
+            if (track.sourceFrames == 0) {
+                return false;
+            }
+        }
+
+        const auto channels = decoder.channels();
+        const auto *source = track.source.data() + static_cast<std::size_t>(track.sourceOffset++) * channels;
+
+        // Mono plays on both sides; anything past stereo is dropped
+        frame[0] = source[0];
+        frame[1] = channels >= 2 ? source[1] : source[0];
+        return true;
+    }
+
+    uint32_t MusicPlayer::freeSlot() const {
+        for (uint32_t slot = 0; slot < Mixer::MAX_STREAMS; ++slot) {
+            if (std::none_of(tracks.begin(), tracks.end(), [slot](const auto &track) { return track->slot == slot; })) {
+                return slot;
+            }
+        }
+
+        return tracks.front()->slot;
+    }
+
+    uint32_t MusicPlayer::fadeFrames(const float seconds) {
+        return static_cast<uint32_t>(std::max(0.0f, seconds) * Mixer::SAMPLE_RATE);
+    }
+} // audio
+// blipcade
@@ -0,0 +1,118 @@
+// music.h
+
+#ifndef MUSIC_H
+#define MUSIC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mixer.h"
+#include "samplering.h"
+#include "streamdecoder.h"
+
+namespace blipcade::audio {
+    // Streams music files through the mixer without decoding them up front.
+    // A background thread decodes each playing track a chunk at a time, converts it to the mixer's rate and layout,
+    // and keeps about a second buffered in the track's ring; the audio thread only ever copies out of the ring.
+    // Looping rewinds the decoder into the same ring, so there is no gap at the seam. Starting a track fades out
+    // the previous one, which keeps streaming until it is silent.
+    class MusicPlayer {
+    public:
+        explicit MusicPlayer(Mixer &mixer);
+
+        ~MusicPlayer();
+
+        MusicPlayer(const MusicPlayer &) = delete;
+
+        MusicPlayer &operator=(const MusicPlayer &) = delete;
+
+        // Crossfades over `fade` seconds from whatever is playing. Returns false if the file cannot be opened.
+        bool play(const std::string &path, bool loop = true, float fade = 0.0f, float volume = 1.0f);
+
+        void stop(float fade = 0.0f);
+
+        // Of the current track
+        void setVolume(float volume);
+
+        // True from play until the current track is stopped or, without looping, played out
+        [[nodiscard]] bool isPlaying() const;
+
+        // Game thread, once per frame: frees tracks the audio thread has let go of. Also decodes on platforms
+        // without threads.
+        void update();
+
+    private:
+        // Frames decoded per pass, and how much a ring buffers ahead
+        static constexpr uint32_t CHUNK_FRAMES = 4096;
+        static constexpr uint32_t RING_FRAMES = Mixer::SAMPLE_RATE;
+
+        struct Track {
+            std::unique_ptr<StreamDecoder> decoder;
+            SampleRing ring{RING_FRAMES};
+            std::atomic<bool> ended{false};
+            bool loop = false;
+            float volume = 1.0f;
+
+            uint32_t slot = 0;
+            uint32_t id = 0;
+            // Sent command count after the start, see Mixer::startStream
+            uint64_t startSeq = 0;
+
+            // Linear resampler: the two source frames around the read position
+            double position = 0.0;
+            double step = 1.0;
+            float previous[2]{};
+            float current[2]{};
+            bool primed = false;
+            bool exhausted = false;
+
+            // Decoded source frames waiting to be resampled
+            std::vector<float> source;
+            uint32_t sourceFrames = 0;
+            uint32_t sourceOffset = 0;
+            std::vector<float> output;
+        };
+
+        Mixer &mixer;
+
+        // Guards the track list, never held while decoding. Decoder and resampler state belongs to whichever
+        // thread fills the track: play() before the track is listed, pump() after.
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::thread worker;
+        bool stopping = false;
+
+        // Shared with pump's copy, so update() can drop a track that is still being filled
+        std::vector<std::shared_ptr<Track>> tracks;
+        Track *current = nullptr;
+        uint32_t nextId = 1;
+
+        // The tracks pump is filling; reused so the copy does not allocate every pass
+        std::vector<std::shared_ptr<Track>> claimed;
+
+        void workerLoop();
+
+        // Tops up every track's ring. Takes the mutex only to copy the track list.
+        void pump();
+
+        // Decodes up to `maxFrames` output frames, stopping early when the ring is nearly full
+        static void fill(Track &track, uint32_t maxFrames);
+
+        // Next source frame as stereo, rewinding or ending at the end of the file; false once nothing is left
+        static bool nextFrame(Track &track, float *frame);
+
+        // Mixer slot not used by any live track, else the oldest track's, which is then cut off
+        [[nodiscard]] uint32_t freeSlot() const;
+
+        static uint32_t fadeFrames(float seconds);
+    };
+} // audio
+// blipcade
+
+#endif // MUSIC_H
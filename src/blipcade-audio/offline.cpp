@@ -0,0 +1,114 @@
+// offline.cpp
+
+#include "offline.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace blipcade::audio {
+    namespace {
+        // WAV is little-endian whatever the host is
+        void writeLe(std::ofstream &file, const uint64_t value, const int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                file.put(static_cast<char>((value >> (i * 8)) & 0xff));
+            }
+        }
+
+        constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    }
+
+    OfflineRenderer::OfflineRenderer(Mixer &mixer, const uint32_t blockFrames)
+        : mixer(mixer), blockFrames(blockFrames), block(static_cast<std::size_t>(blockFrames) * Mixer::CHANNELS) {
+    }
+
+    void OfflineRenderer::advance(const double seconds) {
+        pendingFrames += seconds * Mixer::SAMPLE_RATE;
+
+        while (pendingFrames >= blockFrames) {
+            renderFrames(blockFrames);
+            pendingFrames -= blockFrames;
+        }
+    }
+
+    void OfflineRenderer::renderFrames(const uint64_t frameCount) {
+        for (uint64_t rendered = 0; rendered < frameCount; rendered += blockFrames) {
+            mixer.render(block.data(), blockFrames);
+
+            if (capturing) {
+                capture.insert(capture.end(), block.begin(), block.end());
+            }
+        }
+    }
+
+    void OfflineRenderer::flush() {
+        const auto frames = static_cast<uint32_t>(std::llround(pendingFrames));
+        pendingFrames = 0.0;
+
+        if (frames == 0) {
+            return;
+        }
+
+        mixer.render(block.data(), frames);
+
+        if (capturing) {
+            const auto samples = static_cast<std::ptrdiff_t>(frames) * Mixer::CHANNELS;
+            capture.insert(capture.end(), block.begin(), block.begin() + samples);
+        }
+    }
+
+    void OfflineRenderer::setCapture(const bool capture) {
+        capturing = capture;
+    }
+
+    const std::vector<float> &OfflineRenderer::getCapture() const {
+        return capture;
+    }
+
+    void OfflineRenderer::clearCapture() {
+        capture.clear();
+    }
+
+    bool writeWav(const std::string &path, const float *frames, const uint64_t frameCount, const uint32_t channels,
+                  const uint32_t sampleRate) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        const uint64_t dataBytes = frameCount * channels * sizeof(float);
+
+        file.write("RIFF", 4);
+        // fmt (8 + 18), fact (8 + 4) and the data header (8) follow "WAVE"
+        writeLe(file, 4 + 26 + 12 + 8 + dataBytes, 4);
+        file.write("WAVE", 4);
+
+        file.write("fmt ", 4);
+        writeLe(file, 18, 4);
+        writeLe(file, WAVE_FORMAT_IEEE_FLOAT, 2);
+        writeLe(file, channels, 2);
+        writeLe(file, sampleRate, 4);
+        writeLe(file, static_cast<uint64_t>(sampleRate) * channels * sizeof(float), 4);
+        writeLe(file, channels * sizeof(float), 2);
+        writeLe(file, 32, 2);
+        writeLe(file, 0, 2);
+
+        // Required for anything but integer PCM
+        file.write("fact", 4);
+        writeLe(file, 4, 4);
+        writeLe(file, frameCount, 4);
+
+        file.write("data", 4);
+        writeLe(file, dataBytes, 4);
+
+        for (uint64_t i = 0; i < frameCount * channels; ++i) {
+            uint32_t bits;
+            static_assert(sizeof(bits) == sizeof(float));
+            std::memcpy(&bits, frames + i, sizeof(bits));
+            writeLe(file, bits, 4);
+        }
+
+        return static_cast<bool>(file);
+    }
+} // audio
+// blipcade
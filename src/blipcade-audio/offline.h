@@ -0,0 +1,55 @@
+// offline.h
+
+#ifndef OFFLINE_H
+#define OFFLINE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mixer.h"
+
+namespace blipcade::audio {
+    // Drives a mixer without an audio device. The caller's clock decides how much audio is made, and it is always
+    // rendered in blocks of the same size (bar the one short block of flush), so the same commands at the same
+    // simulated times produce the same samples on any machine. Used when no device is available and by the offline
+    // render tool.
+    class OfflineRenderer {
+    public:
+        explicit OfflineRenderer(Mixer &mixer, uint32_t blockFrames = 256);
+
+        // Renders `seconds` of simulated time; a partial block is carried into the next call
+        void advance(double seconds);
+
+        // Renders whole blocks covering at least `frameCount` frames
+        void renderFrames(uint64_t frameCount);
+
+        // Renders the time advance has left pending as one short block, so the output ends exactly where the
+        // simulated clock does
+        void flush();
+
+        // Keeps everything rendered from now on, interleaved stereo; off by default
+        void setCapture(bool capture);
+
+        [[nodiscard]] const std::vector<float> &getCapture() const;
+
+        void clearCapture();
+
+    private:
+        Mixer &mixer;
+        uint32_t blockFrames;
+        bool capturing = false;
+        // Frames of simulated time not yet rendered
+        double pendingFrames = 0.0;
+
+        std::vector<float> block;
+        std::vector<float> capture;
+    };
+
+    // 32-bit float WAV, so a render can be compared bit for bit
+    bool writeWav(const std::string &path, const float *frames, uint64_t frameCount, uint32_t channels,
+                  uint32_t sampleRate);
+} // audio
+// blipcade
+
+#endif // OFFLINE_H
@@ -0,0 +1,154 @@
+// resampler.cpp
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace blipcade::audio {
+    namespace {
+        // Zero crossings of the sinc on each side at full bandwidth
+        constexpr uint32_t HALF_TAPS = 16;
+        // Table entries per zero crossing, linearly interpolated between
+        constexpr uint32_t TABLE_STEPS = 256;
+        // About 80 dB of stopband attenuation
+        constexpr double KAISER_BETA = 8.0;
+        // Largest number of distinct output phases given a precomputed row of weights each
+        constexpr uint64_t MAX_PHASES = 4096;
+        // Share of the lower Nyquist kept, leaving room for the transition band
+        constexpr double PASSBAND = 0.95;
+
+        constexpr double PI = 3.14159265358979323846;
+
+        // Modified Bessel function of the first kind, order 0, for the Kaiser window
+        double besselI0(const double x) {
+            double sum = 1.0;
+            double term = 1.0;
+
+            for (int k = 1; k < 32; ++k) {
+                const auto half = x / (2.0 * k);
+                term *= half * half;
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        // Windowed sinc from 0 to HALF_TAPS zero crossings, with one spare entry for interpolation
+        const std::vector<float> &kernelTable() {
+            static const auto table = [] {
+                std::vector<float> values(HALF_TAPS * TABLE_STEPS + 2, 0.0f);
+                const auto norm = besselI0(KAISER_BETA);
+
+                for (uint32_t i = 0; i <= HALF_TAPS * TABLE_STEPS; ++i) {
+                    const auto u = static_cast<double>(i) / TABLE_STEPS;
+                    const auto sinc = i == 0 ? 1.0 : std::sin(PI * u) / (PI * u);
+                    const auto edge = u / HALF_TAPS;
+                    const auto window = besselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - edge * edge))) / norm;
+                    values[i] = static_cast<float>(sinc * window);
+                }
+
+                return values;
+            }();
+
+            return table;
+        }
+
+        float kernel(const std::vector<float> &table, const double u) {
+            const auto position = u * TABLE_STEPS;
+            const auto index = static_cast<uint32_t>(position);
+            if (index >= HALF_TAPS * TABLE_STEPS) {
+                return 0.0f;
+            }
+
+            const auto fraction = static_cast<float>(position - index);
+            return table[index] + (table[index + 1] - table[index]) * fraction;
+        }
+    }
+
+    std::vector<float> resample(const float *frames, const uint32_t frameCount, const uint32_t channels,
+                                const uint32_t fromRate, const uint32_t toRate) {
+        const auto sampleCount = static_cast<std::size_t>(frameCount) * channels;
+
+        if (fromRate == toRate || fromRate == 0 || toRate == 0 || frameCount == 0) {
+            return {frames, frames + sampleCount};
+        }
+
+        const auto &table = kernelTable();
+
+        // Cutoff relative to the source Nyquist; the kernel stretches by its inverse
+        const auto scale = std::min(1.0, static_cast<double>(toRate) / fromRate) * PASSBAND;
+        const auto reach = static_cast<int64_t>(std::ceil(HALF_TAPS / scale));
+        const auto taps = static_cast<std::size_t>(2 * reach);
+
+        // Output frames fall on `phases` distinct fractions of a source frame, e.g. 160 for 44100 to 48000
+        const auto divisor = std::gcd(fromRate, toRate);
+        const uint64_t phases = toRate / divisor;
+        const uint64_t step = fromRate / divisor;
+
+        const auto fillWeights = [&](const uint64_t phase, float *weights) {
+            const auto fraction = static_cast<double>(phase) / phases;
+            for (std::size_t j = 0; j < taps; ++j) {
+                const auto distance = std::abs(static_cast<double>(reach - 1) - static_cast<double>(j) + fraction);
+                weights[j] = static_cast<float>(scale) * kernel(table, distance * scale);
+            }
+        };
+
+        // One row of weights per phase when that stays small, otherwise a row per output frame
+        const auto precomputed = phases <= MAX_PHASES;
+        std::vector<float> weights(taps * (precomputed ? phases : 1));
+        if (precomputed) {
+            for (uint64_t phase = 0; phase < phases; ++phase) {
+                fillWeights(phase, weights.data() + phase * taps);
+            }
+        }
+
+        const auto outFrames = (static_cast<uint64_t>(frameCount) * toRate + fromRate - 1) / fromRate;
+        std::vector<float> out(outFrames * channels, 0.0f);
+
+        for (uint64_t n = 0; n < outFrames; ++n) {
+            // Exact source position in whole frames plus a phase, so long sounds do not drift
+            const auto position = n * step;
+            const auto center = static_cast<int64_t>(position / phases);
+            const auto phase = position % phases;
+
+            const float *row = weights.data();
+            if (precomputed) {
+                row += phase * taps;
+            } else {
+                fillWeights(phase, weights.data());
+            }
+
+            // Taps cover source frames center - reach + 1 to center + reach, clipped to the sound
+            const auto origin = center - reach + 1;
+            const auto first = std::max<int64_t>(0, origin);
+            const auto last = std::min<int64_t>(frameCount, center + reach + 1);
+
+            // Stereo, the common case, reads each frame once for both channels
+            if (channels == 2) {
+                float left = 0.0f;
+                float right = 0.0f;
+                for (auto k = first; k < last; ++k) {
+                    const auto weight = row[k - origin];
+                    left += frames[k * 2] * weight;
+                    right += frames[k * 2 + 1] * weight;
+                }
+                out[n * 2] = left;
+                out[n * 2 + 1] = right;
+                continue;
+            }
+
+            for (uint32_t channel = 0; channel < channels; ++channel) {
+                float sum = 0.0f;
+                for (auto k = first; k < last; ++k) {
+                    sum += frames[static_cast<std::size_t>(k) * channels + channel] * row[k - origin];
+                }
+                out[n * channels + channel] = sum;
+            }
+        }
+
+        return out;
+    }
+} // audio
+// blipcade
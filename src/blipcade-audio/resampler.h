@@ -0,0 +1,18 @@
+// resampler.h
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace blipcade::audio {
+    // Converts interleaved frames from one rate to another with a Kaiser-windowed sinc, read from a precomputed
+    // table. Converting down narrows the filter to the new rate, so nothing above its Nyquist folds back.
+    // Meant for whole sounds at load time; samples past either end count as silence.
+    std::vector<float> resample(const float *frames, uint32_t frameCount, uint32_t channels, uint32_t fromRate,
+                                uint32_t toRate);
+} // audio
+// blipcade
+
+#endif // RESAMPLER_H
@@ -4,55 +4,115 @@
 
 #include "reverb.h"
 
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
 
 namespace blipcade::audio {
+    namespace {
+        // One-pole low-pass in the comb feedback path; higher values keep more treble
+        constexpr float DAMPING = 0.5f;
 
-    Reverb::Reverb(float mix, float feedback)
-        : mixLevel(mix) {
-        // Initialize delay lines with slightly different delay times for a natural reverb
-        float delays[4] = {0.050f, 0.056f, 0.061f, 0.068f}; // in seconds
-        for (int i = 0; i < 4; ++i) {
-            delayLines.emplace_back(new DelayLine(delays[i], feedback));
-        }
+        // The right channel's combs are a little longer so the two sides decorrelate
+        constexpr uint32_t STEREO_SPREAD = 23;
     }
 
-    Reverb::~Reverb() {
-        for(auto& dl : delayLines) {
-            delete dl;
+    Reverb::Reverb(const float mix, const float feedback)
+        : mixLevel(std::isnan(mix) ? 0.0f : std::clamp(mix, 0.0f, 1.0f)),
+          feedbackFactor(std::isnan(feedback) ? 0.0f : std::clamp(feedback, -MAX_FEEDBACK, MAX_FEEDBACK)) {
+        // Slightly different delay times for a natural reverb
+        const float delays[COMBS] = {0.050f, 0.056f, 0.061f, 0.068f}; // in seconds
+
+        for (int channel = 0; channel < 2; ++channel) {
+            auto &bank = banks[channel];
+
+            uint32_t longest = 0;
+            for (int comb = 0; comb < COMBS; ++comb) {
+                bank.delays[comb] = static_cast<uint32_t>(delays[comb] * SAMPLE_RATE) + channel * STEREO_SPREAD;
+                longest = std::max(longest, bank.delays[comb]);
+            }
+
+            const auto size = ringSize(longest + 1);
+            bank.buffer.assign(static_cast<std::size_t>(size) * COMBS, 0.0f);
+            bank.mask = size - 1;
         }
     }
 
-    float Reverb::ProcessSample(float inputSample) {
-        float reverbSample = 0.0f;
+    void Reverb::processChannel(CombBank &bank, float *samples, const uint32_t count) {
+        auto *buffer = bank.buffer.data();
+        auto writeIndex = bank.writeIndex;
+
+#if defined(__SSE2__)
+        const auto damping = _mm_set1_ps(DAMPING);
+        const auto keep = _mm_set1_ps(1.0f - DAMPING);
+        const auto feedback = _mm_set1_ps(feedbackFactor);
+        auto filter = _mm_loadu_ps(bank.filterState.data());
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const auto input = samples[i];
 
-        for(auto& dl : delayLines) {
-            // Read delayed sample
-            float delayedSample = dl->buffer[dl->writeIndex];
+            // Each lane reads its own comb length back, so the loads are gathered by hand
+            const auto delayed = _mm_setr_ps(buffer[((writeIndex - bank.delays[0]) & bank.mask) * COMBS],
+                                             buffer[((writeIndex - bank.delays[1]) & bank.mask) * COMBS + 1],
+                                             buffer[((writeIndex - bank.delays[2]) & bank.mask) * COMBS + 2],
+                                             buffer[((writeIndex - bank.delays[3]) & bank.mask) * COMBS + 3]);
 
-            // Apply a simple one-pole low-pass filter
-            float alpha = 0.5f; // Adjust for cutoff frequency
-            dl->filterState = alpha * delayedSample + (1.0f - alpha) * dl->filterState;
-            float filteredSample = dl->filterState;
+            filter = _mm_add_ps(_mm_mul_ps(damping, delayed), _mm_mul_ps(keep, filter));
 
-            // Accumulate reverb samples
-            reverbSample += filteredSample;
+            _mm_storeu_ps(buffer + writeIndex * COMBS, _mm_add_ps(_mm_set1_ps(input), _mm_mul_ps(filter, feedback)));
 
-            // Write new sample with feedback
-            dl->buffer[dl->writeIndex] = inputSample + filteredSample * dl->feedback;
+            // Horizontal sum of the four combs as (0 + 2) + (1 + 3), the order the scalar path uses too
+            auto sum = _mm_add_ps(filter, _mm_movehl_ps(filter, filter));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
 
-            // Increment and wrap write index
-            dl->writeIndex = (dl->writeIndex + 1) % dl->size;
+            samples[i] = input + _mm_cvtss_f32(sum) * mixLevel;
+            writeIndex = (writeIndex + 1) & bank.mask;
         }
 
-        // Mix original and reverb signals
-        float outputSample = inputSample + reverbSample * mixLevel;
+        _mm_storeu_ps(bank.filterState.data(), filter);
+#else
+        auto &filter = bank.filterState;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const auto input = samples[i];
+
+            for (int comb = 0; comb < COMBS; ++comb) {
+                const auto delayed = buffer[((writeIndex - bank.delays[comb]) & bank.mask) * COMBS + comb];
+                filter[comb] = DAMPING * delayed + (1.0f - DAMPING) * filter[comb];
+                buffer[writeIndex * COMBS + comb] = input + filter[comb] * feedbackFactor;
+            }
 
-        // Clamp to prevent clipping
-        if(outputSample > 1.0f) outputSample = 1.0f;
-        if(outputSample < -1.0f) outputSample = -1.0f;
+            // Summed in the same pairs as the SSE path, so both render bit-identical output
+            const auto sum = (filter[0] + filter[2]) + (filter[1] + filter[3]);
 
-        return outputSample;
+            samples[i] = input + sum * mixLevel;
+            writeIndex = (writeIndex + 1) & bank.mask;
+        }
+#endif
+
+        bank.writeIndex = writeIndex;
+    }
+
+    void Reverb::process(float *frames, const uint32_t frameCount) {
+        deinterleave(frames, left.data(), right.data(), frameCount);
+
+        processChannel(banks[0], left.data(), frameCount);
+        processChannel(banks[1], right.data(), frameCount);
+
+        interleave(left.data(), right.data(), frames, frameCount);
+    }
+
+    void Reverb::reset() {
+        for (auto &bank: banks) {
+            std::fill(bank.buffer.begin(), bank.buffer.end(), 0.0f);
+            bank.filterState.fill(0.0f);
+            bank.writeIndex = 0;
+        }
     }
 
 } // audio
-// blipcade
\ No newline at end of file
+// blipcade
@@ -3,42 +3,46 @@
 #define REVERB_HPP
 
 #include "effect.h"
+
+#include <array>
 #include <vector>
-#include <cstring> // For memset
 
 
 namespace blipcade::audio {
+    // Four low-passed feedback combs per channel. The combs of a channel share one ring buffer with a frame of four
+    // lanes per sample, so every comb is filtered and written back in a single SIMD step.
     class Reverb : public Effect {
     public:
+        // The combs must decay, or the bus rings forever and grows without limit
+        static constexpr float MAX_FEEDBACK = 0.95f;
+
+        // Out-of-range values are clamped: mix to [0, 1], |feedback| to MAX_FEEDBACK. NaN falls back to 0.
         Reverb(float mix = 0.3f, float feedback = 0.5f);
-        ~Reverb();
 
-        float ProcessSample(float inputSample) override;
+        void process(float *frames, uint32_t frameCount) override;
+
+        void reset() override;
+
+        static constexpr int COMBS = 4;
 
     private:
-        struct DelayLine {
-            float* buffer;
-            int size;
-            int writeIndex;
-            float feedback;
-            float filterState;
-
-            DelayLine(float delaySeconds, float feedbackFactor)
-                : size(static_cast<int>(delaySeconds * SAMPLE_RATE)),
-                  writeIndex(0),
-                  feedback(feedbackFactor),
-                  filterState(0.0f) {
-                buffer = new float[size];
-                std::memset(buffer, 0, sizeof(float) * size);
-            }
-
-            ~DelayLine() {
-                delete[] buffer;
-            }
+        struct CombBank {
+            // COMBS lanes per frame
+            std::vector<float> buffer;
+            uint32_t mask;
+            std::array<uint32_t, COMBS> delays;
+            std::array<float, COMBS> filterState{};
+            uint32_t writeIndex = 0;
         };
 
-        std::vector<DelayLine*> delayLines;
+        std::array<CombBank, 2> banks;
         float mixLevel;
+        float feedbackFactor;
+
+        std::array<float, MAX_BLOCK_FRAMES> left{};
+        std::array<float, MAX_BLOCK_FRAMES> right{};
+
+        void processChannel(CombBank &bank, float *samples, uint32_t count);
     };
 }
-#endif // REVERB_HPP
\ No newline at end of file
+#endif // REVERB_HPP
@@ -0,0 +1,86 @@
+// samplering.h
+
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "effect.h"
+
+namespace blipcade::audio {
+    // Lock-free ring of interleaved stereo frames with one writer thread and one reader thread, moved in bulk.
+    class SampleRing {
+    public:
+        // Rounded up to a power of two
+        explicit SampleRing(const uint32_t frames)
+            : buffer(static_cast<std::size_t>(ringSize(frames)) * 2), mask(ringSize(frames) - 1) {
+        }
+
+        [[nodiscard]] uint32_t capacity() const {
+            return mask + 1;
+        }
+
+        // Writer only
+        [[nodiscard]] uint32_t writable() const {
+            return capacity() - static_cast<uint32_t>(writeIndex.load(std::memory_order_relaxed) -
+                                                      readIndex.load(std::memory_order_acquire));
+        }
+
+        // Reader only
+        [[nodiscard]] uint32_t readable() const {
+            return static_cast<uint32_t>(writeIndex.load(std::memory_order_acquire) -
+                                         readIndex.load(std::memory_order_relaxed));
+        }
+
+        // Writer only; returns the frames actually written
+        uint32_t write(const float *frames, const uint32_t count) {
+            const auto start = writeIndex.load(std::memory_order_relaxed);
+            const auto length = std::min(count, writable());
+
+            copyIn(frames, start, length);
+            writeIndex.store(start + length, std::memory_order_release);
+            return length;
+        }
+
+        // Reader only; returns the frames actually read
+        uint32_t read(float *frames, const uint32_t count) {
+            const auto start = readIndex.load(std::memory_order_relaxed);
+            const auto length = std::min(count, readable());
+
+            copyOut(frames, start, length);
+            readIndex.store(start + length, std::memory_order_release);
+            return length;
+        }
+
+    private:
+        std::vector<float> buffer;
+        uint32_t mask;
+
+        alignas(64) std::atomic<uint64_t> writeIndex{0};
+        alignas(64) std::atomic<uint64_t> readIndex{0};
+
+        // Both copies are at most two memcpys, split where the ring wraps
+        void copyIn(const float *frames, const uint64_t start, const uint32_t length) {
+            const auto offset = static_cast<uint32_t>(start) & mask;
+            const auto first = std::min(length, capacity() - offset);
+
+            std::memcpy(buffer.data() + offset * 2, frames, sizeof(float) * first * 2);
+            std::memcpy(buffer.data(), frames + first * 2, sizeof(float) * (length - first) * 2);
+        }
+
+        void copyOut(float *frames, const uint64_t start, const uint32_t length) const {
+            const auto offset = static_cast<uint32_t>(start) & mask;
+            const auto first = std::min(length, capacity() - offset);
+
+            std::memcpy(frames, buffer.data() + offset * 2, sizeof(float) * first * 2);
+            std::memcpy(frames + first * 2, buffer.data(), sizeof(float) * (length - first) * 2);
+        }
+    };
+} // audio
+// blipcade
+
+#endif // SAMPLERING_H
@@ -0,0 +1,54 @@
+// spscqueue.h
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace blipcade::audio {
+    // Bounded lock-free ring for exactly one producer thread and one consumer thread. Neither side ever blocks:
+    // push fails when the ring is full and pop returns nothing when it is empty.
+    template<typename T, std::size_t Capacity>
+    class SpscQueue {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer only
+        bool push(const T &value) {
+            const auto tail = writeIndex.load(std::memory_order_relaxed);
+            if (tail - readIndex.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+
+            slots[tail & (Capacity - 1)] = value;
+            writeIndex.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only
+        std::optional<T> pop() {
+            const auto head = readIndex.load(std::memory_order_relaxed);
+            if (head == writeIndex.load(std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+
+            T value = slots[head & (Capacity - 1)];
+            readIndex.store(head + 1, std::memory_order_release);
+            return value;
+        }
+
+    private:
+        std::array<T, Capacity> slots{};
+
+        // Free-running counters; the difference is the fill level. Kept on separate cache lines so the two threads
+        // do not invalidate each other's index on every operation.
+        alignas(64) std::atomic<std::size_t> writeIndex{0};
+        alignas(64) std::atomic<std::size_t> readIndex{0};
+    };
+} // audio
+// blipcade
+
+#endif // SPSCQUEUE_H
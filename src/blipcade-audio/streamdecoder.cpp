@@ -0,0 +1,130 @@
+// streamdecoder.cpp
+
+#include "streamdecoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+// Declarations only; the implementations are compiled into raylib's raudio
+#include "external/dr_wav.h"
+#include "external/dr_mp3.h"
+#define STB_VORBIS_HEADER_ONLY
+#include "external/stb_vorbis.c"
+
+namespace blipcade::audio {
+    namespace {
+        class WavDecoder final : public StreamDecoder {
+        public:
+            ~WavDecoder() override {
+                drwav_uninit(&wav);
+            }
+
+            bool open(const std::string &path) {
+                return drwav_init_file(&wav, path.c_str(), nullptr);
+            }
+
+            [[nodiscard]] uint32_t channels() const override { return wav.channels; }
+
+            [[nodiscard]] uint32_t sampleRate() const override { return wav.sampleRate; }
+
+            uint32_t read(float *frames, const uint32_t frameCount) override {
+                return static_cast<uint32_t>(drwav_read_pcm_frames_f32(&wav, frameCount, frames));
+            }
+
+            bool rewind() override {
+                return drwav_seek_to_pcm_frame(&wav, 0);
+            }
+
+        private:
+            drwav wav{};
+        };
+
+        class Mp3Decoder final : public StreamDecoder {
+        public:
+            ~Mp3Decoder() override {
+                drmp3_uninit(&mp3);
+            }
+
+            bool open(const std::string &path) {
+                return drmp3_init_file(&mp3, path.c_str(), nullptr);
+            }
+
+            [[nodiscard]] uint32_t channels() const override { return mp3.channels; }
+
+            [[nodiscard]] uint32_t sampleRate() const override { return mp3.sampleRate; }
+
+            uint32_t read(float *frames, const uint32_t frameCount) override {
+                return static_cast<uint32_t>(drmp3_read_pcm_frames_f32(&mp3, frameCount, frames));
+            }
+
+            bool rewind() override {
+                return drmp3_seek_to_pcm_frame(&mp3, 0);
+            }
+
+        private:
+            drmp3 mp3{};
+        };
+
+        class OggDecoder final : public StreamDecoder {
+        public:
+            ~OggDecoder() override {
+                if (vorbis) {
+                    stb_vorbis_close(vorbis);
+                }
+            }
+
+            bool open(const std::string &path) {
+                int error = 0;
+                vorbis = stb_vorbis_open_filename(path.c_str(), &error, nullptr);
+                if (!vorbis) {
+                    return false;
+                }
+
+                info = stb_vorbis_get_info(vorbis);
+                return true;
+            }
+
+            [[nodiscard]] uint32_t channels() const override { return static_cast<uint32_t>(info.channels); }
+
+            [[nodiscard]] uint32_t sampleRate() const override { return info.sample_rate; }
+
+            uint32_t read(float *frames, const uint32_t frameCount) override {
+                const auto samples = static_cast<int>(frameCount * channels());
+                return static_cast<uint32_t>(stb_vorbis_get_samples_float_interleaved(
+                    vorbis, info.channels, frames, samples));
+            }
+
+            bool rewind() override {
+                return stb_vorbis_seek_start(vorbis);
+            }
+
+        private:
+            stb_vorbis *vorbis = nullptr;
+            stb_vorbis_info info{};
+        };
+
+        template<typename Decoder>
+        std::unique_ptr<StreamDecoder> openWith(const std::string &path) {
+            auto decoder = std::make_unique<Decoder>();
+            if (!decoder->open(path) || decoder->channels() == 0) {
+                return nullptr;
+            }
+            return decoder;
+        }
+    }
+
+    std::unique_ptr<StreamDecoder> StreamDecoder::open(const std::string &path) {
+        auto extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+
+        if (extension == ".wav") return openWith<WavDecoder>(path);
+        if (extension == ".mp3") return openWith<Mp3Decoder>(path);
+        if (extension == ".ogg") return openWith<OggDecoder>(path);
+
+        return nullptr;
+    }
+} // audio
+// blipcade
@@ -0,0 +1,33 @@
+// streamdecoder.h
+
+#ifndef STREAMDECODER_H
+#define STREAMDECODER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace blipcade::audio {
+    // Incremental decoder over a compressed audio file, so only one chunk of PCM exists at a time.
+    // Uses the WAV, MP3 and OGG decoders that raylib already compiles in.
+    class StreamDecoder {
+    public:
+        virtual ~StreamDecoder() = default;
+
+        // Picks a decoder by file extension; nullptr if the format is unknown or the file does not open
+        static std::unique_ptr<StreamDecoder> open(const std::string &path);
+
+        [[nodiscard]] virtual uint32_t channels() const = 0;
+
+        [[nodiscard]] virtual uint32_t sampleRate() const = 0;
+
+        // Reads up to `frameCount` interleaved frames of channels() samples; fewer means the end was reached
+        virtual uint32_t read(float *frames, uint32_t frameCount) = 0;
+
+        // Back to the first frame, for looping
+        virtual bool rewind() = 0;
+    };
+} // audio
+// blipcade
+
+#endif // STREAMDECODER_H
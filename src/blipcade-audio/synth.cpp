@@ -0,0 +1,263 @@
+// synth.cpp
+
+#include "synth.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+namespace blipcade::audio {
+    namespace {
+        // Noise draws values this many times faster than the note frequency, so higher notes hiss brighter
+        constexpr float NOISE_RATE = 16.0f;
+
+        // Smooths a jump of 2 at phase 0, such as where a saw wraps, into a band-limited edge
+        float polyBlep(const float t, const float dt) {
+            if (t < dt) {
+                const auto x = t / dt;
+                return x + x - x * x - 1.0f;
+            }
+            if (t > 1.0f - dt) {
+                const auto x = (t - 1.0f) / dt;
+                return x * x + x + x + 1.0f;
+            }
+            return 0.0f;
+        }
+
+        // Integral of polyBlep: the correction near a corner where the slope turns by 2 per sample
+        float polyBlamp(const float t, const float dt) {
+            if (t < dt) {
+                const auto x = t / dt - 1.0f;
+                return -x * x * x / 3.0f;
+            }
+            if (t > 1.0f - dt) {
+                const auto x = (t - 1.0f) / dt + 1.0f;
+                return x * x * x / 3.0f;
+            }
+            return 0.0f;
+        }
+
+        float clampOr(const float value, const float low, const float high, const float fallback) {
+            return std::isnan(value) ? fallback : std::clamp(value, low, high);
+        }
+
+        float wrap(const float t) {
+            return t >= 1.0f ? t - 1.0f : t;
+        }
+
+        float perFrame(const float amount, const float seconds, const float sampleRate) {
+            return amount / std::max(1.0f, seconds * sampleRate);
+        }
+    }
+
+    std::optional<float> parseNote(const std::string &name) {
+        static constexpr int SEMITONES[] = {9, 11, 0, 2, 4, 5, 7};
+
+        if (name.empty()) {
+            return std::nullopt;
+        }
+
+        const auto letter = std::toupper(static_cast<unsigned char>(name[0]));
+        if (letter < 'A' || letter > 'G') {
+            return std::nullopt;
+        }
+
+        auto semitone = SEMITONES[letter - 'A'];
+        std::size_t index = 1;
+
+        if (index < name.size() && (name[index] == '#' || name[index] == 'b')) {
+            semitone += name[index] == '#' ? 1 : -1;
+            ++index;
+        }
+
+        if (index == name.size()) {
+            return std::nullopt;
+        }
+
+        int octave = 0;
+        const auto negative = name[index] == '-';
+        index += negative ? 1 : 0;
+
+        for (; index < name.size(); ++index) {
+            if (!std::isdigit(static_cast<unsigned char>(name[index]))) {
+                return std::nullopt;
+            }
+            octave = octave * 10 + (name[index] - '0');
+        }
+
+        return static_cast<float>(((negative ? -octave : octave) + 1) * 12 + semitone);
+    }
+
+    Instrument clampInstrument(const Instrument &instrument) {
+        constexpr Instrument defaults;
+        auto clamped = instrument;
+
+        clamped.duty = clampOr(instrument.duty, 0.01f, 0.99f, defaults.duty);
+        clamped.attack = clampOr(instrument.attack, 0.0f, MAX_ENVELOPE_SECONDS, defaults.attack);
+        clamped.decay = clampOr(instrument.decay, 0.0f, MAX_ENVELOPE_SECONDS, defaults.decay);
+        clamped.sustain = clampOr(instrument.sustain, 0.0f, 1.0f, defaults.sustain);
+        clamped.release = clampOr(instrument.release, 0.0f, MAX_ENVELOPE_SECONDS, defaults.release);
+        clamped.arpeggioRate = clampOr(instrument.arpeggioRate, 0.0f, MAX_ARPEGGIO_RATE, defaults.arpeggioRate);
+        clamped.gain = clampOr(instrument.gain, 0.0f, std::numeric_limits<float>::max(), defaults.gain);
+        clamped.slide = std::isnan(instrument.slide) ? defaults.slide : instrument.slide;
+
+        clamped.arpeggioLength = std::min(instrument.arpeggioLength, Instrument::MAX_ARPEGGIO);
+        for (auto &offset: clamped.arpeggio) {
+            offset = std::isnan(offset) ? 0.0f : offset;
+        }
+
+        return clamped;
+    }
+
+    void Synth::start(const Instrument &instrument, const float note, const uint32_t holdFrames,
+                      const uint32_t sampleRate) {
+        this->instrument = &instrument;
+        this->sampleRate = static_cast<float>(sampleRate);
+        this->note = note;
+        this->holdFrames = holdFrames;
+        elapsed = 0;
+
+        attackStep = perFrame(1.0f, instrument.attack, this->sampleRate);
+        decayStep = perFrame(1.0f - instrument.sustain, instrument.decay, this->sampleRate);
+
+        stage = instrument.attack > 0.0f ? Stage::Attack : Stage::Decay;
+        level = instrument.attack > 0.0f ? 0.0f : 1.0f;
+
+        phase = 0.0f;
+        controlCountdown = 0;
+        noiseFrom = nextNoise();
+        noiseTo = nextNoise();
+    }
+
+    void Synth::release() {
+        if (stage == Stage::Release || stage == Stage::Done) {
+            return;
+        }
+
+        stage = Stage::Release;
+        releaseStep = perFrame(level, instrument->release, sampleRate);
+    }
+
+    void Synth::updatePitch(const float pitch) {
+        const auto seconds = static_cast<float>(elapsed) / sampleRate;
+        auto semitones = note + instrument->slide * seconds;
+
+        if (instrument->arpeggioLength > 0) {
+            const auto step = static_cast<uint32_t>(seconds * instrument->arpeggioRate);
+            semitones += instrument->arpeggio[step % instrument->arpeggioLength];
+        }
+
+        const auto frequency = 440.0f * std::exp2((semitones - 69.0f) / 12.0f) * pitch;
+        // Past half the rate a waveform has nothing left to band-limit
+        increment = std::clamp(frequency / sampleRate, 0.0f, 0.5f);
+    }
+
+    float Synth::advanceEnvelope() {
+        if (holdFrames > 0 && elapsed >= holdFrames) {
+            release();
+        }
+
+        switch (stage) {
+            case Stage::Attack:
+                level += attackStep;
+                if (level >= 1.0f) {
+                    level = 1.0f;
+                    stage = Stage::Decay;
+                }
+                break;
+            case Stage::Decay:
+                level -= decayStep;
+                if (level <= instrument->sustain) {
+                    level = instrument->sustain;
+                    stage = Stage::Sustain;
+                }
+                break;
+            case Stage::Sustain:
+                break;
+            case Stage::Release:
+                level -= releaseStep;
+                if (level <= 0.0f) {
+                    level = 0.0f;
+                    stage = Stage::Done;
+                }
+                break;
+            case Stage::Done:
+                break;
+        }
+
+        return level;
+    }
+
+    float Synth::nextNoise() {
+        // xorshift32
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        return static_cast<float>(noiseState) / 2147483648.0f - 1.0f;
+    }
+
+    float Synth::oscillate() {
+        const auto t = phase;
+        const auto dt = increment;
+        float value = 0.0f;
+
+        switch (instrument->waveform) {
+            case Waveform::Square: {
+                const auto duty = std::clamp(instrument->duty, 0.01f, 0.99f);
+                value = t < duty ? 1.0f : -1.0f;
+                value += polyBlep(t, dt);
+                value -= polyBlep(wrap(t - duty + 1.0f), dt);
+                break;
+            }
+            case Waveform::Triangle:
+                value = 1.0f - 4.0f * std::abs(t - 0.5f);
+                // The slope turns by 8 per period, or 8 * dt per sample, at each corner
+                value += 4.0f * dt * (polyBlamp(t, dt) - polyBlamp(wrap(t + 0.5f), dt));
+                break;
+            case Waveform::Saw:
+                value = 2.0f * t - 1.0f - polyBlep(t, dt);
+                break;
+            case Waveform::Noise:
+                value = noiseFrom + (noiseTo - noiseFrom) * t;
+                phase += std::min(1.0f, dt * NOISE_RATE);
+                if (phase >= 1.0f) {
+                    phase -= 1.0f;
+                    noiseFrom = noiseTo;
+                    noiseTo = nextNoise();
+                }
+                return value;
+        }
+
+        phase += dt;
+        if (phase >= 1.0f) {
+            phase -= 1.0f;
+        }
+
+        return value;
+    }
+
+    bool Synth::render(float *out, const uint32_t frameCount, const float pitch) {
+        const auto gain = instrument ? instrument->gain : 0.0f;
+
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            if (stage == Stage::Done) {
+                std::fill(out + i, out + frameCount, 0.0f);
+                return false;
+            }
+
+            if (controlCountdown == 0) {
+                updatePitch(pitch);
+                controlCountdown = CONTROL_FRAMES;
+            }
+            --controlCountdown;
+
+            const auto envelope = advanceEnvelope();
+            out[i] = oscillate() * envelope * gain;
+            ++elapsed;
+        }
+
+        return stage != Stage::Done;
+    }
+} // audio
+// blipcade
@@ -0,0 +1,112 @@
+// synth.h
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace blipcade::audio {
+    enum class Waveform : uint8_t {
+        Square,
+        Triangle,
+        Saw,
+        Noise,
+    };
+
+    // How a synth voice sounds; notes are played with one, so a cart's sound effects need no sample files
+    struct Instrument {
+        static constexpr uint32_t MAX_ARPEGGIO = 8;
+
+        Waveform waveform = Waveform::Square;
+        // Share of the period a square wave spends high
+        float duty = 0.5f;
+        // Envelope: times in seconds, sustain as a level
+        float attack = 0.005f;
+        float decay = 0.1f;
+        float sustain = 0.7f;
+        float release = 0.1f;
+        // Semitones per second the pitch drifts by while the note plays, e.g. -24 for a falling zap
+        float slide = 0.0f;
+        // Semitone offsets stepped through at arpeggioRate steps per second
+        std::array<float, MAX_ARPEGGIO> arpeggio{};
+        uint32_t arpeggioLength = 0;
+        float arpeggioRate = 30.0f;
+        float gain = 0.5f;
+    };
+
+    // Longest attack, decay or release an instrument keeps
+    constexpr float MAX_ENVELOPE_SECONDS = 30.0f;
+    constexpr float MAX_ARPEGGIO_RATE = 1000.0f;
+
+    // `instrument` with every field in the range the synth relies on: duty in [0.01, 0.99], sustain in [0, 1],
+    // envelope times in [0, MAX_ENVELOPE_SECONDS], arpeggioRate in [0, MAX_ARPEGGIO_RATE], gain at least 0. NaN
+    // fields take their default.
+    Instrument clampInstrument(const Instrument &instrument);
+
+    // "C4", "F#3" or "Bb5" as a MIDI note number, where C4 is 60
+    std::optional<float> parseNote(const std::string &name);
+
+    // Oscillator and envelope of one playing note.
+    // Square, saw and triangle are band-limited with polynomial corrections around their edges and corners, so high
+    // notes do not fold back as audible aliases. Pitch is recomputed once per CONTROL_FRAMES, keeping exp2 out of
+    // the per-sample loop.
+    class Synth {
+    public:
+        static constexpr uint32_t CONTROL_FRAMES = 32;
+
+        // A `holdFrames` of 0 holds the note until release(). The instrument must outlive the note.
+        void start(const Instrument &instrument, float note, uint32_t holdFrames, uint32_t sampleRate);
+
+        // Moves to the release stage from wherever the envelope is
+        void release();
+
+        // Writes `frameCount` mono samples with `pitch` as a rate multiplier. Returns false once the release has
+        // finished, zero-filling what follows.
+        bool render(float *out, uint32_t frameCount, float pitch);
+
+    private:
+        enum class Stage : uint8_t {
+            Attack,
+            Decay,
+            Sustain,
+            Release,
+            Done,
+        };
+
+        const Instrument *instrument = nullptr;
+        float sampleRate = 48000.0f;
+        float note = 60.0f;
+        uint32_t holdFrames = 0;
+        uint32_t elapsed = 0;
+
+        Stage stage = Stage::Done;
+        float level = 0.0f;
+        float attackStep = 0.0f;
+        float decayStep = 0.0f;
+        float releaseStep = 0.0f;
+
+        // Phase in periods, and its advance per sample
+        float phase = 0.0f;
+        float increment = 0.0f;
+        uint32_t controlCountdown = 0;
+
+        // Noise glides between random values, drawn NOISE_RATE times per period
+        uint32_t noiseState = 0x12345678u;
+        float noiseFrom = 0.0f;
+        float noiseTo = 0.0f;
+
+        void updatePitch(float pitch);
+
+        float advanceEnvelope();
+
+        float oscillate();
+
+        float nextNoise();
+    };
+} // audio
+// blipcade
+
+#endif // SYNTH_H
@@ -12,8 +12,30 @@
 #include <earcut.hpp>
 #include <fstream>
 #include <iostream>
+#include <raymath.h>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
 
 namespace blipcade::collision {
+    namespace {
+        // Vertices the shape reads by index; polygons check their own size
+        size_t requiredVertices(const ColliderType type) {
+            switch (type) {
+                case ColliderType::RECTANGLE:
+                case ColliderType::CIRCLE:
+                case ColliderType::LINE:
+                    return 2;
+                case ColliderType::POINT:
+                    return 1;
+                default:
+                    return 0;
+            }
+        }
+    }
+
     using Coord = double;
     using Point = std::array<Coord, 2>;
     using N = uint32_t;
@@ -31,7 +53,7 @@ namespace blipcade::collision {
         std::vector<std::vector<Point> > polygon;
 
         // Log how many vertices are in the polygon
-        std::cout << "PREPARE: VERTICES SIZE: " << cleanedVertices.size() << std::endl;
+        // std::cout << "PREPARE: VERTICES SIZE: " << cleanedVertices.size() << std::endl;
 
         // Create the outer ring
         std::vector<Point> outerRing;
@@ -47,6 +69,11 @@ namespace blipcade::collision {
     }
 
     Collider::Collider(ColliderType type, std::vector<Vector2> vertices): type(type), vertices(std::move(vertices)) {
+        if (this->vertices.size() < requiredVertices(type)) {
+            throw std::invalid_argument("Collider needs " + std::to_string(requiredVertices(type)) +
+                                        " vertices, got " + std::to_string(this->vertices.size()));
+        }
+
         if (type == ColliderType::CONVEX_POLYGON || type == ColliderType::CONCAVE_POLYGON) {
             // Remove duplicate last vertex if present
             if (!this->vertices.empty() &&
@@ -68,6 +95,56 @@ namespace blipcade::collision {
 
             // Reverse the vertices back to ensure CCW winding order
             std::reverse(this->vertices.begin(), this->vertices.end());
+
+            buildTriangles();
+        }
+
+        bounds = computeBounds();
+    }
+
+    void Collider::buildTriangles() {
+        if (vertices.size() < 3) {
+            return;
+        }
+
+        const auto indices = mapbox::earcut<N>(preparePolygon(vertices));
+
+        triangles.clear();
+        triangles.reserve(indices.size() / 3);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            triangles.emplace_back(vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]);
+        }
+
+        // Bucket triangles by the grid cells their bounding boxes touch
+        const auto polygonBounds = computeBounds();
+        const auto cellWidth = std::max(polygonBounds.width / TRIANGLE_GRID_SIZE, 1e-3f);
+        const auto cellHeight = std::max(polygonBounds.height / TRIANGLE_GRID_SIZE, 1e-3f);
+
+        const auto cellIndex = [&](const float value, const float origin, const float size) {
+            const auto index = static_cast<int32_t>((value - origin) / size);
+            return static_cast<uint32_t>(std::clamp<int32_t>(index, 0, TRIANGLE_GRID_SIZE - 1));
+        };
+
+        std::vector<std::vector<uint32_t> > cells(TRIANGLE_GRID_SIZE * TRIANGLE_GRID_SIZE);
+        for (uint32_t t = 0; t < triangles.size(); ++t) {
+            const auto &triangle = triangles[t];
+            const auto min = Vector2Min(Vector2Min(triangle.v1, triangle.v2), triangle.v3);
+            const auto max = Vector2Max(Vector2Max(triangle.v1, triangle.v2), triangle.v3);
+
+            for (auto y = cellIndex(min.y, polygonBounds.y, cellHeight);
+                 y <= cellIndex(max.y, polygonBounds.y, cellHeight); ++y) {
+                for (auto x = cellIndex(min.x, polygonBounds.x, cellWidth);
+                     x <= cellIndex(max.x, polygonBounds.x, cellWidth); ++x) {
+                    cells[y * TRIANGLE_GRID_SIZE + x].push_back(t);
+                }
+            }
+        }
+
+        triangleGridOffsets.assign(1, 0);
+        triangleGridIndices.clear();
+        for (const auto &cell: cells) {
+            triangleGridIndices.insert(triangleGridIndices.end(), cell.begin(), cell.end());
+            triangleGridOffsets.push_back(static_cast<uint32_t>(triangleGridIndices.size()));
         }
     }
 
@@ -119,7 +196,7 @@ namespace blipcade::collision {
                 return CheckCollisionPointCircle(point, Vector2{vertices[0].x, vertices[0].y}, vertices[1].x);
             case ColliderType::CONVEX_POLYGON:
             case ColliderType::CONCAVE_POLYGON:
-                return CheckCollisionPointPoly(point, vertices.data(), vertices.size());
+                return isInsideBounds(point) && checkCollisionPointPolygon(point);
             case ColliderType::POINT:
                 return CheckCollisionPointRec(point, Rectangle{vertices[0].x, vertices[0].y, 1, 1});
             case ColliderType::LINE:
@@ -133,5 +210,216 @@ namespace blipcade::collision {
                 return false;
         }
     }
+
+    void Collider::checkCollisionPoints(const Vector2 *points, const size_t count, uint8_t *results) const {
+        if (type != ColliderType::CONVEX_POLYGON && type != ColliderType::CONCAVE_POLYGON) {
+            for (size_t i = 0; i < count; ++i) {
+                results[i] = checkCollisionPoint(points[i]) ? 1 : 0;
+            }
+
+            return;
+        }
+
+        // Bounds rejection over the whole batch first; only the survivors pay for the exact polygon test
+        const auto minX = bounds.x;
+        const auto minY = bounds.y;
+        const auto maxX = bounds.x + bounds.width;
+        const auto maxY = bounds.y + bounds.height;
+
+        size_t i = 0;
+
+#if defined(__SSE2__)
+        // Two points per register as x, y, x, y; a point is inside when both of its lanes pass both comparisons
+        const auto min = _mm_setr_ps(minX, minY, minX, minY);
+        const auto max = _mm_setr_ps(maxX, maxY, maxX, maxY);
+
+        for (; i + 2 <= count; i += 2) {
+            const auto xy = _mm_loadu_ps(&points[i].x);
+            const auto mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(xy, min), _mm_cmple_ps(xy, max)));
+
+            results[i] = (mask & 0x3) == 0x3;
+            results[i + 1] = (mask & 0xc) == 0xc;
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const auto &point = points[i];
+            results[i] = (point.x >= minX) & (point.x <= maxX) & (point.y >= minY) & (point.y <= maxY);
+        }
+
+        for (i = 0; i < count; ++i) {
+            if (results[i]) {
+                results[i] = checkCollisionPointPolygon(points[i]) ? 1 : 0;
+            }
+        }
+    }
+
+    bool Collider::checkCollisionPointPolygon(const Vector2 &point) const {
+        // Degenerate polygons earcut could not split fall back to the crossing test
+        if (type == ColliderType::CONVEX_POLYGON || triangles.empty()) {
+            return CheckCollisionPointPoly(point, vertices.data(), vertices.size());
+        }
+
+        return checkCollisionPointTriangles(point);
+    }
+
+    bool Collider::isInsideBounds(const Vector2 &point) const {
+        return point.x >= bounds.x && point.x <= bounds.x + bounds.width &&
+               point.y >= bounds.y && point.y <= bounds.y + bounds.height;
+    }
+
+    bool Collider::checkCollisionPointTriangles(const Vector2 &point) const {
+        const auto cellWidth = std::max(bounds.width / TRIANGLE_GRID_SIZE, 1e-3f);
+        const auto cellHeight = std::max(bounds.height / TRIANGLE_GRID_SIZE, 1e-3f);
+
+        const auto x = std::clamp<int32_t>(static_cast<int32_t>((point.x - bounds.x) / cellWidth), 0,
+                                           TRIANGLE_GRID_SIZE - 1);
+        const auto y = std::clamp<int32_t>(static_cast<int32_t>((point.y - bounds.y) / cellHeight), 0,
+                                           TRIANGLE_GRID_SIZE - 1);
+        const auto cell = y * TRIANGLE_GRID_SIZE + x;
+
+        for (auto i = triangleGridOffsets[cell]; i < triangleGridOffsets[cell + 1]; ++i) {
+            const auto &triangle = triangles[triangleGridIndices[i]];
+
+            if (CheckCollisionPointTriangle(point, triangle.v1, triangle.v2, triangle.v3)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    namespace {
+        bool segmentIntersectsPolygon(const Vector2 &start, const Vector2 &end, const std::vector<Vector2> &polygon) {
+            for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+                if (CheckCollisionLines(start, end, polygon[j], polygon[i], nullptr)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        float distanceToSegmentSqr(const Vector2 &point, const Vector2 &start, const Vector2 &end) {
+            const auto segment = Vector2Subtract(end, start);
+            const auto lengthSqr = Vector2LengthSqr(segment);
+            const auto t = lengthSqr > 0.0f
+                               ? Clamp(Vector2DotProduct(Vector2Subtract(point, start), segment) / lengthSqr, 0.0f, 1.0f)
+                               : 0.0f;
+
+            return Vector2DistanceSqr(point, Vector2Add(start, Vector2Scale(segment, t)));
+        }
+
+        std::vector<Vector2> rectangleCorners(const Rectangle &rec) {
+            return {
+                {rec.x, rec.y},
+                {rec.x + rec.width, rec.y},
+                {rec.x + rec.width, rec.y + rec.height},
+                {rec.x, rec.y + rec.height}
+            };
+        }
+    }
+
+    bool Collider::checkCollisionRec(const Rectangle &rec) const {
+        switch (type) {
+            case ColliderType::RECTANGLE:
+                return CheckCollisionRecs(rec, Rectangle{vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y});
+            case ColliderType::CIRCLE:
+                return CheckCollisionCircleRec(Vector2{vertices[0].x, vertices[0].y}, vertices[1].x, rec);
+            case ColliderType::CONVEX_POLYGON:
+            case ColliderType::CONCAVE_POLYGON: {
+                if (vertices.empty() || !CheckCollisionRecs(rec, bounds)) {
+                    return false;
+                }
+
+                // Either shape contains a vertex of the other, or their edges cross
+                if (CheckCollisionPointRec(vertices[0], rec)) {
+                    return true;
+                }
+
+                const auto corners = rectangleCorners(rec);
+                if (CheckCollisionPointPoly(corners[0], vertices.data(), vertices.size())) {
+                    return true;
+                }
+
+                for (size_t i = 0, j = corners.size() - 1; i < corners.size(); j = i++) {
+                    if (segmentIntersectsPolygon(corners[j], corners[i], vertices)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+            case ColliderType::POINT:
+                return CheckCollisionRecs(rec, Rectangle{vertices[0].x, vertices[0].y, 1, 1});
+            case ColliderType::LINE:
+                return CheckCollisionPointRec(vertices[0], rec) ||
+                       segmentIntersectsPolygon(vertices[0], vertices[1], rectangleCorners(rec));
+            case ColliderType::RAY:
+            default:
+                return false;
+        }
+    }
+
+    bool Collider::checkCollisionSegment(const Vector2 &start, const Vector2 &end) const {
+        switch (type) {
+            case ColliderType::RECTANGLE: {
+                const Rectangle rec{vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y};
+                return CheckCollisionPointRec(start, rec) ||
+                       segmentIntersectsPolygon(start, end, rectangleCorners(rec));
+            }
+            case ColliderType::CIRCLE:
+                return distanceToSegmentSqr(vertices[0], start, end) <= vertices[1].x * vertices[1].x;
+            case ColliderType::CONVEX_POLYGON:
+            case ColliderType::CONCAVE_POLYGON:
+                return !vertices.empty() &&
+                       (CheckCollisionPointPoly(start, vertices.data(), vertices.size()) ||
+                        segmentIntersectsPolygon(start, end, vertices));
+            case ColliderType::POINT:
+                return distanceToSegmentSqr(Vector2{vertices[0].x + 0.5f, vertices[0].y + 0.5f}, start, end) <= 0.5f;
+            case ColliderType::LINE:
+                return CheckCollisionLines(start, end, vertices[0], vertices[1], nullptr);
+            case ColliderType::RAY:
+            default:
+                return false;
+        }
+    }
+
+    Rectangle Collider::getBounds() const {
+        return bounds;
+    }
+
+    Rectangle Collider::computeBounds() const {
+        switch (type) {
+            case ColliderType::RECTANGLE:
+                return Rectangle{vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y};
+            case ColliderType::CIRCLE:
+                return Rectangle{
+                    vertices[0].x - vertices[1].x, vertices[0].y - vertices[1].x,
+                    vertices[1].x * 2.0f, vertices[1].x * 2.0f
+                };
+            case ColliderType::POINT:
+                return Rectangle{vertices[0].x, vertices[0].y, 1, 1};
+            case ColliderType::CONVEX_POLYGON:
+            case ColliderType::CONCAVE_POLYGON:
+            case ColliderType::LINE: {
+                if (vertices.empty()) {
+                    return Rectangle{0, 0, 0, 0};
+                }
+
+                auto min = vertices[0];
+                auto max = vertices[0];
+                for (const auto &vertex: vertices) {
+                    min = Vector2Min(min, vertex);
+                    max = Vector2Max(max, vertex);
+                }
+
+                return Rectangle{min.x, min.y, max.x - min.x, max.y - min.y};
+            }
+            case ColliderType::RAY:
+            default:
+                return Rectangle{0, 0, 0, 0};
+        }
+    }
 } // collision
 // blipcade
@@ -13,6 +13,7 @@ namespace blipcade::collision {
 
     class Collider {
     public:
+        // Throws std::invalid_argument when the shape has fewer vertices than it reads
         Collider(ColliderType type, std::vector<Vector2> vertices);
 
         ~Collider() = default;
@@ -26,8 +27,39 @@ namespace blipcade::collision {
 
         bool checkCollisionPoint(const Vector2& point) const;
 
+        // Tests many points against this collider. `results[i]` is set to 1 when `points[i]` collides.
+        void checkCollisionPoints(const Vector2 *points, size_t count, uint8_t *results) const;
+
+        bool checkCollisionRec(const Rectangle &rec) const;
+
+        bool checkCollisionSegment(const Vector2 &start, const Vector2 &end) const;
+
+        // Axis-aligned bounds in collider space, cached at construction; `vertices` must not be edited afterwards.
+        // RAY colliders are unbounded and return an empty rectangle.
+        [[nodiscard]] Rectangle getBounds() const;
+
     private:
+        static constexpr uint32_t TRIANGLE_GRID_SIZE = 8;
+
+        Rectangle bounds{};
+
+        // Polygon triangles bucketed into a TRIANGLE_GRID_SIZE^2 grid over `bounds`.
+        // Cell i owns triangleGridIndices[triangleGridOffsets[i] .. triangleGridOffsets[i + 1]).
+        std::vector<uint32_t> triangleGridOffsets;
+        std::vector<uint32_t> triangleGridIndices;
+
         float computeSignedArea() const;
+
+        [[nodiscard]] Rectangle computeBounds() const;
+
+        void buildTriangles();
+
+        [[nodiscard]] bool isInsideBounds(const Vector2 &point) const;
+
+        // Exact polygon test; the caller has already checked the bounds
+        [[nodiscard]] bool checkCollisionPointPolygon(const Vector2 &point) const;
+
+        [[nodiscard]] bool checkCollisionPointTriangles(const Vector2 &point) const;
     };
 } // collision
 // blipcade
@@ -0,0 +1,317 @@
+// collisionworld.cpp
+
+#include "collisionworld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <raymath.h>
+
+namespace blipcade::collision {
+    namespace {
+        bool isFinite(const Vector2 &point) {
+            return std::isfinite(point.x) && std::isfinite(point.y);
+        }
+
+        // Liang-Barsky: the part of the segment inside `rec` as [from, to]. False when none is. Runs in double, since a
+        // segment far longer than the world would otherwise land its clipped ends whole cells off.
+        bool clipSegment(const Vector2 &start, const Vector2 &end, const Rectangle &rec, Vector2 &from, Vector2 &to) {
+            const double dx = static_cast<double>(end.x) - start.x;
+            const double dy = static_cast<double>(end.y) - start.y;
+            const double p[4] = {-dx, dx, -dy, dy};
+            const double q[4] = {
+                static_cast<double>(start.x) - rec.x, static_cast<double>(rec.x) + rec.width - start.x,
+                static_cast<double>(start.y) - rec.y, static_cast<double>(rec.y) + rec.height - start.y
+            };
+
+            double t0 = 0.0;
+            double t1 = 1.0;
+
+            for (int i = 0; i < 4; ++i) {
+                if (p[i] == 0.0) {
+                    if (q[i] < 0.0) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                const auto t = q[i] / p[i];
+                if (p[i] < 0.0) {
+                    t0 = std::max(t0, t);
+                } else {
+                    t1 = std::min(t1, t);
+                }
+            }
+
+            if (t0 > t1) {
+                return false;
+            }
+
+            from = {static_cast<float>(start.x + dx * t0), static_cast<float>(start.y + dy * t0)};
+            to = {static_cast<float>(start.x + dx * t1), static_cast<float>(start.y + dy * t1)};
+            return true;
+        }
+    }
+
+    CollisionWorld::CollisionWorld(const float cellSize) : cellSize(cellSize > 0.0f ? cellSize : 64.0f) {
+    }
+
+    template<typename Visitor>
+    void CollisionWorld::forEachInCell(const int32_t x, const int32_t y, Visitor &&visit) const {
+        const auto it = cells.find(cellKey(x, y));
+        if (it == cells.end()) {
+            return;
+        }
+
+        for (const auto id: it->second) {
+            const auto &body = bodies.at(id);
+
+            if (body.queryStamp == queryStamp) {
+                continue;
+            }
+
+            body.queryStamp = queryStamp;
+            visit(id, body);
+        }
+    }
+
+    BodyId CollisionWorld::addBody(const Collider &collider, const Vector2 position) {
+        const auto id = nextId++;
+
+        auto [it, _] = bodies.emplace(id, Body{collider, position, {}, {}, {}});
+        insertIntoCells(id, it->second);
+
+        return id;
+    }
+
+    void CollisionWorld::removeBody(const BodyId id) {
+        const auto it = bodies.find(id);
+        if (it == bodies.end()) {
+            return;
+        }
+
+        removeFromCells(id, it->second);
+        bodies.erase(it);
+    }
+
+    void CollisionWorld::setBodyPosition(const BodyId id, const Vector2 position) {
+        const auto it = bodies.find(id);
+        if (it == bodies.end()) {
+            return;
+        }
+
+        auto &body = it->second;
+        if (Vector2Equals(body.position, position)) {
+            return;
+        }
+
+        removeFromCells(id, body);
+        body.position = position;
+        insertIntoCells(id, body);
+    }
+
+    bool CollisionWorld::hasBody(const BodyId id) const {
+        return bodies.contains(id);
+    }
+
+    void CollisionWorld::clear() {
+        bodies.clear();
+        cells.clear();
+        occupiedMin = {INT32_MAX, INT32_MAX};
+        occupiedMax = {INT32_MIN, INT32_MIN};
+    }
+
+    std::size_t CollisionWorld::getBodyCount() const {
+        return bodies.size();
+    }
+
+    std::vector<BodyId> CollisionWorld::queryPoint(const Vector2 &point) const {
+        std::vector<BodyId> hits;
+        if (!isFinite(point)) {
+            return hits;
+        }
+
+        const auto cell = cellOf(point);
+
+        queryStamp++;
+        forEachInCell(cell.x, cell.y, [&](const BodyId id, const Body &body) {
+            if (CheckCollisionPointRec(point, body.bounds) &&
+                body.collider.checkCollisionPoint(Vector2Subtract(point, body.position))) {
+                hits.push_back(id);
+            }
+        });
+
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    std::vector<BodyId> CollisionWorld::queryRec(const Rectangle &rec) const {
+        std::vector<BodyId> hits;
+        if (!isFinite({rec.x, rec.y}) || !isFinite({rec.width, rec.height})) {
+            return hits;
+        }
+
+        // However large the rect, nothing outside the occupied cells can hit
+        auto cellMin = cellOf(Vector2{rec.x, rec.y});
+        auto cellMax = cellOf(Vector2{rec.x + rec.width, rec.y + rec.height});
+        cellMin = {std::max(cellMin.x, occupiedMin.x), std::max(cellMin.y, occupiedMin.y)};
+        cellMax = {std::min(cellMax.x, occupiedMax.x), std::min(cellMax.y, occupiedMax.y)};
+
+        queryStamp++;
+        for (auto y = cellMin.y; y <= cellMax.y; ++y) {
+            for (auto x = cellMin.x; x <= cellMax.x; ++x) {
+                forEachInCell(x, y, [&](const BodyId id, const Body &body) {
+                    const Rectangle local{rec.x - body.position.x, rec.y - body.position.y, rec.width, rec.height};
+
+                    if (CheckCollisionRecs(rec, body.bounds) && body.collider.checkCollisionRec(local)) {
+                        hits.push_back(id);
+                    }
+                });
+            }
+        }
+
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    std::vector<BodyId> CollisionWorld::querySegment(const Vector2 &start, const Vector2 &end) const {
+        std::vector<BodyId> hits;
+        if (!isFinite(start) || !isFinite(end) || occupiedMin.x > occupiedMax.x) {
+            return hits;
+        }
+
+        const auto visit = [&](const BodyId id, const Body &body) {
+            if (body.collider.checkCollisionSegment(Vector2Subtract(start, body.position),
+                                                    Vector2Subtract(end, body.position))) {
+                hits.push_back(id);
+            }
+        };
+
+        queryStamp++;
+
+        // Past the addressable grid even the clipped ends lose whole cells of precision, so scan the occupied cells
+        // under the segment's bounds instead of walking it
+        const auto reach = MAX_CELL * cellSize;
+        if (std::max({std::fabs(start.x), std::fabs(start.y), std::fabs(end.x), std::fabs(end.y)}) > reach) {
+            const auto startCell = cellOf(start);
+            const auto endCell = cellOf(end);
+            const CellCoord cellMin{
+                std::max(std::min(startCell.x, endCell.x), occupiedMin.x),
+                std::max(std::min(startCell.y, endCell.y), occupiedMin.y)
+            };
+            const CellCoord cellMax{
+                std::min(std::max(startCell.x, endCell.x), occupiedMax.x),
+                std::min(std::max(startCell.y, endCell.y), occupiedMax.y)
+            };
+
+            for (auto y = cellMin.y; y <= cellMax.y; ++y) {
+                for (auto x = cellMin.x; x <= cellMax.x; ++x) {
+                    forEachInCell(x, y, visit);
+                }
+            }
+
+            std::sort(hits.begin(), hits.end());
+            return hits;
+        }
+
+        // Only the part of the segment over occupied cells is walked, so a huge segment costs no more than the world
+        const Rectangle occupied = {
+            static_cast<float>(occupiedMin.x) * cellSize, static_cast<float>(occupiedMin.y) * cellSize,
+            static_cast<float>(occupiedMax.x - occupiedMin.x + 1) * cellSize,
+            static_cast<float>(occupiedMax.y - occupiedMin.y + 1) * cellSize
+        };
+
+        Vector2 from;
+        Vector2 to;
+        if (!clipSegment(start, end, occupied, from, to)) {
+            return hits;
+        }
+
+        // Walk the cells crossed by the segment (Amanatides & Woo)
+        const auto direction = Vector2Subtract(to, from);
+        auto cell = cellOf(from);
+        const auto last = cellOf(to);
+
+        const int32_t stepX = direction.x > 0 ? 1 : (direction.x < 0 ? -1 : 0);
+        const int32_t stepY = direction.y > 0 ? 1 : (direction.y < 0 ? -1 : 0);
+
+        const auto boundaryT = [this](const float origin, const float delta, const int32_t cellIndex, const int32_t step) {
+            if (step == 0) {
+                return INFINITY;
+            }
+
+            const auto boundary = static_cast<float>(cellIndex + (step > 0 ? 1 : 0)) * cellSize;
+            return (boundary - origin) / delta;
+        };
+
+        auto tMaxX = boundaryT(from.x, direction.x, cell.x, stepX);
+        auto tMaxY = boundaryT(from.y, direction.y, cell.y, stepY);
+        const auto tDeltaX = stepX != 0 ? cellSize / std::fabs(direction.x) : INFINITY;
+        const auto tDeltaY = stepY != 0 ? cellSize / std::fabs(direction.y) : INFINITY;
+
+        const auto maxSteps = std::abs(last.x - cell.x) + std::abs(last.y - cell.y);
+
+        forEachInCell(cell.x, cell.y, visit);
+        for (int32_t i = 0; i < maxSteps; ++i) {
+            if (tMaxX < tMaxY) {
+                cell.x += stepX;
+                tMaxX += tDeltaX;
+            } else {
+                cell.y += stepY;
+                tMaxY += tDeltaY;
+            }
+
+            forEachInCell(cell.x, cell.y, visit);
+        }
+
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    CollisionWorld::CellCoord CollisionWorld::cellOf(const Vector2 &point) const {
+        const auto index = [this](const float coordinate) {
+            const auto cell = std::floor(coordinate / cellSize);
+            return std::isnan(cell) ? 0 : static_cast<int32_t>(std::clamp(cell, -MAX_CELL, MAX_CELL));
+        };
+
+        return CellCoord{index(point.x), index(point.y)};
+    }
+
+    uint64_t CollisionWorld::cellKey(const int32_t x, const int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    void CollisionWorld::insertIntoCells(const BodyId id, Body &body) {
+        const auto local = body.collider.getBounds();
+        body.bounds = Rectangle{local.x + body.position.x, local.y + body.position.y, local.width, local.height};
+        body.cellMin = cellOf(Vector2{body.bounds.x, body.bounds.y});
+        body.cellMax = cellOf(Vector2{body.bounds.x + body.bounds.width, body.bounds.y + body.bounds.height});
+
+        occupiedMin = {std::min(occupiedMin.x, body.cellMin.x), std::min(occupiedMin.y, body.cellMin.y)};
+        occupiedMax = {std::max(occupiedMax.x, body.cellMax.x), std::max(occupiedMax.y, body.cellMax.y)};
+
+        for (auto y = body.cellMin.y; y <= body.cellMax.y; ++y) {
+            for (auto x = body.cellMin.x; x <= body.cellMax.x; ++x) {
+                cells[cellKey(x, y)].push_back(id);
+            }
+        }
+    }
+
+    void CollisionWorld::removeFromCells(const BodyId id, const Body &body) {
+        for (auto y = body.cellMin.y; y <= body.cellMax.y; ++y) {
+            for (auto x = body.cellMin.x; x <= body.cellMax.x; ++x) {
+                const auto it = cells.find(cellKey(x, y));
+                if (it == cells.end()) {
+                    continue;
+                }
+
+                auto &ids = it->second;
+                ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+
+                if (ids.empty()) {
+                    cells.erase(it);
+                }
+            }
+        }
+    }
+} // collision
+// blipcade
@@ -0,0 +1,89 @@
+// collisionworld.h
+
+#ifndef COLLISIONWORLD_H
+#define COLLISIONWORLD_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <raylib.h>
+
+#include "collider.h"
+
+namespace blipcade::collision {
+    using BodyId = uint32_t;
+
+    // Broadphase over placed colliders.
+    // Each body is a collider plus a world position; bodies are bucketed into a uniform spatial hash by their
+    // world bounds, so point/rect/segment queries only run the exact test against colliders in touched cells.
+    class CollisionWorld {
+    public:
+        explicit CollisionWorld(float cellSize = 64.0f);
+
+        BodyId addBody(const Collider &collider, Vector2 position = {0, 0});
+
+        void removeBody(BodyId id);
+
+        void setBodyPosition(BodyId id, Vector2 position);
+
+        [[nodiscard]] bool hasBody(BodyId id) const;
+
+        void clear();
+
+        [[nodiscard]] std::size_t getBodyCount() const;
+
+        // All queries return hit body ids in ascending order. Non-finite input hits nothing.
+        [[nodiscard]] std::vector<BodyId> queryPoint(const Vector2 &point) const;
+
+        [[nodiscard]] std::vector<BodyId> queryRec(const Rectangle &rec) const;
+
+        [[nodiscard]] std::vector<BodyId> querySegment(const Vector2 &start, const Vector2 &end) const;
+
+    private:
+        struct CellCoord {
+            int32_t x;
+            int32_t y;
+        };
+
+        struct Body {
+            Collider collider;
+            Vector2 position;
+            Rectangle bounds; // World space
+            CellCoord cellMin;
+            CellCoord cellMax;
+            mutable uint32_t queryStamp = 0;
+        };
+
+        // Cell indices are clamped to +-MAX_CELL, which keeps the cast from huge coordinates defined
+        static constexpr float MAX_CELL = 1 << 20;
+
+        float cellSize;
+        BodyId nextId = 1;
+
+        // Cells any body has been inserted into since the last clear; queries never walk past them. Empty while
+        // min > max.
+        CellCoord occupiedMin{INT32_MAX, INT32_MAX};
+        CellCoord occupiedMax{INT32_MIN, INT32_MIN};
+
+        std::unordered_map<BodyId, Body> bodies;
+        std::unordered_map<uint64_t, std::vector<BodyId> > cells;
+
+        mutable uint32_t queryStamp = 0;
+
+        // NaN coordinates land in cell 0
+        [[nodiscard]] CellCoord cellOf(const Vector2 &point) const;
+
+        static uint64_t cellKey(int32_t x, int32_t y);
+
+        void insertIntoCells(BodyId id, Body &body);
+
+        void removeFromCells(BodyId id, const Body &body);
+
+        // Calls `visit` once per body registered in the cell, skipping bodies already seen by this query
+        template<typename Visitor>
+        void forEachInCell(int32_t x, int32_t y, Visitor &&visit) const;
+    };
+} // collision
+// blipcade
+
+#endif // COLLISIONWORLD_H
@@ -0,0 +1,272 @@
+// navhierarchy.cpp
+
+#include "navhierarchy.h"
+
+#include "navmesh.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <raymath.h>
+#include <unordered_set>
+
+namespace blipcade::collision {
+    NavMeshHierarchy::NavMeshHierarchy(const NavMesh &navMesh, const std::size_t maxClusterSize) {
+        buildClusters(navMesh, std::max<std::size_t>(maxClusterSize, 1));
+        buildPortalGraph();
+    }
+
+    void NavMeshHierarchy::buildClusters(const NavMesh &navMesh, const std::size_t maxClusterSize) {
+        // Breadth-first flood fill keeps clusters compact and connected
+        for (const auto &seed: navMesh.regions) {
+            if (clusterOf.contains(seed.get())) {
+                continue;
+            }
+
+            const auto clusterIndex = static_cast<uint32_t>(clusters.size());
+            Cluster cluster;
+
+            std::queue<ConvexPolygon *> frontier;
+            frontier.push(seed.get());
+            clusterOf[seed.get()] = clusterIndex;
+
+            while (!frontier.empty() && cluster.regions.size() < maxClusterSize) {
+                auto region = frontier.front();
+                frontier.pop();
+
+                cluster.regions.push_back(region);
+
+                for (auto neighbor: region->neighbors) {
+                    if (!clusterOf.contains(neighbor)) {
+                        clusterOf[neighbor] = clusterIndex;
+                        frontier.push(neighbor);
+                    }
+                }
+            }
+
+            // Regions queued past the size limit go back to the pool for the next cluster
+            while (!frontier.empty()) {
+                clusterOf.erase(frontier.front());
+                frontier.pop();
+            }
+
+            clusters.push_back(std::move(cluster));
+        }
+
+        for (auto &cluster: clusters) {
+            for (auto region: cluster.regions) {
+                const auto index = clusterOf.at(region);
+                const auto isPortal = std::any_of(region->neighbors.begin(), region->neighbors.end(),
+                                                  [this, index](const ConvexPolygon *neighbor) {
+                                                      return clusterOf.at(neighbor) != index;
+                                                  });
+
+                if (isPortal) {
+                    cluster.portals.push_back(region);
+                }
+            }
+        }
+    }
+
+    void NavMeshHierarchy::buildPortalGraph() {
+        for (const auto &cluster: clusters) {
+            for (auto portal: cluster.portals) {
+                auto &edges = portalGraph[portal];
+
+                // Intra-cluster edges to every other reachable portal
+                const auto search = searchCluster(portal);
+                for (auto other: cluster.portals) {
+                    if (other == portal || !search.distance.contains(other)) {
+                        continue;
+                    }
+
+                    edges.push_back(PortalEdge{other, search.distance.at(other), corridorTo(search, other)});
+                }
+
+                // Inter-cluster edges across the border
+                std::unordered_set<const ConvexPolygon *> linked;
+                for (auto neighbor: portal->neighbors) {
+                    if (clusterOf.at(neighbor) == clusterOf.at(portal) || !linked.insert(neighbor).second) {
+                        continue;
+                    }
+
+                    edges.push_back(PortalEdge{
+                        neighbor, Vector2Distance(portal->centroid, neighbor->centroid), {neighbor}
+                    });
+                }
+            }
+        }
+    }
+
+    NavMeshHierarchy::LocalSearch NavMeshHierarchy::searchCluster(ConvexPolygon *source) const {
+        using QueueEntry = std::pair<float, ConvexPolygon *>;
+
+        LocalSearch search;
+        const auto index = clusterOf.at(source);
+
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<> > openList;
+        search.distance[source] = 0.0f;
+        openList.emplace(0.0f, source);
+
+        while (!openList.empty()) {
+            const auto [distance, region] = openList.top();
+            openList.pop();
+
+            if (distance > search.distance.at(region)) {
+                continue; // Stale entry
+            }
+
+            for (auto neighbor: region->neighbors) {
+                if (clusterOf.at(neighbor) != index) {
+                    continue;
+                }
+
+                const auto candidate = distance + Vector2Distance(region->centroid, neighbor->centroid);
+                const auto it = search.distance.find(neighbor);
+
+                if (it == search.distance.end() || candidate < it->second) {
+                    search.distance[neighbor] = candidate;
+                    search.parent[neighbor] = region;
+                    openList.emplace(candidate, neighbor);
+                }
+            }
+        }
+
+        return search;
+    }
+
+    std::vector<ConvexPolygon *> NavMeshHierarchy::corridorTo(const LocalSearch &search, ConvexPolygon *target) {
+        std::vector<ConvexPolygon *> corridor;
+
+        for (auto it = search.parent.find(target); it != search.parent.end(); it = search.parent.find(it->second)) {
+            corridor.push_back(it->first);
+        }
+
+        std::reverse(corridor.begin(), corridor.end());
+        return corridor;
+    }
+
+    std::optional<std::vector<ConvexPolygon *> > NavMeshHierarchy::findCorridor(ConvexPolygon *start,
+                                                                                ConvexPolygon *end) const {
+        const auto startCluster = clusterOf.find(start);
+        const auto endCluster = clusterOf.find(end);
+
+        if (startCluster == clusterOf.end() || endCluster == clusterOf.end() ||
+            startCluster->second == endCluster->second) {
+            return std::nullopt;
+        }
+
+        const auto startSearch = searchCluster(start);
+        const auto endSearch = searchCluster(end);
+
+        // A* over portals. nullptr stands for the goal, reached from any portal of the end cluster.
+        struct Visit {
+            ConvexPolygon *from;
+            const PortalEdge *edge; // nullptr for the leg out of the start region
+        };
+
+        using QueueEntry = std::pair<float, ConvexPolygon *>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<> > openList;
+        std::unordered_map<ConvexPolygon *, float> gCost;
+        std::unordered_map<ConvexPolygon *, Visit> cameFrom;
+        std::unordered_set<ConvexPolygon *> closed;
+
+        const auto relax = [&](ConvexPolygon *node, const float cost, const Visit visit) {
+            const auto it = gCost.find(node);
+            if (it != gCost.end() && it->second <= cost) {
+                return;
+            }
+
+            gCost[node] = cost;
+            cameFrom[node] = visit;
+
+            const auto h = node ? Vector2Distance(node->centroid, end->centroid) : 0.0f;
+            openList.emplace(cost + h, node);
+        };
+
+        for (auto portal: clusters[startCluster->second].portals) {
+            if (const auto it = startSearch.distance.find(portal); it != startSearch.distance.end()) {
+                relax(portal, it->second, Visit{start, nullptr});
+            }
+        }
+
+        bool found = false;
+
+        while (!openList.empty()) {
+            const auto node = openList.top().second;
+            openList.pop();
+
+            if (!closed.insert(node).second) {
+                continue;
+            }
+
+            if (node == nullptr) {
+                found = true;
+                break;
+            }
+
+            const auto g = gCost.at(node);
+
+            if (clusterOf.at(node) == endCluster->second) {
+                if (const auto it = endSearch.distance.find(node); it != endSearch.distance.end()) {
+                    relax(nullptr, g + it->second, Visit{node, nullptr});
+                }
+            }
+
+            for (const auto &edge: portalGraph.at(node)) {
+                if (!closed.contains(edge.to)) {
+                    relax(edge.to, g + edge.cost, Visit{node, &edge});
+                }
+            }
+        }
+
+        if (!found) {
+            return std::vector<ConvexPolygon *>{};
+        }
+
+        // Walk back from the goal, collecting corridor pieces in reverse
+        const auto lastPortal = cameFrom.at(nullptr).from;
+
+        std::vector<ConvexPolygon *> corridor;
+
+        // Leg into the end region: the end search parents point towards `end`
+        for (auto region = lastPortal; region != end;) {
+            region = endSearch.parent.at(region);
+            corridor.push_back(region);
+        }
+        std::reverse(corridor.begin(), corridor.end());
+
+        auto node = lastPortal;
+        while (true) {
+            const auto &visit = cameFrom.at(node);
+
+            if (visit.edge == nullptr) {
+                const auto leg = corridorTo(startSearch, node);
+                corridor.insert(corridor.end(), leg.rbegin(), leg.rend());
+                break;
+            }
+
+            corridor.insert(corridor.end(), visit.edge->corridor.rbegin(), visit.edge->corridor.rend());
+            node = visit.from;
+        }
+
+        corridor.push_back(start);
+        std::reverse(corridor.begin(), corridor.end());
+
+        return corridor;
+    }
+
+    int32_t NavMeshHierarchy::getClusterOf(const ConvexPolygon *region) const {
+        const auto it = clusterOf.find(region);
+        return it != clusterOf.end() ? static_cast<int32_t>(it->second) : -1;
+    }
+
+    std::size_t NavMeshHierarchy::getClusterCount() const {
+        return clusters.size();
+    }
+
+    std::size_t NavMeshHierarchy::getPortalCount() const {
+        return portalGraph.size();
+    }
+} // collision
+// blipcade
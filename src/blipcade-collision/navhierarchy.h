@@ -0,0 +1,69 @@
+// navhierarchy.h
+
+#ifndef NAVHIERARCHY_H
+#define NAVHIERARCHY_H
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace blipcade::collision {
+    class ConvexPolygon;
+    class NavMesh;
+
+    // Abstract graph over a NavMesh for long-distance queries.
+    // Regions are grouped into clusters of up to `maxClusterSize` connected regions. Regions touching another
+    // cluster are portals; portal-to-portal costs inside a cluster and across cluster borders are precomputed,
+    // so a query only searches the portal graph and then expands the stored corridors.
+    class NavMeshHierarchy {
+    public:
+        explicit NavMeshHierarchy(const NavMesh &navMesh, std::size_t maxClusterSize = 16);
+
+        // Region corridor from start to end (both inclusive), walking centroid to centroid.
+        // Returns std::nullopt when both regions share a cluster, the flat search is cheaper there.
+        // Returns an empty corridor when end is unreachable.
+        [[nodiscard]] std::optional<std::vector<ConvexPolygon *> > findCorridor(ConvexPolygon *start,
+                                                                               ConvexPolygon *end) const;
+
+        [[nodiscard]] int32_t getClusterOf(const ConvexPolygon *region) const;
+
+        [[nodiscard]] std::size_t getClusterCount() const;
+
+        [[nodiscard]] std::size_t getPortalCount() const;
+
+    private:
+        struct Cluster {
+            std::vector<ConvexPolygon *> regions;
+            std::vector<ConvexPolygon *> portals;
+        };
+
+        struct PortalEdge {
+            ConvexPolygon *to;
+            float cost;
+            std::vector<ConvexPolygon *> corridor; // Regions after the source portal, `to` included
+        };
+
+        // Dijkstra over centroids, restricted to the cluster of the source region
+        struct LocalSearch {
+            std::unordered_map<ConvexPolygon *, float> distance;
+            std::unordered_map<ConvexPolygon *, ConvexPolygon *> parent;
+        };
+
+        std::vector<Cluster> clusters;
+        std::unordered_map<const ConvexPolygon *, uint32_t> clusterOf;
+        std::unordered_map<const ConvexPolygon *, std::vector<PortalEdge> > portalGraph;
+
+        void buildClusters(const NavMesh &navMesh, std::size_t maxClusterSize);
+
+        void buildPortalGraph();
+
+        [[nodiscard]] LocalSearch searchCluster(ConvexPolygon *source) const;
+
+        // Regions from the search source (excluded) to target (included)
+        [[nodiscard]] static std::vector<ConvexPolygon *> corridorTo(const LocalSearch &search, ConvexPolygon *target);
+    };
+} // collision
+// blipcade
+
+#endif // NAVHIERARCHY_H
@@ -10,6 +10,8 @@
 #include <nlohmann/json.hpp>
 
 namespace blipcade::collision {
+    constexpr std::size_t HIERARCHY_MIN_REGIONS = 64;
+
     // Forward declaratio
 
     // Structure to represent a convex polygon region
@@ -80,12 +82,17 @@ namespace blipcade::collision {
     // Function to add a convex region
     void NavMesh::addRegion(std::vector<Vector2> verts) {
         regions.emplace_back(std::make_shared<ConvexPolygon>(std::move(verts)));
+        hierarchy.reset();
+        invalidatePathCache();
     }
 
     void NavMesh::calculateCentroids() {
         for (auto &region: regions) {
             region->calculateCentroid();
         }
+
+        hierarchy.reset();
+        invalidatePathCache();
     }
 
     // Function to establish connectivity between regions
@@ -98,6 +105,9 @@ namespace blipcade::collision {
                 }
             }
         }
+
+        hierarchy.reset();
+        invalidatePathCache();
     }
 
     nlohmann::json NavMesh::toJson() const {
@@ -182,17 +192,56 @@ namespace blipcade::collision {
         }
 
         this->outline = std::move(builtOutline);
+        this->outlineBVH = OutlineBVH(this->outline);
+        invalidatePathCache();
     }
 
     const std::vector<std::pair<Vector2, Vector2> > *NavMesh::getOutline() const {
         return &outline;
     }
 
+    const OutlineBVH &NavMesh::getOutlineBVH() const {
+        return outlineBVH;
+    }
+
+    std::optional<OutlineHit> NavMesh::raycastOutline(const Vector2 a, const Vector2 b) const {
+        return outlineBVH.raycast(a, b);
+    }
+
+    bool NavMesh::isSegmentCrossingOutline(const Vector2 a, const Vector2 b) const {
+        return outlineBVH.raycast(a, b).has_value();
+    }
+
+    std::optional<OutlineHit> NavMesh::sweepCircleOutline(const Vector2 a, const Vector2 b, const float radius) const {
+        return outlineBVH.sweepCircle(a, b, radius);
+    }
+
+    PathCache &NavMesh::getPathCache() const {
+        return pathCache;
+    }
+
+    void NavMesh::invalidatePathCache() {
+        pathCache.invalidate();
+    }
+
+    void NavMesh::buildHierarchy(const std::size_t maxClusterSize) {
+        hierarchy = std::make_shared<NavMeshHierarchy>(*this, maxClusterSize);
+        invalidatePathCache();
+    }
+
+    const NavMeshHierarchy *NavMesh::getHierarchy() const {
+        return hierarchy.get();
+    }
+
     bool NavMesh::isLineIntersectingOutline(Vector2 a, Vector2 b, Vector2& intersection) const {
         bool intersects = true;
-        auto meshOutline = getOutline();
 
-        for (const auto &outline: *meshOutline) {
+        std::vector<uint32_t> candidates;
+        outlineBVH.querySegment(a, b, 0.0f, candidates);
+
+        for (const auto index: candidates) {
+            const auto &outline = this->outline[index];
+
             if (
                 CheckCollisionLines(a, b, outline.first, outline.second, &intersection)
                 && !Vector2Equals(a, outline.first) && !Vector2Equals(b, outline.second)
@@ -286,6 +335,11 @@ namespace blipcade::collision {
         navMesh.buildConnectivity();
         navMesh.buildOutline();
 
+        // Small meshes are searched flat, the abstract graph only pays off on large levels
+        if (navMesh.regions.size() >= HIERARCHY_MIN_REGIONS) {
+            navMesh.buildHierarchy();
+        }
+
         return navMesh;
     }
 
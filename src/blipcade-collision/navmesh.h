@@ -11,6 +11,10 @@
 #include <vector>
 #include <nlohmann/json.hpp>
 
+#include "navhierarchy.h"
+#include "outlinebvh.h"
+#include "pathcache.h"
+
 
 namespace blipcade::collision {
     class ConvexPolygon {
@@ -75,6 +79,27 @@ namespace blipcade::collision {
 
         [[nodiscard]] const std::vector<std::pair<Vector2, Vector2> > *getOutline() const;
 
+        // Outline queries, accelerated by a BVH rebuilt together with the outline
+        [[nodiscard]] const OutlineBVH &getOutlineBVH() const;
+
+        [[nodiscard]] std::optional<OutlineHit> raycastOutline(Vector2 a, Vector2 b) const;
+
+        [[nodiscard]] bool isSegmentCrossingOutline(Vector2 a, Vector2 b) const;
+
+        [[nodiscard]] std::optional<OutlineHit> sweepCircleOutline(Vector2 a, Vector2 b, float radius) const;
+
+        // Pathfinding results are cached per mesh. Anything that edits `regions` directly
+        // must call invalidatePathCache() afterwards.
+        [[nodiscard]] PathCache &getPathCache() const;
+
+        void invalidatePathCache();
+
+        // Optional cluster/portal layer for long-distance queries. Dropped whenever regions or
+        // connectivity change, so it has to be rebuilt after editing the mesh.
+        void buildHierarchy(std::size_t maxClusterSize = 16);
+
+        [[nodiscard]] const NavMeshHierarchy *getHierarchy() const;
+
         [[nodiscard]] nlohmann::json toJson() const;
 
 
@@ -83,6 +108,11 @@ namespace blipcade::collision {
 
     private:
         std::vector<std::pair<Vector2, Vector2> > outline;
+        OutlineBVH outlineBVH;
+
+        mutable PathCache pathCache;
+
+        std::shared_ptr<NavMeshHierarchy> hierarchy;
     };
 } // collision
 // blipcade
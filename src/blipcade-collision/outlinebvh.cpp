@@ -0,0 +1,312 @@
+// outlinebvh.cpp
+
+#include "outlinebvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <raymath.h>
+
+namespace blipcade::collision {
+    namespace {
+        constexpr float EPSILON = 1e-6f;
+
+        float cross(const Vector2 &a, const Vector2 &b) {
+            return a.x * b.y - a.y * b.x;
+        }
+
+        // Entry fraction of the segment start + t * delta into the box, or nullopt when it misses within [0, 1]
+        std::optional<float> segmentEntersBox(const Vector2 &start, const Vector2 &delta, const Vector2 &min,
+                                              const Vector2 &max) {
+            float tEnter = 0.0f;
+            float tExit = 1.0f;
+
+            const float origins[2] = {start.x, start.y};
+            const float deltas[2] = {delta.x, delta.y};
+            const float mins[2] = {min.x, min.y};
+            const float maxs[2] = {max.x, max.y};
+
+            for (int axis = 0; axis < 2; ++axis) {
+                if (std::fabs(deltas[axis]) < EPSILON) {
+                    if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+                        return std::nullopt;
+                    }
+                    continue;
+                }
+
+                auto t0 = (mins[axis] - origins[axis]) / deltas[axis];
+                auto t1 = (maxs[axis] - origins[axis]) / deltas[axis];
+                if (t0 > t1) {
+                    std::swap(t0, t1);
+                }
+
+                tEnter = std::max(tEnter, t0);
+                tExit = std::min(tExit, t1);
+
+                if (tEnter > tExit) {
+                    return std::nullopt;
+                }
+            }
+
+            return tEnter;
+        }
+
+        // Fraction along start + t * delta where it crosses segment a-b
+        std::optional<float> segmentCrossing(const Vector2 &start, const Vector2 &delta, const Vector2 &a,
+                                             const Vector2 &b) {
+            const auto edge = Vector2Subtract(b, a);
+            const auto denominator = cross(delta, edge);
+
+            if (std::fabs(denominator) < EPSILON) {
+                return std::nullopt; // Parallel
+            }
+
+            const auto offset = Vector2Subtract(a, start);
+            const auto t = cross(offset, edge) / denominator;
+            const auto u = cross(offset, delta) / denominator;
+
+            if (t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f) {
+                return std::nullopt;
+            }
+
+            return t;
+        }
+
+        // Fraction along start + t * delta where it enters the circle
+        std::optional<float> circleEntry(const Vector2 &start, const Vector2 &delta, const Vector2 &center,
+                                         const float radius) {
+            const auto offset = Vector2Subtract(start, center);
+            const auto a = Vector2DotProduct(delta, delta);
+            const auto b = Vector2DotProduct(offset, delta);
+            const auto c = Vector2DotProduct(offset, offset) - radius * radius;
+
+            if (a < EPSILON) {
+                return std::nullopt;
+            }
+
+            const auto discriminant = b * b - a * c;
+            if (discriminant < 0.0f) {
+                return std::nullopt;
+            }
+
+            const auto t = (-b - std::sqrt(discriminant)) / a;
+            if (t < 0.0f || t > 1.0f) {
+                return std::nullopt;
+            }
+
+            return t;
+        }
+
+        Vector2 closestPointOnSegment(const Vector2 &point, const Vector2 &a, const Vector2 &b) {
+            const auto edge = Vector2Subtract(b, a);
+            const auto lengthSqr = Vector2DotProduct(edge, edge);
+            const auto t = lengthSqr > EPSILON
+                               ? Clamp(Vector2DotProduct(Vector2Subtract(point, a), edge) / lengthSqr, 0.0f, 1.0f)
+                               : 0.0f;
+
+            return Vector2Add(a, Vector2Scale(edge, t));
+        }
+
+        Vector2 edgeNormalFacing(const Vector2 &a, const Vector2 &b, const Vector2 &point) {
+            const auto edge = Vector2Normalize(Vector2Subtract(b, a));
+            const auto normal = Vector2{-edge.y, edge.x};
+
+            return Vector2DotProduct(normal, Vector2Subtract(point, a)) >= 0.0f ? normal : Vector2Scale(normal, -1.0f);
+        }
+    }
+
+    OutlineBVH::OutlineBVH(const std::vector<std::pair<Vector2, Vector2> > &edges) : edges(edges) {
+        if (edges.empty()) {
+            return;
+        }
+
+        order.resize(edges.size());
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+
+        nodes.reserve(edges.size() * 2);
+        build(0, static_cast<uint32_t>(edges.size()));
+    }
+
+    uint32_t OutlineBVH::build(const uint32_t first, const uint32_t count) {
+        const auto nodeIndex = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{});
+
+        auto min = Vector2{INFINITY, INFINITY};
+        auto max = Vector2{-INFINITY, -INFINITY};
+        for (auto i = first; i < first + count; ++i) {
+            const auto &[a, b] = edges[order[i]];
+            min = Vector2Min(min, Vector2Min(a, b));
+            max = Vector2Max(max, Vector2Max(a, b));
+        }
+
+        nodes[nodeIndex].min = min;
+        nodes[nodeIndex].max = max;
+
+        if (count <= LEAF_SIZE) {
+            nodes[nodeIndex].first = first;
+            nodes[nodeIndex].count = count;
+            return nodeIndex;
+        }
+
+        // Median split on the longer axis of the node
+        const auto splitOnX = (max.x - min.x) >= (max.y - min.y);
+        const auto middle = first + count / 2;
+
+        std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count,
+                         [this, splitOnX](const uint32_t lhs, const uint32_t rhs) {
+                             const auto &l = edges[lhs];
+                             const auto &r = edges[rhs];
+                             return splitOnX
+                                        ? l.first.x + l.second.x < r.first.x + r.second.x
+                                        : l.first.y + l.second.y < r.first.y + r.second.y;
+                         });
+
+        // Depth-first layout: the left child directly follows its parent
+        build(first, middle - first);
+        const auto right = build(middle, first + count - middle);
+
+        nodes[nodeIndex].first = right;
+        nodes[nodeIndex].count = 0;
+
+        return nodeIndex;
+    }
+
+    template<typename Visitor>
+    void OutlineBVH::traverse(const Vector2 &start, const Vector2 &end, const float radius, Visitor &&visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+
+        const auto delta = Vector2Subtract(end, start);
+        const auto grow = Vector2{radius, radius};
+
+        const auto enter = [&](const Node &node) {
+            return segmentEntersBox(start, delta, Vector2Subtract(node.min, grow), Vector2Add(node.max, grow));
+        };
+
+        auto best = 1.0f;
+
+        std::vector<std::pair<uint32_t, float> > stack;
+        if (const auto t = enter(nodes[0])) {
+            stack.emplace_back(0, *t);
+        }
+
+        while (!stack.empty()) {
+            const auto [index, tEnter] = stack.back();
+            stack.pop_back();
+
+            if (tEnter > best) {
+                continue;
+            }
+
+            const auto &node = nodes[index];
+
+            if (node.count > 0) {
+                for (auto i = node.first; i < node.first + node.count; ++i) {
+                    best = std::min(best, visit(order[i]));
+                }
+                continue;
+            }
+
+            const auto leftIndex = index + 1;
+            const auto rightIndex = node.first;
+
+            const auto leftT = enter(nodes[leftIndex]);
+            const auto rightT = enter(nodes[rightIndex]);
+
+            // Push the farther child first so the nearer one is visited first
+            if (leftT && rightT) {
+                if (*leftT <= *rightT) {
+                    stack.emplace_back(rightIndex, *rightT);
+                    stack.emplace_back(leftIndex, *leftT);
+                } else {
+                    stack.emplace_back(leftIndex, *leftT);
+                    stack.emplace_back(rightIndex, *rightT);
+                }
+            } else if (leftT) {
+                stack.emplace_back(leftIndex, *leftT);
+            } else if (rightT) {
+                stack.emplace_back(rightIndex, *rightT);
+            }
+        }
+    }
+
+    void OutlineBVH::querySegment(const Vector2 &start, const Vector2 &end, const float radius,
+                                  std::vector<uint32_t> &out) const {
+        out.clear();
+
+        traverse(start, end, radius, [&](const uint32_t edge) {
+            out.push_back(edge);
+            return 1.0f;
+        });
+
+        std::sort(out.begin(), out.end());
+    }
+
+    std::optional<OutlineHit> OutlineBVH::raycast(const Vector2 &start, const Vector2 &end) const {
+        std::optional<OutlineHit> hit;
+        const auto delta = Vector2Subtract(end, start);
+
+        traverse(start, end, 0.0f, [&](const uint32_t edge) {
+            const auto &[a, b] = edges[edge];
+
+            if (const auto t = segmentCrossing(start, delta, a, b); t && (!hit || *t < hit->t)) {
+                hit = OutlineHit{*t, Vector2Add(start, Vector2Scale(delta, *t)), edgeNormalFacing(a, b, start), edge};
+            }
+
+            return hit ? hit->t : 1.0f;
+        });
+
+        return hit;
+    }
+
+    std::optional<OutlineHit> OutlineBVH::sweepCircle(const Vector2 &start, const Vector2 &end,
+                                                      const float radius) const {
+        std::optional<OutlineHit> hit;
+        const auto delta = Vector2Subtract(end, start);
+
+        const auto consider = [&](const float t, const Vector2 &normal, const uint32_t edge) {
+            if (!hit || t < hit->t) {
+                hit = OutlineHit{t, Vector2Add(start, Vector2Scale(delta, t)), normal, edge};
+            }
+        };
+
+        traverse(start, end, radius, [&](const uint32_t edge) {
+            const auto &[a, b] = edges[edge];
+
+            // Already touching at the start
+            const auto closest = closestPointOnSegment(start, a, b);
+            if (Vector2DistanceSqr(start, closest) <= radius * radius) {
+                const auto away = Vector2Subtract(start, closest);
+                consider(0.0f, Vector2LengthSqr(away) > EPSILON ? Vector2Normalize(away) : edgeNormalFacing(a, b, start),
+                         edge);
+                return 0.0f;
+            }
+
+            // Edge sides, offset towards the start by the radius
+            const auto normal = edgeNormalFacing(a, b, start);
+            const auto offset = Vector2Scale(normal, radius);
+            if (const auto t = segmentCrossing(start, delta, Vector2Add(a, offset), Vector2Add(b, offset))) {
+                consider(*t, normal, edge);
+            }
+
+            // Rounded caps at the endpoints
+            for (const auto &cap: {a, b}) {
+                if (const auto t = circleEntry(start, delta, cap, radius)) {
+                    const auto center = Vector2Add(start, Vector2Scale(delta, *t));
+                    consider(*t, Vector2Normalize(Vector2Subtract(center, cap)), edge);
+                }
+            }
+
+            return hit ? hit->t : 1.0f;
+        });
+
+        return hit;
+    }
+
+    bool OutlineBVH::empty() const {
+        return edges.empty();
+    }
+} // collision
+// blipcade
@@ -0,0 +1,63 @@
+// outlinebvh.h
+
+#ifndef OUTLINEBVH_H
+#define OUTLINEBVH_H
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <raylib.h>
+
+namespace blipcade::collision {
+    struct OutlineHit {
+        float t; // Fraction along the query segment, 0..1
+        Vector2 point; // Hit point, or the circle center at impact for sweeps
+        Vector2 normal; // Unit normal of the hit edge, facing the query start
+        uint32_t edge; // Index into the outline
+    };
+
+    // Bounding volume hierarchy over navmesh outline edges.
+    // Built once per outline; queries only visit edges whose node bounds the query segment passes through.
+    class OutlineBVH {
+    public:
+        OutlineBVH() = default;
+
+        explicit OutlineBVH(const std::vector<std::pair<Vector2, Vector2> > &edges);
+
+        // Indices of edges whose bounds, grown by `radius`, the segment touches. Ascending order.
+        void querySegment(const Vector2 &start, const Vector2 &end, float radius, std::vector<uint32_t> &out) const;
+
+        // Nearest edge crossed by the segment
+        [[nodiscard]] std::optional<OutlineHit> raycast(const Vector2 &start, const Vector2 &end) const;
+
+        // First contact of a circle of `radius` moving from start to end
+        [[nodiscard]] std::optional<OutlineHit> sweepCircle(const Vector2 &start, const Vector2 &end,
+                                                            float radius) const;
+
+        [[nodiscard]] bool empty() const;
+
+    private:
+        static constexpr uint32_t LEAF_SIZE = 4;
+
+        struct Node {
+            Vector2 min;
+            Vector2 max;
+            uint32_t first; // Leaf: first slot in `order`. Inner: index of the right child, the left one is next.
+            uint32_t count; // Number of edges for leaves, 0 for inner nodes
+        };
+
+        std::vector<std::pair<Vector2, Vector2> > edges;
+        std::vector<uint32_t> order; // Edge indices, grouped by leaf
+        std::vector<Node> nodes;
+
+        uint32_t build(uint32_t first, uint32_t count);
+
+        // Visits leaf edges in front-to-back node order. `visit` returns the current best t, used for pruning.
+        template<typename Visitor>
+        void traverse(const Vector2 &start, const Vector2 &end, float radius, Visitor &&visit) const;
+    };
+} // collision
+// blipcade
+
+#endif // OUTLINEBVH_H
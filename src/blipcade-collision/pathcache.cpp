@@ -0,0 +1,100 @@
+// pathcache.cpp
+
+#include "pathcache.h"
+
+#include <cmath>
+#include <functional>
+
+namespace blipcade::collision {
+    std::size_t PathCache::KeyHash::operator()(const Key &key) const {
+        std::size_t seed = std::hash<const ConvexPolygon *>()(key.startRegion);
+
+        const auto combine = [&seed](const std::size_t value) {
+            seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+        };
+
+        combine(std::hash<const ConvexPolygon *>()(key.endRegion));
+        combine(std::hash<int32_t>()(key.startX));
+        combine(std::hash<int32_t>()(key.startY));
+        combine(std::hash<int32_t>()(key.endX));
+        combine(std::hash<int32_t>()(key.endY));
+
+        return seed;
+    }
+
+    PathCache::PathCache(const std::size_t capacity, const float quantum)
+        : capacity(capacity), quantum(quantum > 0.0f ? quantum : 1.0f) {
+    }
+
+    PathCache::Key PathCache::makeKey(const ConvexPolygon *startRegion, const ConvexPolygon *endRegion,
+                                      const Vector2 &start, const Vector2 &end) const {
+        return Key{
+            startRegion,
+            endRegion,
+            static_cast<int32_t>(std::floor(start.x / quantum)),
+            static_cast<int32_t>(std::floor(start.y / quantum)),
+            static_cast<int32_t>(std::floor(end.x / quantum)),
+            static_cast<int32_t>(std::floor(end.y / quantum))
+        };
+    }
+
+    const std::vector<Vector2> *PathCache::find(const Key &key) {
+        const auto it = index.find(key);
+
+        if (it == index.end()) {
+            misses++;
+            return nullptr;
+        }
+
+        hits++;
+
+        // Move to front, iterators stay valid with splice
+        entries.splice(entries.begin(), entries, it->second);
+
+        return &it->second->second;
+    }
+
+    void PathCache::insert(const Key &key, std::vector<Vector2> path) {
+        if (capacity == 0) {
+            return;
+        }
+
+        if (const auto it = index.find(key); it != index.end()) {
+            it->second->second = std::move(path);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+
+        entries.emplace_front(key, std::move(path));
+        index[key] = entries.begin();
+
+        evictOverflow();
+    }
+
+    void PathCache::invalidate() {
+        if (!entries.empty()) {
+            invalidations++;
+        }
+
+        entries.clear();
+        index.clear();
+    }
+
+    void PathCache::setCapacity(const std::size_t capacity) {
+        this->capacity = capacity;
+        evictOverflow();
+    }
+
+    PathCache::Stats PathCache::getStats() const {
+        return Stats{hits, misses, evictions, invalidations, entries.size(), capacity};
+    }
+
+    void PathCache::evictOverflow() {
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+} // collision
+// blipcade
@@ -0,0 +1,80 @@
+// pathcache.h
+
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <raylib.h>
+#include <unordered_map>
+#include <vector>
+
+namespace blipcade::collision {
+    class ConvexPolygon;
+
+    // LRU cache of finished (already cleaned) paths for a single NavMesh.
+    // Keyed by start/end region and endpoints snapped to a grid of `quantum` pixels,
+    // so NPCs walking between the same interaction points skip the search entirely.
+    class PathCache {
+    public:
+        struct Key {
+            const ConvexPolygon *startRegion;
+            const ConvexPolygon *endRegion;
+            int32_t startX;
+            int32_t startY;
+            int32_t endX;
+            int32_t endY;
+
+            bool operator==(const Key &other) const = default;
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const Key &key) const;
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            uint64_t invalidations = 0;
+            std::size_t size = 0;
+            std::size_t capacity = 0;
+        };
+
+        explicit PathCache(std::size_t capacity = 64, float quantum = 1.0f);
+
+        [[nodiscard]] Key makeKey(const ConvexPolygon *startRegion, const ConvexPolygon *endRegion,
+                                  const Vector2 &start, const Vector2 &end) const;
+
+        // Returns nullptr on miss. Hits are moved to the front of the LRU list.
+        const std::vector<Vector2> *find(const Key &key);
+
+        void insert(const Key &key, std::vector<Vector2> path);
+
+        // Drops every cached path. Called whenever the owning mesh changes.
+        void invalidate();
+
+        void setCapacity(std::size_t capacity);
+
+        [[nodiscard]] Stats getStats() const;
+
+    private:
+        using Entry = std::pair<Key, std::vector<Vector2> >;
+
+        std::size_t capacity;
+        float quantum;
+
+        std::list<Entry> entries; // Most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+
+        void evictOverflow();
+    };
+} // collision
+// blipcade
+
+#endif // PATHCACHE_H
@@ -71,6 +71,45 @@ namespace blipcade::collision {
             return {startPoint, endPoint};
         }
 
+        auto &pathCache = navMesh.getPathCache();
+        const auto cacheKey = pathCache.makeKey(startRegion, endRegion, startPoint, endPoint);
+
+        if (const auto cachedPath = pathCache.find(cacheKey)) {
+            auto path = *cachedPath;
+
+            // Endpoints are quantized in the key, so pin them back to the requested ones
+            if (!path.empty()) {
+                path.front() = startPoint;
+                path.back() = endPoint;
+            }
+
+            return path;
+        }
+
+        // Long-distance queries go through the cluster graph when the mesh has one
+        if (const auto hierarchy = navMesh.getHierarchy()) {
+            if (const auto corridor = hierarchy->findCorridor(startRegion, endRegion)) {
+                if (corridor->empty()) {
+                    pathCache.insert(cacheKey, {});
+                    return {};
+                }
+
+                std::vector<Vector2> path;
+                path.reserve(corridor->size() + 1);
+                path.push_back(startPoint);
+                for (const auto region: *corridor) {
+                    path.push_back(region->centroid);
+                }
+                path.back() = endPoint;
+
+                auto const cleanedPath = cleanPath(path, navMesh);
+
+                pathCache.insert(cacheKey, cleanedPath);
+
+                return cleanedPath;
+            }
+        }
+
         std::priority_queue<PathPoint, std::vector<PathPoint>, ComparePathPoint> openList;
         std::unordered_set<PathPoint, PathPointHash> closedList;
 
@@ -111,8 +150,9 @@ namespace blipcade::collision {
                     lines.emplace_back(path[i], path[i + 1]);
                 }
 
-                const auto meshOutline = navMesh.getOutline(); // const std::vector<std::pair<Vector2, Vector2>>*
-                auto const cleanedPath = cleanPath(path, *meshOutline);
+                auto const cleanedPath = cleanPath(path, navMesh);
+
+                pathCache.insert(cacheKey, cleanedPath);
 
                 return cleanedPath;
             }
@@ -136,55 +176,66 @@ namespace blipcade::collision {
             }
         }
 
-        return {};
+        // Unreachable destinations are cached too, so repeated failing queries stay cheap
+        pathCache.insert(cacheKey, {});
 
-        throw std::runtime_error("Not implemented.");
+        return {};
     }
 
-    std::vector<Vector2> Pathfinding::cleanPath(const std::vector<Vector2> &path, const std::vector<std::pair<Vector2, Vector2>> &meshOutline) {
-        std::vector<Vector2> pathCopy = {};
-        for (auto point : path) {
-            pathCopy.push_back(point);
+    namespace {
+        // Whether the shortcut a-c crosses the outline edge, ignoring touches at shared vertices and at b
+        bool shortcutCrossesEdge(const Vector2 &a, const Vector2 &b, const Vector2 &c,
+                                 const std::pair<Vector2, Vector2> &outline) {
+            Vector2 intersection;
+            return CheckCollisionLines(a, c, outline.first, outline.second, &intersection)
+                   && !Vector2Equals(a, outline.first) && !Vector2Equals(c, outline.second)
+                   && !Vector2Equals(a, outline.second) && !Vector2Equals(c, outline.first)
+                   && !Vector2Equals(intersection, a) && !Vector2Equals(intersection, c)
+                   && !Vector2Equals(intersection, b);
         }
 
-        // for each three points A, B, C in the path we want to construct a line AC, and check if it intersects with any of the lines in the mesh outline
-        // if it does not, we remove B from the path
-        // if it does, we keep B in the path
-        // we repeat this process until we have a clean path, where we can't remove any more points
-
-        bool changed;
-
-        do {
-            changed = false;
-            for (size_t i = 0; i < pathCopy.size() - 2; ++i) {
-                const Vector2& a = pathCopy[i];
-                const Vector2& b = pathCopy[i + 1];
-                const Vector2& c = pathCopy[i + 2];
-
-                bool canRemoveB = true;
-                for (const auto& outline : meshOutline) {
-                    Vector2 intersection;
-                    if (
-                        CheckCollisionLines(a, c, outline.first, outline.second, &intersection)
-                        && !Vector2Equals(a, outline.first) && !Vector2Equals(c, outline.second)
-                        && !Vector2Equals(a, outline.second) && !Vector2Equals(c, outline.first)
-                        && !Vector2Equals(intersection, a) && !Vector2Equals(intersection, c)
-                        && !Vector2Equals(intersection, b)
-                        ) {
-                        canRemoveB = false;
-                        break;
+        // For each three points A, B, C in the path we construct a line AC and drop B when AC crosses no
+        // outline edge. Repeats until no more points can be removed.
+        template<typename CrossesOutline>
+        std::vector<Vector2> removeRedundantPoints(const std::vector<Vector2> &path, CrossesOutline &&crossesOutline) {
+            std::vector<Vector2> pathCopy = path;
+
+            bool changed;
+
+            do {
+                changed = false;
+                for (size_t i = 0; i + 2 < pathCopy.size(); ++i) {
+                    if (!crossesOutline(pathCopy[i], pathCopy[i + 1], pathCopy[i + 2])) {
+                        pathCopy.erase(pathCopy.begin() + i + 1);
+                        changed = true;
+                        break; // Restart the loop as we modified the path
                     }
                 }
+            } while (changed);
 
-                if (canRemoveB) {
-                    pathCopy.erase(pathCopy.begin() + i + 1);
-                    changed = true;
-                    break;  // Restart the loop as we modified the path
-                }
-            }
-        } while (changed);
+            return pathCopy;
+        }
+    }
+
+    std::vector<Vector2> Pathfinding::cleanPath(const std::vector<Vector2> &path, const std::vector<std::pair<Vector2, Vector2>> &meshOutline) {
+        return removeRedundantPoints(path, [&](const Vector2 &a, const Vector2 &b, const Vector2 &c) {
+            return std::any_of(meshOutline.begin(), meshOutline.end(), [&](const auto &outline) {
+                return shortcutCrossesEdge(a, b, c, outline);
+            });
+        });
+    }
+
+    std::vector<Vector2> Pathfinding::cleanPath(const std::vector<Vector2> &path, const NavMesh &navMesh) {
+        const auto &meshOutline = *navMesh.getOutline();
+        std::vector<uint32_t> candidates;
+
+        return removeRedundantPoints(path, [&](const Vector2 &a, const Vector2 &b, const Vector2 &c) {
+            navMesh.getOutlineBVH().querySegment(a, c, 0.0f, candidates);
 
-        return pathCopy;
+            return std::any_of(candidates.begin(), candidates.end(), [&](const uint32_t index) {
+                return shortcutCrossesEdge(a, b, c, meshOutline[index]);
+            });
+        });
     }
 
     std::vector<Vector2> Pathfinding::reconstructPath(const PathPoint* current) {
@@ -59,6 +59,9 @@ namespace blipcade::collision {
         static std::vector<Vector2> cleanPath(const std::vector<Vector2> &path,
                                               const std::vector<std::pair<Vector2, Vector2> > &meshOutline);
 
+        // Same as above, but only tests the outline edges the mesh BVH reports near each shortcut
+        static std::vector<Vector2> cleanPath(const std::vector<Vector2> &path, const NavMesh &navMesh);
+
         static std::vector<Vector2> reconstructPath(const PathPoint *current);
 
     private:
@@ -4,6 +4,7 @@
 
 #include "devtool.h"
 
+#include <audio.h>
 #include <imgui.h>
 #include <runtime.h>
 #include <algorithm> // For std::transform
@@ -93,6 +94,8 @@ namespace blipcade::devtool {
 
         ImGui::Text("FPS: %f", FPS);
 
+        RenderAudioStats();
+
         // Add a separator and the filter input
         ImGui::Separator();
         ImGui::Text("Filter Entities by Tag:");
@@ -153,6 +156,54 @@ namespace blipcade::devtool {
         return properties;
     }
 
+    void Devtool::RenderAudioStats() const {
+        if (!ImGui::CollapsingHeader("Audio")) {
+            return;
+        }
+
+        auto const audio = runtime.getAudio();
+        auto const stats = audio->GetStats();
+        auto const count = [](const uint64_t value) { return static_cast<unsigned long long>(value); };
+
+        ImGui::Text("Load: %.1f%%%s", stats.load * 100.0, audio->IsHeadless() ? " (headless)" : "");
+        ImGui::Text("Callbacks: %llu, last %.2f ms, worst %.2f ms", count(stats.callbacks),
+                    stats.lastCallbackSeconds * 1000.0, stats.worstCallbackSeconds * 1000.0);
+
+        // Callbacks by the share of their budget they took
+        std::array<float, audio::MixerStats::HISTOGRAM_BUCKETS> buckets{};
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] = static_cast<float>(stats.callbackHistogram[i]);
+        }
+        ImGui::PlotHistogram("##callbacks", buckets.data(), static_cast<int>(buckets.size()), 0, nullptr, 0.0f,
+                             FLT_MAX, ImVec2(0, 40));
+        ImGui::Text("<1/8 %llu  <1/4 %llu  <1/2 %llu  <3/4 %llu  <1 %llu  over %llu",
+                    count(stats.callbackHistogram[0]), count(stats.callbackHistogram[1]),
+                    count(stats.callbackHistogram[2]), count(stats.callbackHistogram[3]),
+                    count(stats.callbackHistogram[4]), count(stats.callbackHistogram[5]));
+
+        ImGui::Text("Underruns: %llu, music stream: %llu", count(stats.underruns), count(stats.streamUnderruns));
+        ImGui::Text("Voices: %u active, %u culled, %u peak of %u", stats.activeVoices, stats.culledVoices,
+                    stats.peakVoices, audio::Mixer::MAX_VOICES);
+        ImGui::Text("Stolen: %llu, dropped: %llu, dropped commands: %llu", count(stats.stolenVoices),
+                    count(stats.droppedVoices), count(stats.droppedCommands));
+
+        for (const auto &bus: stats.buses) {
+            if (bus.effects == 0) {
+                continue;
+            }
+
+            // Share of the mixed time spent in the chain
+            const auto share = stats.mixedSeconds > 0.0 ? bus.effectSeconds / stats.mixedSeconds : 0.0;
+            ImGui::Text("  %s: %u effects, %.2f%%", bus.name.c_str(), bus.effects, share * 100.0);
+        }
+
+        if (ImGui::Button("Reset audio stats")) {
+            audio->ResetStats();
+        }
+
+        ImGui::Separator();
+    }
+
     void Devtool::RenderECSInspector() const {
         auto const ecs = runtime.getECS();
         auto const ctx = runtime.getContext();
@@ -30,6 +30,8 @@ namespace blipcade::devtool {
 
         void RenderECSInspector() const;
 
+        void RenderAudioStats() const;
+
         void drawObjectRecursive(quickjs::context &ctx, const std::string &prefix, const quickjs::value &object) const;
 
         void setScale(float scale);
@@ -0,0 +1,163 @@
+// blit.cpp
+
+#include "blit.h"
+
+#include "cpufeatures.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(BLIPCADE_AVX2_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace blipcade::graphics {
+    namespace {
+#if defined(__SSE2__)
+        // Keeps dst where src is transparent, takes src everywhere else
+        __m128i select16(const __m128i dst, const __m128i src, const __m128i key) {
+            const auto keep = _mm_cmpeq_epi8(src, key);
+            return _mm_or_si128(_mm_and_si128(keep, dst), _mm_andnot_si128(keep, src));
+        }
+
+        __m128i reverse16(__m128i value) {
+            value = _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 1, 2, 3));
+            value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+            value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+            return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        }
+#endif
+
+#if defined(BLIPCADE_AVX2_DISPATCH)
+        BLIPCADE_TARGET_AVX2 __m256i select32(const __m256i dst, const __m256i src, const __m256i key) {
+            return _mm256_blendv_epi8(src, dst, _mm256_cmpeq_epi8(src, key));
+        }
+
+        BLIPCADE_TARGET_AVX2 __m256i reverse32(const __m256i value) {
+            const auto bytes = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+            const auto reversedLanes = _mm256_shuffle_epi8(value, bytes);
+            return _mm256_permute2x128_si256(reversedLanes, reversedLanes, 0x01);
+        }
+
+        // Both return how many pixels they did, always a multiple of 32
+        BLIPCADE_TARGET_AVX2 std::size_t maskedRowAvx2(uint8_t *dst, const uint8_t *src, const std::size_t count,
+                                                       const uint8_t transparent) {
+            const auto key = _mm256_set1_epi8(static_cast<char>(transparent));
+            std::size_t i = 0;
+
+            for (; i + 32 <= count; i += 32) {
+                const auto s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                const auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), select32(d, s, key));
+            }
+
+            return i;
+        }
+
+        BLIPCADE_TARGET_AVX2 std::size_t maskedRowReversedAvx2(uint8_t *dst, const uint8_t *src,
+                                                               const std::size_t count, const uint8_t transparent) {
+            const auto key = _mm256_set1_epi8(static_cast<char>(transparent));
+            std::size_t i = 0;
+
+            for (; i + 32 <= count; i += 32) {
+                const auto s = reverse32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + count - i - 32)));
+                const auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), select32(d, s, key));
+            }
+
+            return i;
+        }
+#endif
+    }
+
+    void blitMaskedRow(uint8_t *dst, const uint8_t *src, const std::size_t count, const uint8_t transparent) {
+        [[maybe_unused]] const auto level = simdLevel();
+        std::size_t i = 0;
+
+#if defined(BLIPCADE_AVX2_DISPATCH)
+        if (level == SimdLevel::Avx2) {
+            i = maskedRowAvx2(dst, src, count, transparent);
+        }
+#endif
+
+#if defined(__SSE2__)
+        const auto key16 = _mm_set1_epi8(static_cast<char>(transparent));
+        for (; level >= SimdLevel::Sse2 && i + 16 <= count; i += 16) {
+            const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), select16(d, s, key16));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            if (src[i] != transparent) {
+                dst[i] = src[i];
+            }
+        }
+    }
+
+    void blitMaskedRowReversed(uint8_t *dst, const uint8_t *src, const std::size_t count, const uint8_t transparent) {
+        [[maybe_unused]] const auto level = simdLevel();
+        std::size_t i = 0;
+
+        // Chunk starting at dst + i reads the source chunk ending at src + count - i
+#if defined(BLIPCADE_AVX2_DISPATCH)
+        if (level == SimdLevel::Avx2) {
+            i = maskedRowReversedAvx2(dst, src, count, transparent);
+        }
+#endif
+
+#if defined(__SSE2__)
+        const auto key16 = _mm_set1_epi8(static_cast<char>(transparent));
+        for (; level >= SimdLevel::Sse2 && i + 16 <= count; i += 16) {
+            const auto s = reverse16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + count - i - 16)));
+            const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), select16(d, s, key16));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const auto index = src[count - 1 - i];
+            if (index != transparent) {
+                dst[i] = index;
+            }
+        }
+    }
+
+    void blitRemappedRow(uint8_t *dst, const uint8_t *src, const std::size_t count, const uint8_t transparent,
+                         const bool reversed, const std::array<uint8_t, 256> &remap) {
+        // A 256-entry table does not fit a byte shuffle, so each chunk is looked up into a scratch row that then
+        // goes through the masked kernel with transparent pixels kept as the key
+        constexpr std::size_t CHUNK = 64;
+        uint8_t scratch[CHUNK];
+
+        for (std::size_t offset = 0; offset < count; offset += CHUNK) {
+            const auto length = count - offset < CHUNK ? count - offset : CHUNK;
+            bool collides = false;
+
+            for (std::size_t i = 0; i < length; ++i) {
+                const auto index = reversed ? src[count - 1 - offset - i] : src[offset + i];
+                const auto mapped = remap[index];
+
+                collides |= index != transparent && mapped == transparent;
+                scratch[i] = index == transparent ? transparent : mapped;
+            }
+
+            if (!collides) {
+                blitMaskedRow(dst + offset, scratch, length, transparent);
+                continue;
+            }
+
+            // A visible index remaps onto the key, so the scratch row cannot carry the mask
+            for (std::size_t i = 0; i < length; ++i) {
+                const auto index = reversed ? src[count - 1 - offset - i] : src[offset + i];
+                if (index != transparent) {
+                    dst[offset + i] = remap[index];
+                }
+            }
+        }
+    }
+} // graphics
+// blipcade
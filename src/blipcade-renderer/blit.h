@@ -0,0 +1,27 @@
+// blit.h
+
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace blipcade::graphics {
+    // Row kernels for indexed sprite blits. Source pixels equal to `transparent` leave the destination untouched.
+    // Chunks of 32 (AVX2) or 16 (SSE2) pixels are processed at once when the CPU supports it (see simdLevel), with a
+    // scalar tail.
+
+    // dst[i] = src[i]
+    void blitMaskedRow(uint8_t *dst, const uint8_t *src, std::size_t count, uint8_t transparent);
+
+    // dst[i] = src[count - 1 - i], for horizontally flipped sprites
+    void blitMaskedRowReversed(uint8_t *dst, const uint8_t *src, std::size_t count, uint8_t transparent);
+
+    // Either of the above with every written index passed through `remap`
+    void blitRemappedRow(uint8_t *dst, const uint8_t *src, std::size_t count, uint8_t transparent, bool reversed,
+                         const std::array<uint8_t, 256> &remap);
+} // graphics
+// blipcade
+
+#endif // BLIT_H
@@ -4,9 +4,13 @@
 
 #include "canvas.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <iostream>
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
 
 #include "font.h"
 
@@ -15,9 +19,63 @@
 #include "lighting_shader_vert.h"
 
 namespace blipcade::graphics {
-    Canvas::Canvas(const uint32_t width, const uint32_t height): width(width), height(height),
-    palette(std::make_unique<Palette685>()), lightingRender(LoadRenderTexture(width, height)),
-lightEffects()  {
+    namespace {
+        enum class DrawOp : uint8_t {
+            FillScreen,
+            Pixel,
+            Line,
+            Circle,
+            FilledCircle,
+            Rectangle,
+            FilledRectangle,
+            Sprite,
+            SpriteEx,
+            Text,
+            Layer,
+            Lighting
+        };
+
+        uint64_t mixKey(const uint64_t hash, const uint64_t value) {
+            return (hash ^ value) * 0x100000001b3ull;
+        }
+
+        // Identifies a draw call for dirty-rect tracking
+        template<typename... Args>
+        uint64_t drawKey(const DrawOp op, const Args... args) {
+            auto hash = mixKey(0xcbf29ce484222325ull, static_cast<uint64_t>(op));
+            ((hash = mixKey(hash, static_cast<uint64_t>(args))), ...);
+            return hash;
+        }
+    }
+
+    Canvas::Canvas(const uint32_t width, const uint32_t height, const CanvasBackend backend): width(width),
+        height(height), backend(backend), palette(std::make_unique<Palette685>()), lightEffects(),
+        dirtyRects(width, height) {
+        for (int i = 0; i < 256; ++i) {
+            virtualPalette[i] = static_cast<uint8_t>(i);
+            colorLookup[i] = palette->get_color(i); // Define this function based on your palette
+        }
+
+        // Row 0 is the plain palette
+        std::array<uint8_t, 256> identity{};
+        for (int i = 0; i < 256; ++i) {
+            identity[i] = static_cast<uint8_t>(i);
+        }
+        paletteRemaps.push_back(identity);
+        paletteRows[hashRemap(identity)] = 0;
+        paletteRowKeys.push_back(hashRemap(identity));
+        paletteRowUses.push_back(0);
+        textColorRows.fill(-1);
+
+        if (isSoftware()) {
+            // No GL context required: everything is drawn into `pixels` and resolved on demand
+            pixels.assign(static_cast<size_t>(width) * height, 0);
+            rasterizer = std::make_unique<IndexedRasterizer>(pixels.data(), width, height);
+            resolver = std::make_unique<PaletteResolver>();
+            rasterizer->setTransparentIndex(transparentColor);
+            return;
+        }
+
         // paletteShader = LoadShader(nullptr, "palette_shader.frag");
         paletteShader = LoadShaderFromMemory(nullptr, palette_shader_fragmentSource);
         paletteLoc = GetShaderLocation(paletteShader, "palette");
@@ -29,12 +87,7 @@ lightEffects()  {
         // int baseTextureLoc = GetShaderLocation(lightingShader, "baseTexture");
         // SetShaderValueTexture(lightingShader, baseTextureLoc, paletteTexture);
 
-        for (int i = 0; i < 256; ++i) {
-            virtualPalette[i] = static_cast<uint8_t>(i);
-            colorLookup[i] = palette->get_color(i); // Define this function based on your palette
-        }
-
-        updateShaderPalette();
+        createPaletteTexture();
         lightingRender = LoadRenderTexture(width, height);
 
         // Set the MVP matrix
@@ -42,10 +95,14 @@ lightEffects()  {
         int mvpLoc = GetShaderLocation(lightingShader, "mvp");
         SetShaderValueMatrix(lightingShader, mvpLoc, mvp);
 
-        tintColorLoc = GetShaderLocation(lightingShader, "tintColor");
-        opacityLoc = GetShaderLocation(lightingShader, "opacity");
+        lightTintsLoc = GetShaderLocation(lightingShader, "lightTints");
+        lightOpacitiesLoc = GetShaderLocation(lightingShader, "lightOpacities");
+        lightCountLoc = GetShaderLocation(lightingShader, "lightCount");
         baseTextureLoc = GetShaderLocation(lightingShader, "baseTexture");
-        maskTextureLoc = GetShaderLocation(lightingShader, "maskTexture");
+        maskAtlasLoc = GetShaderLocation(lightingShader, "maskAtlas");
+        maskGridLoc = GetShaderLocation(lightingShader, "maskGrid");
+        firstMaskLoc = GetShaderLocation(lightingShader, "firstMask");
+        flipMaskLoc = GetShaderLocation(lightingShader, "flipMask");
 
         // std::cout << "Canvas created with width: " << width << ", height: " << height << std::endl;
         ClearBackground(BLANK);
@@ -54,68 +111,150 @@ lightEffects()  {
     void Canvas::setTransparentColor(uint8_t color) {
         transparentColor = color;
 
+        if (isSoftware()) {
+            rasterizer->setTransparentIndex(transparentColor);
+            return;
+        }
+
         // Update the transparent index in the shader
         int transparentIndexLoc = GetShaderLocation(paletteShader, "transparentIndex");
         int transparentIndex = transparentColor;
         SetShaderValue(paletteShader, transparentIndexLoc, &transparentIndex, SHADER_UNIFORM_INT);
     }
 
+    uint64_t Canvas::hashRemap(const std::array<uint8_t, 256> &remap) {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (const auto index: remap) {
+            hash = (hash ^ index) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void Canvas::fillPaletteRow(const uint8_t row, Color *out) const {
+        const auto &remap = paletteRemaps[row];
+        for (int i = 0; i < 256; ++i) {
+            out[i] = colorLookup[virtualPalette[remap[i]]];
+        }
+    }
+
     void Canvas::createPaletteTexture() {
+        std::vector<Color> palettePixels(256 * PALETTE_ROWS, Color{0, 0, 0, 0});
+        fillPaletteRow(0, palettePixels.data());
+
         Image paletteImage;
         paletteImage.width = 256;
-        paletteImage.height = 1;
+        paletteImage.height = PALETTE_ROWS;
         paletteImage.mipmaps = 1;
         paletteImage.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
-        paletteImage.data = new Color[256];
-
-        Color *palettePixels = (Color *) paletteImage.data;
-        for (int i = 0; i < 256; ++i) {
-            uint8_t colorIndex = virtualPalette[i];
-            palettePixels[i] = colorLookup[colorIndex];
-        }
+        paletteImage.data = palettePixels.data();
 
         paletteTexture = LoadTextureFromImage(paletteImage);
-        UnloadImage(paletteImage);
+
+        // Palette entries are fetched by exact texel, never blended
+        SetTextureFilter(paletteTexture, TEXTURE_FILTER_POINT);
+        SetTextureWrap(paletteTexture, TEXTURE_WRAP_CLAMP);
     }
 
     void Canvas::updatePaletteTexture() {
-        Color palettePixels[256];
-        for (int i = 0; i < 256; ++i) {
-            uint8_t colorIndex = virtualPalette[i];
-            palettePixels[i] = colorLookup[colorIndex];
+        // Sprites already batched were drawn against the old colors
+        endSpriteBatch();
+
+        const auto rows = static_cast<uint32_t>(paletteRemaps.size());
+        std::vector<Color> palettePixels(256 * rows);
+        for (uint32_t row = 0; row < rows; ++row) {
+            fillPaletteRow(static_cast<uint8_t>(row), palettePixels.data() + row * 256);
+        }
+
+        UpdateTextureRec(paletteTexture, {0, 0, 256, static_cast<float>(rows)}, palettePixels.data());
+    }
+
+    uint8_t Canvas::getPaletteRow(const std::array<uint8_t, 256> &remap) {
+        const auto key = hashRemap(remap);
+
+        if (const auto it = paletteRows.find(key); it != paletteRows.end() && paletteRemaps[it->second] == remap) {
+            return usePaletteRow(it->second);
+        }
+
+        uint8_t row;
+        if (paletteRemaps.size() < PALETTE_ROWS) {
+            row = static_cast<uint8_t>(paletteRemaps.size());
+            paletteRemaps.push_back(remap);
+            paletteRowKeys.push_back(key);
+            paletteRowUses.push_back(0);
+        } else {
+            row = recyclePaletteRow();
+            paletteRemaps[row] = remap;
+            paletteRowKeys[row] = key;
+        }
+
+        paletteRows[key] = row;
+        usePaletteRow(row);
+
+        if (!isSoftware()) {
+            Color rowPixels[256];
+            fillPaletteRow(row, rowPixels);
+            UpdateTextureRec(paletteTexture, {0, static_cast<float>(row), 256, 1}, rowPixels);
+        }
+
+        return row;
+    }
+
+    void Canvas::beginSpriteBatch() {
+        if (!spriteBatchActive) {
+            BeginShaderMode(paletteShader);
+            spriteBatchActive = true;
         }
 
-        UpdateTexture(paletteTexture, palettePixels);
+        // Re-bound per draw: raylib drops extra sampler bindings whenever it flushes a full batch
+        SetShaderValueTexture(paletteShader, paletteLoc, paletteTexture);
+    }
+
+    void Canvas::endSpriteBatch() {
+        if (spriteBatchActive) {
+            EndShaderMode();
+            spriteBatchActive = false;
+        }
+    }
+
+    void Canvas::flush() {
+        if (!isSoftware()) {
+            endSpriteBatch();
+        }
     }
 
     Canvas::~Canvas() {
+        if (isSoftware()) {
+            return;
+        }
+
         UnloadShader(paletteShader);
+        UnloadTexture(paletteTexture);
         UnloadShader(lightingShader);
         UnloadTexture(lightingRender.texture);
-    }
 
-    Texture2D paletteTexture;
+        if (lightMaskAtlas.id != 0) {
+            UnloadRenderTexture(lightMaskAtlas);
+        }
+
+        for (const auto &[id, layer]: layers) {
+            if (layer.target.id != 0) {
+                UnloadRenderTexture(layer.target);
+            }
+        }
+    }
 
     void Canvas::setPalette(const std::array<uint8_t, 256> &virtualPalette,
                             const std::array<Color, 256> &colorLookup) {
         this->virtualPalette = virtualPalette;
         this->colorLookup = colorLookup;
-        updateShaderPalette();
-    }
+        dirtyRects.invalidate();
 
-    void Canvas::updateShaderPalette() {
-        float paletteData[256 * 4]; // Each color has 4 components (RGBA)
-        for (int i = 0; i < 256; ++i) {
-            uint8_t colorIndex = virtualPalette[i];
-            Color color = colorLookup[colorIndex];
-
-            paletteData[i * 4 + 0] = color.r / 255.0f;
-            paletteData[i * 4 + 1] = color.g / 255.0f;
-            paletteData[i * 4 + 2] = color.b / 255.0f;
-            paletteData[i * 4 + 3] = color.a / 255.0f;
+        if (!isSoftware()) {
+            // GPU layers hold resolved colors
+            invalidateLayers();
+            updatePaletteTexture();
         }
-
-        SetShaderValueV(paletteShader, paletteLoc, paletteData, SHADER_UNIFORM_VEC4, 256);
     }
 
     void Canvas::clear() {
@@ -123,6 +262,11 @@ lightEffects()  {
         offsetX = 0;
         offsetY = 0;
         transparentColor = 255;
+
+        if (isSoftware()) {
+            rasterizer->setClipRect(clipRect);
+            rasterizer->setTransparentIndex(transparentColor);
+        }
     }
 
     void Canvas::setCamera(const int32_t offsetX, const int32_t offsetY) {
@@ -131,6 +275,16 @@ lightEffects()  {
     }
 
     void Canvas::fillScreen(const uint8_t color) {
+        trackDraw({0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)},
+                  drawKey(DrawOp::FillScreen, color));
+
+        if (isSoftware()) {
+            rasterizer->fill(color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto colorIndex = virtualPalette[color];
         ClearBackground(colorLookup[colorIndex]);
     }
@@ -142,6 +296,10 @@ lightEffects()  {
         const int32_t height = rect.height > this->height ? this->height : rect.height;
 
         clipRect = {x, y, width, height};
+
+        if (isSoftware()) {
+            rasterizer->setClipRect(clipRect);
+        }
     }
 
     bool Canvas::isWithinClippingRect(const int32_t x, const int32_t y) const {
@@ -154,6 +312,15 @@ lightEffects()  {
     }
 
     void Canvas::drawPixel(const int32_t x, const int32_t y, const uint8_t color) {
+        trackDraw({x + offsetX, y + offsetY, 1, 1}, drawKey(DrawOp::Pixel, x + offsetX, y + offsetY, color));
+
+        if (isSoftware()) {
+            rasterizer->pixel(x + offsetX, y + offsetY, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto realColor = colorLookup[virtualPalette[color]];
         const auto realX = x + offsetX;
         const auto realY = y + offsetY;
@@ -161,7 +328,18 @@ lightEffects()  {
     }
 
     void Canvas::drawLine(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1,
-                          const uint8_t color) const {
+                          const uint8_t color) {
+        trackDraw({std::min(x0, x1) + offsetX, std::min(y0, y1) + offsetY, std::abs(x1 - x0) + 1,
+                   std::abs(y1 - y0) + 1},
+                  drawKey(DrawOp::Line, x0 + offsetX, y0 + offsetY, x1 + offsetX, y1 + offsetY, color));
+
+        if (isSoftware()) {
+            rasterizer->line(x0 + offsetX, y0 + offsetY, x1 + offsetX, y1 + offsetY, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         // TODO: clipper
         auto realColor = colorLookup[virtualPalette[color]];
         const auto realX0 = x0 + offsetX;
@@ -174,6 +352,16 @@ lightEffects()  {
 
     void Canvas::drawCircle(const int32_t center_x, const int32_t center_y, const uint32_t radius,
                             const uint8_t color) {
+        trackDraw(circleBounds(center_x, center_y, radius),
+                  drawKey(DrawOp::Circle, center_x + offsetX, center_y + offsetY, radius, color));
+
+        if (isSoftware()) {
+            rasterizer->circle(center_x + offsetX, center_y + offsetY, radius, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         auto realColor = colorLookup[virtualPalette[color]];
 
         const auto realCenterX = center_x + offsetX;
@@ -184,6 +372,16 @@ lightEffects()  {
 
     void Canvas::drawFilledCircle(const int32_t center_x, const int32_t center_y, const uint32_t radius,
                                   const uint8_t color) {
+        trackDraw(circleBounds(center_x, center_y, radius),
+                  drawKey(DrawOp::FilledCircle, center_x + offsetX, center_y + offsetY, radius, color));
+
+        if (isSoftware()) {
+            rasterizer->filledCircle(center_x + offsetX, center_y + offsetY, radius, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         auto realColor = colorLookup[virtualPalette[color]];
 
         const auto realCenterX = center_x + offsetX;
@@ -194,6 +392,17 @@ lightEffects()  {
 
     void Canvas::drawRectangle(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1,
                                const uint8_t color) {
+        trackDraw({x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1},
+                  drawKey(DrawOp::Rectangle, x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1, color));
+
+        if (isSoftware()) {
+            // Same extent as the GPU path below
+            rasterizer->rect(x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto realColor = colorLookup[virtualPalette[color]];
 
         const auto realX0 = x0 + offsetX;
@@ -205,6 +414,16 @@ lightEffects()  {
 
     void Canvas::drawRectangleW(const int32_t x, const int32_t y, const int32_t width, const int32_t height,
                                 const uint8_t color) {
+        trackDraw({x + offsetX, y + offsetY, width, height},
+                  drawKey(DrawOp::Rectangle, x + offsetX, y + offsetY, width, height, color));
+
+        if (isSoftware()) {
+            rasterizer->rect(x + offsetX, y + offsetY, width, height, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto realColor = colorLookup[virtualPalette[color]];
 
         const auto realX = x + offsetX;
@@ -215,6 +434,18 @@ lightEffects()  {
 
     void Canvas::drawFilledRectangle(const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1,
                                      const uint8_t color) {
+        trackDraw({x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1},
+                  drawKey(DrawOp::FilledRectangle, x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1,
+                          color));
+
+        if (isSoftware()) {
+            // Same extent as the GPU path below
+            rasterizer->filledRect(x0 + offsetX, y0 + offsetY, x0 + offsetX + x1, y0 + offsetY + y1, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto realColor = colorLookup[virtualPalette[color]];
         // DrawRectangle(x0, y0, x0 + x1, y0 + y1, realColor);
 
@@ -226,6 +457,16 @@ lightEffects()  {
 
     void Canvas::drawFilledRectangleW(const int32_t x, const int32_t y, const int32_t width, const int32_t height,
                                       const uint8_t color) {
+        trackDraw({x + offsetX, y + offsetY, width, height},
+                  drawKey(DrawOp::FilledRectangle, x + offsetX, y + offsetY, width, height, color));
+
+        if (isSoftware()) {
+            rasterizer->filledRect(x + offsetX, y + offsetY, width, height, color);
+            return;
+        }
+
+        endSpriteBatch();
+
         const auto realColor = colorLookup[virtualPalette[color]];
         // DrawRectangle(x, y, width, height, realColor);
 
@@ -236,8 +477,19 @@ lightEffects()  {
     }
 
     void Canvas::drawSprite(int32_t x, int32_t y, bool flipX, bool flipY,
-                            const Spritesheet &spritesheet, uint32_t index) {
+                            const Spritesheet &spritesheet, uint32_t index, uint8_t paletteRow) {
         const auto &sprite = spritesheet.getSprite(index);
+        paletteRow = usePaletteRow(paletteRow);
+
+        trackDraw({x + offsetX, y + offsetY, static_cast<int32_t>(sprite.width), static_cast<int32_t>(sprite.height)},
+                  drawKey(DrawOp::Sprite, x + offsetX, y + offsetY, flipX, flipY,
+                          reinterpret_cast<uintptr_t>(&spritesheet), index, paletteRowKeys[paletteRow],
+                          transparentColor));
+
+        if (isSoftware()) {
+            rasterizer->blit(spritesheet, sprite, x + offsetX, y + offsetY, flipX, flipY, rowRemap(paletteRow));
+            return;
+        }
 
         Rectangle sourceRec = {
             static_cast<float>(sprite.x),
@@ -254,14 +506,16 @@ lightEffects()  {
             static_cast<float>(y + offsetY)
         };
 
-        BeginShaderMode(paletteShader);
-        DrawTexturePro(spritesheet.texture, sourceRec, {position.x, position.y, sourceRec.width, sourceRec.height}, {0, 0}, 0, WHITE);
-        EndShaderMode();
+        // The palette row travels in the vertex color, so differently remapped sprites share one batch
+        beginSpriteBatch();
+        DrawTexturePro(spritesheet.texture, sourceRec, {position.x, position.y, sourceRec.width, sourceRec.height}, {0, 0}, 0,
+                       paletteRowTint(paletteRow));
     }
 
     void Canvas::drawSpriteEx(int32_t x, int32_t y, bool flipX, bool flipY, float scale, float originX, float originY,
-                            const Spritesheet &spritesheet, uint32_t index) {
+                            const Spritesheet &spritesheet, uint32_t index, uint8_t paletteRow) {
         const auto &sprite = spritesheet.getSprite(index);
+        paletteRow = usePaletteRow(paletteRow);
 
         Rectangle sourceRec = {
             static_cast<float>(sprite.x),
@@ -278,6 +532,31 @@ lightEffects()  {
             static_cast<float>(y + offsetY)
         };
 
+        {
+            // Padded by a pixel on each side, the GPU quad may cover a partial pixel at its edges
+            const auto destWidth = static_cast<int32_t>(std::ceil(sprite.width * scale));
+            const auto destHeight = static_cast<int32_t>(std::ceil(sprite.height * scale));
+            const auto left = static_cast<int32_t>(position.x - std::round(std::abs(originX * sprite.width * scale)));
+            const auto top = static_cast<int32_t>(position.y - std::round(std::abs(originY * sprite.height * scale)));
+
+            trackDraw({left - 1, top - 1, destWidth + 2, destHeight + 2},
+                      drawKey(DrawOp::SpriteEx, x + offsetX, y + offsetY, flipX, flipY, std::bit_cast<uint32_t>(scale),
+                              std::bit_cast<uint32_t>(originX), std::bit_cast<uint32_t>(originY),
+                              reinterpret_cast<uintptr_t>(&spritesheet), index, paletteRowKeys[paletteRow],
+                              transparentColor));
+        }
+
+        if (isSoftware()) {
+            const auto destWidth = static_cast<int32_t>(std::lround(sprite.width * scale));
+            const auto destHeight = static_cast<int32_t>(std::lround(sprite.height * scale));
+            const auto left = static_cast<int32_t>(position.x - std::round(std::abs(originX * destWidth)));
+            const auto top = static_cast<int32_t>(position.y - std::round(std::abs(originY * destHeight)));
+
+            rasterizer->blitScaled(spritesheet, sprite, {left, top, destWidth, destHeight}, flipX, flipY,
+                                   rowRemap(paletteRow));
+            return;
+        }
+
         // Vector2 origin = {originX, originY};
         Rectangle destRect = {position.x, position.y, sourceRec.width * scale, sourceRec.height * scale};
         Vector2 origin = {abs(originX * destRect.width), abs(originY * destRect.height)};
@@ -293,92 +572,553 @@ lightEffects()  {
         // std::cout << "destRect: " << destRect.x << ", " << destRect.y << ", " << destRect.width << ", " << destRect.height << std::endl;
         // std::cout << "origin: " << origin.x << ", " << origin.y << std::endl;
 
-        BeginShaderMode(paletteShader);
-        DrawTexturePro(spritesheet.texture, sourceRec, destRect, origin, 0, WHITE);
-        EndShaderMode();
+        beginSpriteBatch();
+        DrawTexturePro(spritesheet.texture, sourceRec, destRect, origin, 0, paletteRowTint(paletteRow));
+    }
+
+    uint8_t Canvas::textColorRow(const uint8_t color) {
+        if (textColorRows[color] >= 0) {
+            return usePaletteRow(static_cast<uint8_t>(textColorRows[color]));
+        }
+
+        // Glyphs are drawn in index 0xef; a palette row maps it onto the requested color
+        std::array<uint8_t, 256> remap{};
+        for (int i = 0; i < 256; ++i) {
+            remap[i] = static_cast<uint8_t>(i);
+        }
+        remap[0xef] = color;
+
+        const auto row = getPaletteRow(remap);
+        textColorRows[color] = row;
+        return row;
     }
 
     void Canvas::drawText(const Font &font, const std::wstring &text, int32_t x, int32_t y,
                           std::optional<uint8_t> color) {
-        const auto colorValue = color.value_or(0xef);
-        const auto newColorIndex = virtualPalette[colorValue];
-        const auto oldColor = virtualPalette[0xef];
+        const auto &run = font.getCachedTextRun(text);
+        if (run.glyphs.empty()) {
+            return;
+        }
 
-        const auto glyphIndexes = font.getTextRun(text);
+        const auto row = textColorRow(color.value_or(0xef));
+        const auto glyphWidth = static_cast<int32_t>(font.glyphSize.width);
 
-        const auto oldTransparentColor = transparentColor;
-        virtualPalette[0xef] = newColorIndex;
-        transparentColor = 0xff;
-        setPalette(virtualPalette, colorLookup);
+        trackDraw({x + offsetX, y + offsetY, static_cast<int32_t>(run.width),
+                   static_cast<int32_t>(font.glyphSize.height)},
+                  drawKey(DrawOp::Text, x + offsetX, y + offsetY, reinterpret_cast<uintptr_t>(&font),
+                          std::hash<std::wstring>{}(text), paletteRowKeys[row]));
 
-        for (size_t i = 0; i < glyphIndexes.size(); i++) {
-            const auto x1 = static_cast<int32_t>(i * font.glyphSize.width) + x;
-            drawSprite(x1, y, false, false, font.spritesheet, glyphIndexes[i]);
+        if (isSoftware()) {
+            rasterizer->setTransparentIndex(0xff);
+
+            for (size_t i = 0; i < run.glyphs.size(); i++) {
+                const auto &sprite = font.spritesheet.getSprite(run.glyphs[i]);
+                rasterizer->blit(font.spritesheet, sprite, x + offsetX + static_cast<int32_t>(i) * glyphWidth,
+                                 y + offsetY, false, false, rowRemap(row));
+            }
+
+            rasterizer->setTransparentIndex(transparentColor);
+            return;
+        }
+
+        // Whole run as one textured quad list, skipping the per-sprite DrawTexturePro setup
+        const auto &texture = font.spritesheet.texture;
+        const auto textureWidth = static_cast<float>(texture.width);
+        const auto textureHeight = static_cast<float>(texture.height);
+        const auto tint = paletteRowTint(row);
+
+        constexpr size_t GLYPHS_PER_CHUNK = 1024;
+
+        for (size_t first = 0; first < run.glyphs.size(); first += GLYPHS_PER_CHUNK) {
+            const auto last = std::min(run.glyphs.size(), first + GLYPHS_PER_CHUNK);
+
+            // Make room up front: a flush in the middle of the quads would drop the palette sampler
+            rlCheckRenderBatchLimit(static_cast<int>(4 * (last - first)));
+            beginSpriteBatch();
+
+            rlSetTexture(texture.id);
+            rlBegin(RL_QUADS);
+            rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+
+            for (size_t i = first; i < last; i++) {
+                const auto &sprite = font.spritesheet.getSprite(run.glyphs[i]);
+
+                const auto left = static_cast<float>(x + offsetX + static_cast<int32_t>(i) * glyphWidth);
+                const auto top = static_cast<float>(y + offsetY);
+                const auto right = left + static_cast<float>(sprite.width);
+                const auto bottom = top + static_cast<float>(sprite.height);
+
+                const auto u0 = static_cast<float>(sprite.x) / textureWidth;
+                const auto v0 = static_cast<float>(sprite.y) / textureHeight;
+                const auto u1 = static_cast<float>(sprite.x + sprite.width) / textureWidth;
+                const auto v1 = static_cast<float>(sprite.y + sprite.height) / textureHeight;
+
+                rlTexCoord2f(u0, v0);
+                rlVertex2f(left, top);
+                rlTexCoord2f(u0, v1);
+                rlVertex2f(left, bottom);
+                rlTexCoord2f(u1, v1);
+                rlVertex2f(right, bottom);
+                rlTexCoord2f(u1, v0);
+                rlVertex2f(right, top);
+            }
+
+            rlEnd();
+            rlSetTexture(0);
+        }
+    }
+
+    void Canvas::setFrameTarget(const RenderTexture2D &target) {
+        frameTarget = &target;
+    }
+
+    bool Canvas::beginLayer(const uint32_t layer, Rect bounds) {
+        if (recordingLayer.has_value()) {
+            throw std::runtime_error("Layers cannot be nested");
+        }
+
+        if (bounds.width <= 0 || bounds.height <= 0) {
+            bounds = {0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)};
+        }
+
+        auto &cached = layers[layer];
+        const auto resized = cached.bounds.width != bounds.width || cached.bounds.height != bounds.height;
+
+        if (resized || cached.bounds.x != bounds.x || cached.bounds.y != bounds.y) {
+            cached.valid = false;
+        }
+        cached.bounds = bounds;
+
+        if (cached.valid) {
+            return false;
         }
 
-        virtualPalette[0xef] = oldColor;
-        transparentColor = oldTransparentColor;
-        setPalette(virtualPalette, colorLookup);
+        // Layer content is drawn relative to its own top-left corner, unclipped
+        savedOffsetX = offsetX;
+        savedOffsetY = offsetY;
+        savedClipRect = clipRect;
+        offsetX = -bounds.x;
+        offsetY = -bounds.y;
+        clipRect = {0, 0, 0, 0};
+
+        if (isSoftware()) {
+            cached.pixels.assign(static_cast<size_t>(bounds.width) * bounds.height, transparentColor);
+            rasterizer->setTarget(cached.pixels.data(), bounds.width, bounds.height);
+        } else {
+            endSpriteBatch();
+
+            if (resized || cached.target.id == 0) {
+                if (cached.target.id != 0) {
+                    UnloadRenderTexture(cached.target);
+                }
+                cached.target = LoadRenderTexture(bounds.width, bounds.height);
+            }
+
+            BeginTextureMode(cached.target);
+            ClearBackground(BLANK);
+        }
+
+        recordingLayer = layer;
+        return true;
+    }
+
+    void Canvas::endLayer() {
+        if (!recordingLayer.has_value()) {
+            return;
+        }
+
+        auto &cached = layers[*recordingLayer];
+        cached.valid = true;
+        ++cached.version;
+        recordingLayer.reset();
+
+        offsetX = savedOffsetX;
+        offsetY = savedOffsetY;
+        clipRect = savedClipRect;
+
+        if (isSoftware()) {
+            rasterizer->setTarget(pixels.data(), width, height);
+            rasterizer->setClipRect(clipRect);
+            return;
+        }
+
+        endSpriteBatch();
+        EndTextureMode();
+
+        // raylib unbinds to the screen, not the previous target
+        if (frameTarget) {
+            BeginTextureMode(*frameTarget);
+        }
+    }
+
+    void Canvas::drawLayer(const uint32_t layer) {
+        const auto it = layers.find(layer);
+        if (it == layers.end() || !it->second.valid) {
+            return;
+        }
+
+        const auto &cached = it->second;
+        const auto x = cached.bounds.x + offsetX;
+        const auto y = cached.bounds.y + offsetY;
+
+        trackDraw({x, y, cached.bounds.width, cached.bounds.height},
+                  drawKey(DrawOp::Layer, x, y, layer, cached.version, transparentColor));
+
+        if (isSoftware()) {
+            rasterizer->blitBuffer(cached.pixels.data(), cached.bounds.width, cached.bounds.height, x, y);
+            return;
+        }
+
+        endSpriteBatch();
+
+        // Render textures are stored bottom-up
+        const Rectangle sourceRec = {
+            0, 0, static_cast<float>(cached.bounds.width), -static_cast<float>(cached.bounds.height)
+        };
+        DrawTextureRec(cached.target.texture, sourceRec, {static_cast<float>(x), static_cast<float>(y)}, WHITE);
+    }
+
+    void Canvas::invalidateLayer(const uint32_t layer) {
+        if (const auto it = layers.find(layer); it != layers.end()) {
+            it->second.valid = false;
+        }
+    }
+
+    void Canvas::invalidateLayers() {
+        for (auto &[id, layer]: layers) {
+            layer.valid = false;
+        }
+    }
+
+    void Canvas::trackDraw(const Rect &rect, const uint64_t key) {
+        // Nothing reads the tiles without partial redraw, and enabling it redraws everything once. Layer content
+        // only reaches the screen through drawLayer.
+        if (partialRedraw && !recordingLayer.has_value()) {
+            dirtyRects.record(rect, key);
+        }
+    }
+
+    Rect Canvas::circleBounds(const int32_t centerX, const int32_t centerY, const uint32_t radius) const {
+        const auto r = static_cast<int32_t>(radius);
+        return {centerX + offsetX - r - 1, centerY + offsetY - r - 1, 2 * r + 3, 2 * r + 3};
+    }
+
+    void Canvas::endFrame() {
+        if (!partialRedraw) {
+            return;
+        }
+
+        // Light masks cover the whole frame
+        for (const auto &effect: lightEffects) {
+            dirtyRects.record({0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)},
+                              drawKey(DrawOp::Lighting, effect.tintColor.r, effect.tintColor.g, effect.tintColor.b,
+                                      effect.tintColor.a, std::bit_cast<uint32_t>(effect.opacity),
+                                      effect.maskTexture.id));
+        }
+
+        dirtyRects.endFrame();
+    }
+
+    const DirtyRectTracker &Canvas::getDirtyRects() const {
+        return dirtyRects;
+    }
+
+    void Canvas::setPartialRedraw(const bool enabled) {
+        if (enabled != partialRedraw) {
+            dirtyRects.invalidate();
+        }
+        partialRedraw = enabled;
+    }
+
+    bool Canvas::isPartialRedraw() const {
+        return partialRedraw;
+    }
+
+    void Canvas::invalidate() {
+        dirtyRects.invalidate();
+    }
+
+    std::ptrdiff_t Canvas::findLight(const std::string &name) const {
+        const auto it = std::find(lightNames.begin(), lightNames.end(), name);
+        return it == lightNames.end() ? -1 : it - lightNames.begin();
     }
 
     void Canvas::addLightEffect(const std::string &name, const LightEffect &effect) {
-        lightEffects[name] = effect;
+        if (const auto index = findLight(name); index >= 0) {
+            lightEffects[index] = effect;
+        } else {
+            lightNames.push_back(name);
+            lightEffects.push_back(effect);
+        }
+
+        lightMasksDirty = true;
     }
 
     void Canvas::removeLightEffect(const std::string &name) {
-        lightEffects.erase(name);
+        if (const auto index = findLight(name); index >= 0) {
+            lightNames.erase(lightNames.begin() + index);
+            lightEffects.erase(lightEffects.begin() + index);
+            lightMasksDirty = true;
+        }
     }
 
     void Canvas::updateLightEffect(const std::string &name, const LightEffect &effect) {
-        if (lightEffects.contains(name)) {
-            lightEffects[name] = effect;
+        if (const auto index = findLight(name); index >= 0) {
+            lightMasksDirty |= lightEffects[index].maskTexture.id != effect.maskTexture.id;
+            lightEffects[index] = effect;
         }
     }
 
     LightEffect Canvas::getLightEffect(const std::string &name) {
-        if (lightEffects.contains(name)) {
-            return lightEffects[name];
+        if (const auto index = findLight(name); index >= 0) {
+            return lightEffects[index];
         }
 
         throw std::runtime_error("Light effect not found");
     }
 
     void Canvas::setLightTintColor(const std::string &name, const Color &color) {
-        auto it = lightEffects.find(name);
-        if (it != lightEffects.end()) {
-            it->second.tintColor = color;
+        if (const auto index = findLight(name); index >= 0) {
+            lightEffects[index].tintColor = color;
         }
     }
 
     void Canvas::setLightOpacity(const std::string &name, float opacity) {
-        auto it = lightEffects.find(name);
-        if (it != lightEffects.end()) {
-            it->second.opacity = opacity;
+        if (const auto index = findLight(name); index >= 0) {
+            lightEffects[index].opacity = opacity;
         }
     }
 
-    void Canvas::applyLighting(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture) {
-        BeginTextureMode(renderTexture);
-        BeginShaderMode(lightingShader);
-        for (const auto &[name, effect] : lightEffects) {
-            auto color = effect.tintColor;
-            auto glColor = (Vector4){color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
-
-            SetShaderValue(lightingShader, tintColorLoc, &glColor, SHADER_UNIFORM_VEC4);
-            SetShaderValue(lightingShader, opacityLoc, &effect.opacity, SHADER_UNIFORM_FLOAT);
+    void Canvas::rebuildLightMaskAtlas() {
+        lightMasksDirty = false;
+
+        // Slots come in whole passes so the atlas is only reallocated when a pass is added or dropped
+        const auto lightCount = static_cast<uint32_t>(lightEffects.size());
+        const auto slots = (lightCount + MAX_LIGHTS_PER_PASS - 1) / MAX_LIGHTS_PER_PASS * MAX_LIGHTS_PER_PASS;
+
+        if (slots != lightMaskSlots) {
+            if (lightMaskAtlas.id != 0) {
+                UnloadRenderTexture(lightMaskAtlas);
+                lightMaskAtlas = {};
+            }
+            if (slots > 0) {
+                lightMaskRows = std::clamp(MAX_LIGHT_ATLAS_SIZE / std::max(1u, height), 1u, slots);
+                lightMaskColumns = (slots + lightMaskRows - 1) / lightMaskRows;
+
+                const auto slotWidth = std::max(1u, std::min(width, MAX_LIGHT_ATLAS_SIZE / lightMaskColumns));
+                const auto slotHeight = std::max(1u, std::min(height, MAX_LIGHT_ATLAS_SIZE / lightMaskRows));
+                lightMaskAtlas = LoadRenderTexture(static_cast<int>(slotWidth * lightMaskColumns),
+                                                   static_cast<int>(slotHeight * lightMaskRows));
+            }
+            lightMaskSlots = slots;
+        }
 
-            SetShaderValueTexture(lightingShader, baseTextureLoc, baseTexture.texture);
-            SetShaderValueTexture(lightingShader, maskTextureLoc, effect.maskTexture);
+        if (slots == 0) {
+            return;
+        }
 
-            DrawTextureEx(renderTexture.texture, (Vector2){0, 0}, 0.0f, 1.0f, WHITE);
+        const auto slotWidth = static_cast<float>(lightMaskAtlas.texture.width / lightMaskColumns);
+        const auto slotHeight = static_cast<float>(lightMaskAtlas.texture.height / lightMaskRows);
+
+        BeginTextureMode(lightMaskAtlas);
+        ClearBackground(BLACK);
+
+        for (uint32_t slot = 0; slot < lightCount; ++slot) {
+            const auto &mask = lightEffects[slot].maskTexture;
+            const auto column = slot / lightMaskRows;
+            const auto row = slot % lightMaskRows;
+
+            // Drawn flipped with rows counted from the bottom, so the slot spans texture (u, v) in
+            // [column, column + 1) / columns x [row, row + 1) / rows with the mask oriented exactly as when it is
+            // sampled on its own
+            const Rectangle sourceRec = {0, 0, static_cast<float>(mask.width), -static_cast<float>(mask.height)};
+            const Rectangle destRec = {
+                static_cast<float>(column) * slotWidth, static_cast<float>(lightMaskRows - 1 - row) * slotHeight,
+                slotWidth, slotHeight
+            };
+            DrawTexturePro(mask, sourceRec, destRec, {0, 0}, 0, WHITE);
         }
 
-        // If there are no light effects, just draw the base texture
-        if (lightEffects.empty()) {
+        EndTextureMode();
+    }
+
+    void Canvas::applyLighting(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture,
+                               const std::optional<Rect> &region) {
+        flush();
+
+        if (isSoftware()) {
+            // Light masks are GPU textures; the software frame is composited without them
+            BeginTextureMode(renderTexture);
+            if (region) BeginScissorMode(region->x, region->y, region->width, region->height);
             DrawTextureEx(baseTexture.texture, (Vector2){0, 0}, 0.0f, 1.0f, WHITE);
+            if (region) EndScissorMode();
+            EndTextureMode();
+            return;
         }
 
-        EndShaderMode();
-        EndTextureMode();
+        if (lightMasksDirty) {
+            rebuildLightMaskAtlas();
+        }
+
+        // One pass per MAX_LIGHTS_PER_PASS lights, each reading the previous one's output. Passes alternate
+        // between the two targets, ending on renderTexture.
+        const auto lightCount = static_cast<uint32_t>(lightEffects.size());
+        const auto passes = std::max(1u, (lightCount + MAX_LIGHTS_PER_PASS - 1) / MAX_LIGHTS_PER_PASS);
+        const auto *source = &baseTexture;
+
+        for (uint32_t pass = 0; pass < passes; ++pass) {
+            const auto &target = (passes - 1 - pass) % 2 == 0 ? renderTexture : lightingRender;
+
+            const auto first = pass * MAX_LIGHTS_PER_PASS;
+            const auto remaining = lightCount - std::min(lightCount, first);
+            const auto count = static_cast<int>(std::min(MAX_LIGHTS_PER_PASS, remaining));
+
+            std::array<Vector4, MAX_LIGHTS_PER_PASS> tints{};
+            std::array<float, MAX_LIGHTS_PER_PASS> opacities{};
+            for (int i = 0; i < count; ++i) {
+                const auto &effect = lightEffects[first + i];
+                const auto color = effect.tintColor;
+                tints[i] = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+                opacities[i] = effect.opacity;
+            }
+
+            const auto firstMask = static_cast<int>(first);
+            const int maskGrid[2] = {static_cast<int>(lightMaskColumns), static_cast<int>(lightMaskRows)};
+            // Later passes read a render texture drawn the right way up, so their coordinates run the other way
+            const int flipMask = pass > 0;
+
+            BeginTextureMode(target);
+            if (region) BeginScissorMode(region->x, region->y, region->width, region->height);
+            BeginShaderMode(lightingShader);
+
+            SetShaderValueV(lightingShader, lightTintsLoc, tints.data(), SHADER_UNIFORM_VEC4, MAX_LIGHTS_PER_PASS);
+            SetShaderValueV(lightingShader, lightOpacitiesLoc, opacities.data(), SHADER_UNIFORM_FLOAT,
+                            MAX_LIGHTS_PER_PASS);
+            SetShaderValue(lightingShader, lightCountLoc, &count, SHADER_UNIFORM_INT);
+            SetShaderValue(lightingShader, firstMaskLoc, &firstMask, SHADER_UNIFORM_INT);
+            SetShaderValue(lightingShader, maskGridLoc, maskGrid, SHADER_UNIFORM_IVEC2);
+            SetShaderValue(lightingShader, flipMaskLoc, &flipMask, SHADER_UNIFORM_INT);
+            SetShaderValueTexture(lightingShader, baseTextureLoc, source->texture);
+            if (count > 0) {
+                SetShaderValueTexture(lightingShader, maskAtlasLoc, lightMaskAtlas.texture);
+            }
+
+            // The first pass flips the frame like a plain DrawTextureEx does; later passes keep the orientation
+            // of the pass before, as Postprocessing::runEffect does inside a chain
+            const auto sourceWidth = static_cast<float>(source->texture.width);
+            const auto sourceHeight = static_cast<float>(source->texture.height);
+            DrawTextureRec(source->texture, {0, 0, sourceWidth, pass > 0 ? -sourceHeight : sourceHeight}, {0, 0},
+                           WHITE);
+
+            EndShaderMode();
+            if (region) EndScissorMode();
+            EndTextureMode();
+
+            source = &target;
+        }
+    }
+
+    CanvasBackend Canvas::getBackend() const {
+        return backend;
+    }
+
+    uint8_t Canvas::usePaletteRow(const uint8_t paletteRow) {
+        if (paletteRow >= paletteRemaps.size()) {
+            return 0;
+        }
+
+        paletteRowUses[paletteRow] = ++paletteRowClock;
+        return paletteRow;
+    }
+
+    uint8_t Canvas::recyclePaletteRow() {
+        // Row 0 is the plain palette and never recycled
+        uint8_t row = 1;
+        for (uint32_t candidate = 2; candidate < paletteRowUses.size(); ++candidate) {
+            if (paletteRowUses[candidate] < paletteRowUses[row]) {
+                row = static_cast<uint8_t>(candidate);
+            }
+        }
+
+        // Pending sprites must land before their row changes
+        endSpriteBatch();
+
+        if (const auto it = paletteRows.find(paletteRowKeys[row]); it != paletteRows.end() && it->second == row) {
+            paletteRows.erase(it);
+        }
+
+        for (auto &textRow: textColorRows) {
+            if (textRow == row) {
+                textRow = -1;
+            }
+        }
+
+        return row;
+    }
+
+    const std::array<uint8_t, 256> *Canvas::rowRemap(const uint8_t paletteRow) const {
+        return paletteRow != 0 && paletteRow < paletteRemaps.size() ? &paletteRemaps[paletteRow] : nullptr;
+    }
+
+    Color Canvas::paletteRowTint(const uint8_t paletteRow) {
+        return Color{paletteRow, 0, 0, 255};
+    }
+
+    bool Canvas::isSoftware() const {
+        return backend == CanvasBackend::Software;
+    }
+
+    const std::vector<uint8_t> &Canvas::getPixels() const {
+        return pixels;
+    }
+
+    std::array<Color, 256> Canvas::resolvedPalette() const {
+        // Fold the virtual palette into the lookup once, then it is a single table read per pixel
+        std::array<Color, 256> resolved;
+        for (int i = 0; i < 256; ++i) {
+            resolved[i] = colorLookup[virtualPalette[i]];
+        }
+
+        // Whatever is left at the transparent index shows through
+        resolved[transparentColor] = Color{0, 0, 0, 0};
+
+        return resolved;
+    }
+
+    const std::vector<Color> &Canvas::resolve() {
+        resolvedPixels.resize(pixels.size());
+        resolver->resolve(pixels.data(), resolvedPixels.data(), width, height, resolvedPalette());
+
+        return resolvedPixels;
+    }
+
+    void Canvas::present(const RenderTexture2D &target) {
+        presentPixels.resize(pixels.size());
+        const auto palette = resolvedPalette();
+
+        if (!partialRedraw || dirtyRects.isFullyDirty()) {
+            // Render textures are stored bottom-up, so rows are resolved straight into flipped order
+            resolver->resolve(pixels.data(), presentPixels.data(), width, height, palette, true);
+            UpdateTexture(target.texture, presentPixels.data());
+            return;
+        }
+
+        // Only the tiles that changed are resolved and uploaded; the texture keeps the rest from earlier frames
+        for (const auto &rect: dirtyRects.getDirtyRects()) {
+            const auto rectWidth = static_cast<size_t>(rect.width);
+
+            for (int32_t row = 0; row < rect.height; ++row) {
+                const auto sourceRow = static_cast<size_t>(rect.y + rect.height - 1 - row);
+                PaletteResolver::resolveSpan(pixels.data() + sourceRow * width + rect.x,
+                                             presentPixels.data() + row * rectWidth, rectWidth, palette);
+            }
+
+            const Rectangle textureRect = {
+                static_cast<float>(rect.x), static_cast<float>(height - rect.y - rect.height),
+                static_cast<float>(rect.width), static_cast<float>(rect.height)
+            };
+            UpdateTextureRec(target.texture, textureRect, presentPixels.data());
+        }
     }
 }
@@ -1,11 +1,16 @@
 #ifndef CANVAS_H
 #define CANVAS_H
 #include <cstdint>
+#include <optional>
 #include <palette685.h>
+#include <unordered_map>
 #include <vector>
 
+#include "dirtyrects.h"
 #include "font.h"
 #include "graphics_types.h"
+#include "paletteresolver.h"
+#include "rasterizer.h"
 #include "spritesheet.h"
 
 namespace blipcade::graphics {
@@ -17,9 +22,20 @@ namespace blipcade::graphics {
         Texture2D maskTexture;  // Mask texture defining the shape/pattern
     };
 
+    // Offscreen copy of rarely changing content, drawn in world space and composited at the camera offset
+    struct CachedLayer {
+        Rect bounds;
+        bool valid = false;
+
+        RenderTexture2D target{};      // Gpu backend, palette already resolved
+        std::vector<uint8_t> pixels;   // Software backend, indexed
+
+        uint32_t version = 0;          // Bumped on every recording, so composites of new content read as changes
+    };
+
     class Canvas {
     public:
-        Canvas(uint32_t width, uint32_t height);
+        Canvas(uint32_t width, uint32_t height, CanvasBackend backend = CanvasBackend::Gpu);
 
         ~Canvas();
 
@@ -35,7 +51,7 @@ namespace blipcade::graphics {
 
         void drawPixel(int32_t x, int32_t y, uint8_t color);
 
-        void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t color) const;
+        void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t color);
 
         void drawCircle(int32_t center_x, int32_t center_y, uint32_t radius, uint8_t color);
 
@@ -49,17 +65,59 @@ namespace blipcade::graphics {
 
         void drawFilledRectangleW(int32_t x, int32_t y, int32_t width, int32_t height, uint8_t color);
 
+        // `paletteRow` selects a remapped palette from getPaletteRow; 0 is the plain palette, as is any row that was
+        // never handed out
         void drawSprite(int32_t x, int32_t y, bool flipX, bool flipY,
                         const Spritesheet &spritesheet,
-                        uint32_t index);
+                        uint32_t index, uint8_t paletteRow = 0);
 
         void drawSpriteEx(int32_t x, int32_t y, bool flipX, bool flipY, float scale,
-                          float originX, float originY, const Spritesheet &spritesheet, uint32_t index);
+                          float originX, float originY, const Spritesheet &spritesheet, uint32_t index,
+                          uint8_t paletteRow = 0);
 
         void drawText(const Font &font, const std::wstring &text, int32_t x, int32_t y, std::optional<uint8_t> color);
 
         void clear();
 
+        // Row of the palette atlas holding the current palette seen through `remap` (source index -> palette index).
+        // Rows are shared by identical remaps. Once all PALETTE_ROWS are taken, the least recently drawn or requested
+        // row is recycled.
+        uint8_t getPaletteRow(const std::array<uint8_t, 256> &remap);
+
+        // Closes the open sprite batch; call before anything else draws into the same target
+        void flush();
+
+        // Render texture the frame is being drawn into, re-bound after recording a layer on the GPU backend
+        void setFrameTarget(const RenderTexture2D &target);
+
+        // Starts recording `layer`, covering `bounds` in world space (zero size: the canvas size at 0, 0).
+        // Returns false, recording nothing, while the layer still holds valid content from an earlier frame;
+        // otherwise draws go into the layer until endLayer. Layers do not nest.
+        bool beginLayer(uint32_t layer, Rect bounds);
+
+        void endLayer();
+
+        // Composites the layer at the current camera offset
+        void drawLayer(uint32_t layer);
+
+        void invalidateLayer(uint32_t layer);
+
+        void invalidateLayers();
+
+        // Closes dirty-rect tracking for the frame; call once after the frame is drawn
+        void endFrame();
+
+        // What changed in the frame closed by the last endFrame; only tracked under partial redraw
+        [[nodiscard]] const DirtyRectTracker &getDirtyRects() const;
+
+        // With partial redraw the software backend resolves and uploads only dirty tiles in present()
+        void setPartialRedraw(bool enabled);
+
+        [[nodiscard]] bool isPartialRedraw() const;
+
+        // Redraws the whole next frame, for changes made outside the canvas such as the postprocessing shader
+        void invalidate();
+
         void setCamera(int32_t offsetX, int32_t offsetY);
 
         void addLightEffect(const std::string &name, const LightEffect &effect);
@@ -72,12 +130,28 @@ namespace blipcade::graphics {
 
         void setLightOpacity(const std::string &name, float opacity);
 
-        void applyLighting(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture);
+        // `region` limits the pass to part of the frame, e.g. the dirty bounds under partial redraw
+        void applyLighting(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture,
+                           const std::optional<Rect> &region = std::nullopt);
+
+        [[nodiscard]] CanvasBackend getBackend() const;
+
+        // Indexed framebuffer written by the software backend
+        [[nodiscard]] const std::vector<uint8_t> &getPixels() const;
+
+        // Maps the indexed framebuffer through the current palette; the transparent index resolves to alpha 0.
+        // Software backend, once per frame.
+        const std::vector<Color> &resolve();
+
+        // Resolves and uploads the frame into a render texture, for showing the software backend in a window
+        void present(const RenderTexture2D &target);
 
     private:
         uint32_t width = 0;
         uint32_t height = 0;
 
+        CanvasBackend backend;
+
         std::array<Color, 256> colorLookup;
         std::vector<uint8_t> pixels;
         std::array<uint8_t, 256> virtualPalette{};
@@ -86,29 +160,107 @@ namespace blipcade::graphics {
         int32_t offsetX = 0;
         int32_t offsetY = 0;
 
-        uint8_t transparentColor = 0;
+        uint8_t transparentColor = 255;
 
         Rect clipRect = {0, 0, 0, 0};
 
         Shader paletteShader;
         int paletteLoc;
 
+        // 256 x PALETTE_ROWS atlas sampled by paletteShader, one remapped palette per row
+        static constexpr uint32_t PALETTE_ROWS = 64;
         Texture2D paletteTexture;
+        std::vector<std::array<uint8_t, 256> > paletteRemaps;
+        std::unordered_map<uint64_t, uint8_t> paletteRows;
+        std::vector<uint64_t> paletteRowKeys;
+        // Last use of each row, from paletteRowClock, to pick the row to recycle
+        std::vector<uint64_t> paletteRowUses;
+        uint64_t paletteRowClock = 0;
+
+        bool spriteBatchActive = false;
+
+        // Palette row per text color, -1 until first used or after its row is recycled
+        std::array<int16_t, 256> textColorRows;
+
+        // Lighting overlay, composed MAX_LIGHTS_PER_PASS lights per full-screen pass
+        static constexpr uint32_t MAX_LIGHTS_PER_PASS = 8;
 
-        // Lighting overlay
         RenderTexture2D lightingRender;
         Shader lightingShader;
 
-        int tintColorLoc;
-        int opacityLoc;
+        int lightTintsLoc;
+        int lightOpacitiesLoc;
+        int lightCountLoc;
         int baseTextureLoc;
-        int maskTextureLoc;
+        int maskAtlasLoc;
+        int maskGridLoc;
+        int firstMaskLoc;
+        int flipMaskLoc;
+
+        // Insertion ordered; lights are few and walked every frame, so lookups by name are linear
+        std::vector<std::string> lightNames;
+        std::vector<LightEffect> lightEffects;
+
+        // Every light's mask scaled to one slot of a grid, slot i holding light i. Slots fill a column before
+        // starting the next, and shrink below the canvas size only when the grid would pass MAX_LIGHT_ATLAS_SIZE,
+        // the largest texture GLES 2 / WebGL devices reliably allocate.
+        static constexpr uint32_t MAX_LIGHT_ATLAS_SIZE = 4096;
+
+        RenderTexture2D lightMaskAtlas{};
+        uint32_t lightMaskSlots = 0;
+        uint32_t lightMaskColumns = 1;
+        uint32_t lightMaskRows = 1;
+        bool lightMasksDirty = false;
+
+        // Cached layers
+        std::unordered_map<uint32_t, CachedLayer> layers;
+        std::optional<uint32_t> recordingLayer;
+        const RenderTexture2D *frameTarget = nullptr;
+        int32_t savedOffsetX = 0;
+        int32_t savedOffsetY = 0;
+        Rect savedClipRect = {0, 0, 0, 0};
+
+        DirtyRectTracker dirtyRects;
+        bool partialRedraw = false;
+
+        // Software backend only
+        std::unique_ptr<IndexedRasterizer> rasterizer;
+        std::unique_ptr<PaletteResolver> resolver;
+        std::vector<Color> resolvedPixels;
+        std::vector<Color> presentPixels;
+
+        [[nodiscard]] std::array<Color, 256> resolvedPalette() const;
+
+        [[nodiscard]] bool isSoftware() const;
 
-        std::unordered_map<std::string, LightEffect> lightEffects;
+        void createPaletteTexture();
 
-        void updateShaderPalette();
+        static uint64_t hashRemap(const std::array<uint8_t, 256> &remap);
 
-        void createPaletteTexture();
+        void fillPaletteRow(uint8_t row, Color *out) const;
+
+        [[nodiscard]] const std::array<uint8_t, 256> *rowRemap(uint8_t paletteRow) const;
+
+        // Marks a row as just used; rows not handed out yet become 0 so both backends draw them the same
+        uint8_t usePaletteRow(uint8_t paletteRow);
+
+        uint8_t recyclePaletteRow();
+
+        static Color paletteRowTint(uint8_t paletteRow);
+
+        uint8_t textColorRow(uint8_t color);
+
+        [[nodiscard]] std::ptrdiff_t findLight(const std::string &name) const;
+
+        void rebuildLightMaskAtlas();
+
+        void trackDraw(const Rect &rect, uint64_t key);
+
+        [[nodiscard]] Rect circleBounds(int32_t centerX, int32_t centerY, uint32_t radius) const;
+
+        void beginSpriteBatch();
+
+        void endSpriteBatch();
 
         void updatePaletteTexture();
 
@@ -0,0 +1,44 @@
+// cpufeatures.cpp
+
+#include "cpufeatures.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace blipcade::graphics {
+    namespace {
+        std::atomic<SimdLevel> limit{SimdLevel::Avx2};
+
+        SimdLevel detect() {
+#if defined(BLIPCADE_AVX2_DISPATCH)
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::Avx2;
+            }
+#endif
+
+#if defined(__SSE2__)
+            return SimdLevel::Sse2;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+    }
+
+    SimdLevel simdLevel() {
+        static const auto detected = detect();
+        return std::min(detected, limit.load(std::memory_order_relaxed));
+    }
+
+    void setSimdLimit(const SimdLevel level) {
+        limit.store(level, std::memory_order_relaxed);
+    }
+
+    const char *simdLevelName(const SimdLevel level) {
+        switch (level) {
+            case SimdLevel::Avx2: return "avx2";
+            case SimdLevel::Sse2: return "sse2";
+            default: return "scalar";
+        }
+    }
+} // graphics
+// blipcade
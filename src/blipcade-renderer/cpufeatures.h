@@ -0,0 +1,30 @@
+// cpufeatures.h
+
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+// x86 builds only assume SSE2. AVX2 kernels are compiled per function with a target attribute and picked at run time,
+// so one binary uses them where the CPU has them without raising the baseline for everyone else.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLIPCADE_AVX2_DISPATCH 1
+#define BLIPCADE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace blipcade::graphics {
+    enum class SimdLevel {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    // Best level both the build and the CPU support, capped by setSimdLimit
+    SimdLevel simdLevel();
+
+    // Lets tools time every kernel on one machine; kernels never go above the limit
+    void setSimdLimit(SimdLevel limit);
+
+    const char *simdLevelName(SimdLevel level);
+} // graphics
+// blipcade
+
+#endif // CPUFEATURES_H
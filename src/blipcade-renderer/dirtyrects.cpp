@@ -0,0 +1,131 @@
+// dirtyrects.cpp
+
+#include "dirtyrects.h"
+
+#include <algorithm>
+
+namespace blipcade::graphics {
+    namespace {
+        // Order dependent, so drawing the same things in a different order still reads as a change
+        uint64_t foldKey(const uint64_t tile, const uint64_t key) {
+            auto hash = (tile ^ key) * 0x9e3779b97f4a7c15ull;
+            return hash ^ (hash >> 29);
+        }
+    }
+
+    DirtyRectTracker::DirtyRectTracker(const uint32_t width, const uint32_t height): width(width), height(height),
+        columns((width + TILE_SIZE - 1) / TILE_SIZE), rows((height + TILE_SIZE - 1) / TILE_SIZE),
+        currentKeys(static_cast<size_t>(columns) * rows, 0), previousKeys(static_cast<size_t>(columns) * rows, 0),
+        dirtyBounds{0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)} {
+        dirtyRects.push_back(dirtyBounds);
+    }
+
+    void DirtyRectTracker::record(const Rect &rect, const uint64_t key) {
+        const auto left = std::max(rect.x, 0);
+        const auto top = std::max(rect.y, 0);
+        const auto right = std::min(rect.x + rect.width, static_cast<int32_t>(width));
+        const auto bottom = std::min(rect.y + rect.height, static_cast<int32_t>(height));
+
+        if (left >= right || top >= bottom) {
+            return;
+        }
+
+        const auto firstColumn = static_cast<uint32_t>(left) / TILE_SIZE;
+        const auto lastColumn = static_cast<uint32_t>(right - 1) / TILE_SIZE;
+        const auto firstRow = static_cast<uint32_t>(top) / TILE_SIZE;
+        const auto lastRow = static_cast<uint32_t>(bottom - 1) / TILE_SIZE;
+
+        for (auto row = firstRow; row <= lastRow; ++row) {
+            auto *tiles = currentKeys.data() + static_cast<size_t>(row) * columns;
+            for (auto column = firstColumn; column <= lastColumn; ++column) {
+                tiles[column] = foldKey(tiles[column], key);
+            }
+        }
+    }
+
+    void DirtyRectTracker::invalidate() {
+        forceFull = true;
+    }
+
+    void DirtyRectTracker::endFrame() {
+        dirtyRects.clear();
+
+        const auto tileSize = static_cast<int32_t>(TILE_SIZE);
+        size_t dirtyTiles = 0;
+
+        // Runs of dirty tiles per tile row; a run spanning the same columns as a rect ending on the row above
+        // extends that rect downwards
+        for (uint32_t row = 0; row < rows; ++row) {
+            const auto rowOffset = static_cast<size_t>(row) * columns;
+            uint32_t column = 0;
+
+            while (column < columns) {
+                const auto isDirty = [&](const uint32_t c) {
+                    return forceFull || currentKeys[rowOffset + c] != previousKeys[rowOffset + c];
+                };
+
+                if (!isDirty(column)) {
+                    ++column;
+                    continue;
+                }
+
+                const auto start = column;
+                while (column < columns && isDirty(column)) {
+                    ++column;
+                }
+                dirtyTiles += column - start;
+
+                const auto x = static_cast<int32_t>(start) * tileSize;
+                const auto y = static_cast<int32_t>(row) * tileSize;
+                const auto runRight = std::min(static_cast<int32_t>(column) * tileSize, static_cast<int32_t>(width));
+                const auto runWidth = runRight - x;
+                const auto runHeight = std::min(y + tileSize, static_cast<int32_t>(height)) - y;
+
+                const auto above = std::find_if(dirtyRects.begin(), dirtyRects.end(), [&](const Rect &rect) {
+                    return rect.x == x && rect.width == runWidth && rect.y + rect.height == y;
+                });
+
+                if (above != dirtyRects.end()) {
+                    above->height += runHeight;
+                } else {
+                    dirtyRects.push_back({x, y, runWidth, runHeight});
+                }
+            }
+        }
+
+        fullyDirty = dirtyTiles == currentKeys.size();
+
+        dirtyBounds = {0, 0, 0, 0};
+        if (!dirtyRects.empty()) {
+            auto left = static_cast<int32_t>(width), top = static_cast<int32_t>(height), right = 0, bottom = 0;
+            for (const auto &rect: dirtyRects) {
+                left = std::min(left, rect.x);
+                top = std::min(top, rect.y);
+                right = std::max(right, rect.x + rect.width);
+                bottom = std::max(bottom, rect.y + rect.height);
+            }
+            dirtyBounds = {left, top, right - left, bottom - top};
+        }
+
+        std::swap(currentKeys, previousKeys);
+        std::fill(currentKeys.begin(), currentKeys.end(), 0);
+        forceFull = false;
+    }
+
+    bool DirtyRectTracker::isClean() const {
+        return dirtyRects.empty();
+    }
+
+    bool DirtyRectTracker::isFullyDirty() const {
+        return fullyDirty;
+    }
+
+    const std::vector<Rect> &DirtyRectTracker::getDirtyRects() const {
+        return dirtyRects;
+    }
+
+    Rect DirtyRectTracker::getDirtyBounds() const {
+        return dirtyBounds;
+    }
+} // graphics
+// blipcade
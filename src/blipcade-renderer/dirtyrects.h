@@ -0,0 +1,59 @@
+// dirtyrects.h
+
+#ifndef DIRTYRECTS_H
+#define DIRTYRECTS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "graphics_types.h"
+
+namespace blipcade::graphics {
+    // Finds the parts of the screen that changed since the previous frame.
+    // Draw calls are immediate mode and get replayed every frame, so rather than trusting "something was drawn
+    // here", every call folds a key describing it (operation, position, color, source) into each TILE_SIZE tile it
+    // touches. Tiles whose accumulated key differs from the previous frame are dirty; a static screen that is
+    // fully redrawn every frame therefore comes out clean.
+    class DirtyRectTracker {
+    public:
+        static constexpr uint32_t TILE_SIZE = 16;
+
+        DirtyRectTracker(uint32_t width, uint32_t height);
+
+        void record(const Rect &rect, uint64_t key);
+
+        // Marks the whole screen dirty at the next endFrame, for changes draw keys cannot see (e.g. palette swaps)
+        void invalidate();
+
+        // Compares this frame's tiles with the previous frame and starts a new frame
+        void endFrame();
+
+        [[nodiscard]] bool isClean() const;
+
+        [[nodiscard]] bool isFullyDirty() const;
+
+        // Dirty tiles merged into rects, in screen pixels, top to bottom
+        [[nodiscard]] const std::vector<Rect> &getDirtyRects() const;
+
+        // Smallest rect covering every dirty rect
+        [[nodiscard]] Rect getDirtyBounds() const;
+
+    private:
+        uint32_t width;
+        uint32_t height;
+        uint32_t columns;
+        uint32_t rows;
+
+        std::vector<uint64_t> currentKeys;
+        std::vector<uint64_t> previousKeys;
+
+        bool forceFull = true;
+        bool fullyDirty = true;
+
+        std::vector<Rect> dirtyRects;
+        Rect dirtyBounds;
+    };
+} // graphics
+// blipcade
+
+#endif // DIRTYRECTS_H
@@ -4,12 +4,30 @@
 
 #include "font.h"
 
+#include <algorithm>
 #include <iostream>
 
 
 namespace blipcade::graphics {
     Font::Font(const Spritesheet spritesheet, const std::unordered_map<wchar_t, uint32_t> glyphs,
                Size glyphSize): spritesheet(spritesheet), glyphs(glyphs), glyphSize(glyphSize) {
+        buildGlyphTable();
+    }
+
+    void Font::buildGlyphTable() {
+        std::size_t tableSize = 0;
+        for (const auto &[c, index]: glyphs) {
+            if (static_cast<uint32_t>(c) <= 0xffff) {
+                tableSize = std::max(tableSize, static_cast<std::size_t>(c) + 1);
+            }
+        }
+
+        glyphTable.assign(tableSize, NO_GLYPH);
+        for (const auto &[c, index]: glyphs) {
+            if (static_cast<std::size_t>(c) < tableSize) {
+                glyphTable[c] = index;
+            }
+        }
     }
 
     Font::~Font() {
@@ -47,18 +65,29 @@ namespace blipcade::graphics {
     }
 
     std::optional<Sprite> Font::getGlyph(const wchar_t c) const {
-        const auto index = glyphs.find(c);
-
-        if (index != glyphs.end()) {
-            return spritesheet.getSprite(index->second);
+        if (const auto index = getGlyphIndex(c); index.has_value()) {
+            return spritesheet.getSprite(index.value());
         }
 
         return std::nullopt;
     }
 
     std::optional<uint32_t> Font::getGlyphIndex(const wchar_t c) const {
-        if (glyphs.contains(c)) {
-            return glyphs.at(c);
+        const auto codePoint = static_cast<uint32_t>(c);
+
+        if (codePoint < glyphTable.size()) {
+            if (const auto index = glyphTable[codePoint]; index != NO_GLYPH) {
+                return index;
+            }
+            return std::nullopt;
+        }
+
+        if (codePoint <= 0xffff) {
+            return std::nullopt;
+        }
+
+        if (const auto it = glyphs.find(c); it != glyphs.end()) {
+            return it->second;
         }
 
         return std::nullopt;
@@ -76,5 +105,22 @@ namespace blipcade::graphics {
 
         return result;
     }
+
+    const TextRun &Font::getCachedTextRun(const std::wstring &text) const {
+        if (const auto it = textRuns.find(text); it != textRuns.end()) {
+            return it->second;
+        }
+
+        // Strings built every frame (timers, scores) would grow the cache forever; start over instead
+        if (textRuns.size() >= TEXT_RUN_CACHE_LIMIT) {
+            textRuns.clear();
+        }
+
+        TextRun run;
+        run.glyphs = getTextRun(text);
+        run.width = static_cast<uint32_t>(run.glyphs.size()) * glyphSize.width;
+
+        return textRuns.emplace(text, std::move(run)).first->second;
+    }
 } // graphics
 // blipcade
@@ -5,12 +5,20 @@
 #ifndef FONT_H
 #define FONT_H
 #include <canvas.h>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "spritesheet.h"
 #include "graphics_types.h"
 
 namespace blipcade::graphics {
+// Glyph indices of a string laid out left to right, one glyph cell apart. Characters the font lacks are dropped.
+struct TextRun {
+    std::vector<uint32_t> glyphs;
+    uint32_t width = 0;
+};
+
 class Font {
 public:
     Font(Spritesheet spritesheet, std::unordered_map<wchar_t, uint32_t> glyphs, Size glyphSize);
@@ -22,11 +30,24 @@ public:
     [[nodiscard]] std::optional<uint32_t> getGlyphIndex(wchar_t c) const;
     [[nodiscard]] std::vector<uint32_t> getTextRun(const std::wstring &text) const;
 
+    // Same as getTextRun, memoized per string. The reference stays valid until the next call.
+    [[nodiscard]] const TextRun &getCachedTextRun(const std::wstring &text) const;
+
     Spritesheet spritesheet;
     Size glyphSize;
 
 private:
+    static constexpr uint32_t NO_GLYPH = UINT32_MAX;
+    static constexpr std::size_t TEXT_RUN_CACHE_LIMIT = 512;
+
     std::unordered_map<wchar_t, uint32_t> glyphs;
+
+    // Dense index for BMP code points, sized up to the highest one the font has; the map covers the rest
+    std::vector<uint32_t> glyphTable;
+
+    mutable std::unordered_map<std::wstring, TextRun> textRuns;
+
+    void buildGlyphTable();
 };
 
 } // graphics
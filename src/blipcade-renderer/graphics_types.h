@@ -1,7 +1,14 @@
 #ifndef GRAPHICS_TYPES_H
 #define GRAPHICS_TYPES_H
 
+#include <cstdint>
+
 namespace blipcade::graphics {
+    // Where Canvas draw calls end up: raylib/GL, or the CPU indexed framebuffer (no GPU needed)
+    enum class CanvasBackend {
+        Gpu,
+        Software
+    };
 
     struct Size {
         uint32_t width = 0;
@@ -0,0 +1,46 @@
+// headless.cpp
+
+#include "headless.h"
+
+#include <iostream>
+#include <raylib.h>
+#include <vector>
+
+#include "canvas.h"
+#include "runtime.h"
+
+namespace blipcade::graphics {
+    Headless::Headless(const uint32_t width, const uint32_t height) : width(width), height(height) {
+    }
+
+    bool Headless::run(const uint32_t frames, const std::string &outputPath) const {
+        // Left to the process exit like the windowed runner's: freeing the JS runtime asserts on any object a cart
+        // still holds
+        const auto runtime = new runtime::Runtime(width, height, CanvasBackend::Software);
+        runtime->init();
+
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            runtime->update(FRAME_SECONDS);
+            runtime->draw();
+        }
+
+        // The transparent index resolves to alpha 0, which the window shows as its black background
+        std::vector<Color> pixels = runtime->getCanvas()->resolve();
+        for (auto &pixel: pixels) {
+            pixel.a = 255;
+        }
+
+        const Image image = {
+            pixels.data(), static_cast<int>(width), static_cast<int>(height), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+        };
+
+        if (!ExportImage(image, outputPath.c_str())) {
+            std::cerr << "Failed to write frame to " << outputPath << std::endl;
+            return false;
+        }
+
+        std::cout << "Wrote frame " << frames << " to " << outputPath << std::endl;
+        return true;
+    }
+} // graphics
+// blipcade
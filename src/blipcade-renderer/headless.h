@@ -0,0 +1,29 @@
+// headless.h
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+#include <cstdint>
+#include <string>
+
+namespace blipcade::graphics {
+    // Runs the cart on the software canvas with no window, GL context or audio device, for servers without a GPU
+    // and for thumbnails. Frames step at the windowed runner's rate rather than the wall clock, so the same cart and
+    // frame count give the same image however fast the machine is.
+    class Headless {
+    public:
+        Headless(uint32_t width, uint32_t height);
+
+        // Runs `frames` updates and draws, then writes the last frame to `outputPath` (PNG), composited over black
+        // as the window shows it. Returns false when the image could not be written.
+        [[nodiscard]] bool run(uint32_t frames, const std::string &outputPath) const;
+
+    private:
+        static constexpr float FRAME_SECONDS = 1.0f / 30.0f;
+
+        uint32_t width;
+        uint32_t height;
+    };
+} // graphics
+// blipcade
+
+#endif // HEADLESS_H
@@ -0,0 +1,170 @@
+// paletteresolver.cpp
+
+#include "paletteresolver.h"
+
+#include <algorithm>
+
+#include "cpufeatures.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(BLIPCADE_AVX2_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace blipcade::graphics {
+    namespace {
+#if defined(BLIPCADE_AVX2_DISPATCH)
+        // Returns how many colors it did, always a multiple of 8
+        BLIPCADE_TARGET_AVX2 std::size_t resolveSpanAvx2(const uint8_t *indices, Color *out, const std::size_t count,
+                                                         const std::array<Color, 256> &palette) {
+            // Colors are 4 bytes, so the palette gathers as 32-bit lanes
+            const auto *table = reinterpret_cast<const int *>(palette.data());
+            std::size_t i = 0;
+
+            for (; i + 8 <= count; i += 8) {
+                const auto packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(indices + i));
+                const auto lanes = _mm256_cvtepu8_epi32(packed);
+                const auto colors = _mm256_i32gather_epi32(table, lanes, 4);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), colors);
+            }
+
+            return i;
+        }
+#endif
+    }
+
+    PaletteResolver::PaletteResolver(unsigned threadCount) {
+#ifndef EMSCRIPTEN
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        this->threadCount = std::min(threadCount, MAX_THREADS);
+#endif
+    }
+
+    void PaletteResolver::startWorkers() {
+        // Band 0 runs on the calling thread
+        for (unsigned band = 1; band < threadCount; ++band) {
+            workers.emplace_back(&PaletteResolver::workerLoop, this, band);
+        }
+    }
+
+    PaletteResolver::~PaletteResolver() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    void PaletteResolver::resolveSpan(const uint8_t *indices, Color *out, const std::size_t count,
+                                      const std::array<Color, 256> &palette) {
+        [[maybe_unused]] const auto level = simdLevel();
+        std::size_t i = 0;
+
+#if defined(BLIPCADE_AVX2_DISPATCH)
+        if (level == SimdLevel::Avx2) {
+            i = resolveSpanAvx2(indices, out, count, palette);
+        }
+#endif
+
+#if defined(__SSE2__)
+        // No gather before AVX2: the lookups stay scalar, but four colors leave in one store
+        const auto *table = reinterpret_cast<const int *>(palette.data());
+        for (; level >= SimdLevel::Sse2 && i + 4 <= count; i += 4) {
+            const auto colors = _mm_setr_epi32(table[indices[i]], table[indices[i + 1]], table[indices[i + 2]],
+                                               table[indices[i + 3]]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), colors);
+        }
+#endif
+
+        for (; i < count; ++i) {
+            out[i] = palette[indices[i]];
+        }
+    }
+
+    void PaletteResolver::resolveBand(const Job &job, const unsigned band) {
+        const auto rowsPerBand = (job.height + job.bands - 1) / job.bands;
+        const auto first = std::min(job.height, band * rowsPerBand);
+        const auto last = std::min(job.height, first + rowsPerBand);
+
+        if (!job.flipRows) {
+            const auto offset = static_cast<std::size_t>(first) * job.width;
+            resolveSpan(job.indices + offset, job.out + offset, static_cast<std::size_t>(last - first) * job.width,
+                        *job.palette);
+            return;
+        }
+
+        for (auto row = first; row < last; ++row) {
+            resolveSpan(job.indices + static_cast<std::size_t>(row) * job.width,
+                        job.out + static_cast<std::size_t>(job.height - 1 - row) * job.width, job.width,
+                        *job.palette);
+        }
+    }
+
+    void PaletteResolver::resolve(const uint8_t *indices, Color *out, const uint32_t width, const uint32_t height,
+                                  const std::array<Color, 256> &palette, const bool flipRows) {
+        const auto pixelCount = static_cast<std::size_t>(width) * height;
+
+        Job frame{indices, out, width, height, &palette, flipRows, 1};
+
+        if (threadCount <= 1 || pixelCount < PARALLEL_MIN_PIXELS) {
+            resolveBand(frame, 0);
+            return;
+        }
+
+        if (workers.empty()) {
+            startWorkers();
+        }
+
+        frame.bands = static_cast<unsigned>(workers.size()) + 1;
+
+        {
+            std::lock_guard lock(mutex);
+            job = frame;
+            pending = static_cast<unsigned>(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+
+        resolveBand(frame, 0);
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+    void PaletteResolver::workerLoop(const unsigned band) {
+        uint64_t seen = 0;
+
+        while (true) {
+            Job current;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+
+                if (stopping) {
+                    return;
+                }
+
+                seen = generation;
+                current = job;
+            }
+
+            resolveBand(current, band);
+
+            {
+                std::lock_guard lock(mutex);
+                --pending;
+            }
+            done.notify_one();
+        }
+    }
+} // graphics
+// blipcade
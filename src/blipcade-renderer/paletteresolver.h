@@ -0,0 +1,74 @@
+// paletteresolver.h
+
+#ifndef PALETTERESOLVER_H
+#define PALETTERESOLVER_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <raylib.h>
+
+namespace blipcade::graphics {
+    // Converts an indexed framebuffer to RGBA through a 256-entry palette.
+    // Rows are split into bands resolved in parallel on a small persistent worker pool once the frame is large
+    // enough to pay for the hand-off; smaller frames are resolved on the calling thread. The pool is only started
+    // by the first frame that crosses that size, so low-resolution carts never spawn a thread.
+    class PaletteResolver {
+    public:
+        // 0 picks one worker per hardware thread, capped at MAX_THREADS
+        explicit PaletteResolver(unsigned threadCount = 0);
+
+        ~PaletteResolver();
+
+        PaletteResolver(const PaletteResolver &) = delete;
+
+        PaletteResolver &operator=(const PaletteResolver &) = delete;
+
+        // `out` holds width * height colors. With `flipRows`, source row y lands in output row height - 1 - y.
+        void resolve(const uint8_t *indices, Color *out, uint32_t width, uint32_t height,
+                     const std::array<Color, 256> &palette, bool flipRows = false);
+
+        // Single-threaded kernel: out[i] = palette[indices[i]]. Uses AVX2 gathers when the CPU has them (see
+        // simdLevel), otherwise SSE2 stores of four looked-up colors at a time.
+        static void resolveSpan(const uint8_t *indices, Color *out, std::size_t count,
+                                const std::array<Color, 256> &palette);
+
+    private:
+        static constexpr unsigned MAX_THREADS = 8;
+        static constexpr std::size_t PARALLEL_MIN_PIXELS = 128 * 1024;
+
+        struct Job {
+            const uint8_t *indices = nullptr;
+            Color *out = nullptr;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            const std::array<Color, 256> *palette = nullptr;
+            bool flipRows = false;
+            unsigned bands = 0;
+        };
+
+        unsigned threadCount = 1;
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        Job job;
+        uint64_t generation = 0;
+        unsigned pending = 0;
+        bool stopping = false;
+
+        void startWorkers();
+
+        void workerLoop(unsigned band);
+
+        static void resolveBand(const Job &job, unsigned band);
+    };
+} // graphics
+// blipcade
+
+#endif // PALETTERESOLVER_H
@@ -4,12 +4,22 @@
 
 #include "postprocessing.h"
 
+#include <algorithm>
 #include <iostream>
 #include <ostream>
 
 #include "postprocessing_shader.h"
 
 namespace blipcade::renderer {
+    namespace {
+        uint64_t hashCode(const std::string &code) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (const auto c: code) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+            }
+            return hash;
+        }
+    }
 
     Postprocessing::Postprocessing() {
         const std::string code = R"(
@@ -18,39 +28,129 @@ namespace blipcade::renderer {
         }
         )";
 
-        changeShader(code);
+        uint64_t key;
+        compile(code, key);
+        passthrough = {key};
+        chain = passthrough;
     }
 
     Postprocessing::~Postprocessing() {
-        UnloadShader(postprocessingShader);
+        for (const auto &[key, program]: programs) {
+            UnloadShader(program.shader);
+        }
+
+        for (const auto &target: intermediates) {
+            if (target.id != 0) {
+                UnloadRenderTexture(target);
+            }
+        }
     }
 
-    void Postprocessing::changeShader(const std::string &code) {
-        UnloadShader(postprocessingShader);
+    const Postprocessing::Program &Postprocessing::compile(const std::string &code, uint64_t &key) {
+        key = hashCode(code);
+
+        if (const auto it = programs.find(key); it != programs.end()) {
+            return it->second;
+        }
 
         std::string fragmentSource = postprocessing_shader_fragmentSource;
 
         fragmentSource.replace(fragmentSource.find("%FRAGMENT%"), 10, code);
 
-        postprocessingShader = LoadShaderFromMemory(nullptr, fragmentSource.c_str());
+        Program program;
+        program.shader = LoadShaderFromMemory(nullptr, fragmentSource.c_str());
+
+        program.baseTextureLoc = GetShaderLocation(program.shader, "TEXTURE");
+        program.globalTimeLoc = GetShaderLocation(program.shader, "TIME");
+        program.screenWidthLoc = GetShaderLocation(program.shader, "SCREEN_WIDTH");
+        program.screenHeightLoc = GetShaderLocation(program.shader, "SCREEN_HEIGHT");
+
+        return programs.emplace(key, program).first->second;
+    }
+
+    void Postprocessing::changeShader(const std::string &code) {
+        setChain({code});
+    }
+
+    void Postprocessing::setChain(const std::vector<std::string> &codes) {
+        chain.clear();
+
+        for (const auto &code: codes) {
+            uint64_t key;
+            compile(code, key);
+            chain.push_back(key);
+        }
+    }
+
+    void Postprocessing::precompile(const std::string &code) {
+        uint64_t key;
+        compile(code, key);
+    }
+
+    void Postprocessing::ensureIntermediates(const int width, const int height) {
+        for (auto &target: intermediates) {
+            if (target.id != 0 && target.texture.width == width && target.texture.height == height) {
+                continue;
+            }
 
-        baseTextureLoc = GetShaderLocation(postprocessingShader, "TEXTURE");
-        globalTimeLoc = GetShaderLocation(postprocessingShader, "TIME");
-        screenWidthLoc = GetShaderLocation(postprocessingShader, "SCREEN_WIDTH");
-        screenHeightLoc = GetShaderLocation(postprocessingShader, "SCREEN_HEIGHT");
+            if (target.id != 0) {
+                UnloadRenderTexture(target);
+            }
+            target = LoadRenderTexture(width, height);
+        }
     }
 
-    void Postprocessing::postprocess(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture, float globalTime, float screenWidth, float screenHeight) {
-        BeginTextureMode(renderTexture);
-        BeginShaderMode(postprocessingShader);
-        SetShaderValueTexture(postprocessingShader, baseTextureLoc, baseTexture.texture);
-        SetShaderValue(postprocessingShader, globalTimeLoc, &globalTime, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(postprocessingShader, screenWidthLoc, &screenWidth, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(postprocessingShader, screenHeightLoc, &screenHeight, SHADER_UNIFORM_FLOAT);
-        DrawTextureRec(baseTexture.texture, {0, 0, static_cast<float>(baseTexture.texture.width), static_cast<float>(baseTexture.texture.height)}, {0, 0}, WHITE);
+    void Postprocessing::runEffect(const Program &program, const RenderTexture2D &source,
+                                   const RenderTexture2D &target, const bool preserveOrientation,
+                                   float globalTime, float screenWidth, float screenHeight,
+                                   const std::optional<Rectangle> &region) const {
+        BeginTextureMode(target);
+        if (region) {
+            BeginScissorMode(static_cast<int>(region->x), static_cast<int>(region->y),
+                             static_cast<int>(region->width), static_cast<int>(region->height));
+        }
+        BeginShaderMode(program.shader);
+        SetShaderValueTexture(program.shader, program.baseTextureLoc, source.texture);
+        SetShaderValue(program.shader, program.globalTimeLoc, &globalTime, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(program.shader, program.screenWidthLoc, &screenWidth, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(program.shader, program.screenHeightLoc, &screenHeight, SHADER_UNIFORM_FLOAT);
+
+        // Drawing a render texture upright flips it; intermediate passes undo that so only the last pass flips,
+        // exactly like a single effect does
+        const auto width = static_cast<float>(source.texture.width);
+        const auto height = static_cast<float>(source.texture.height);
+        DrawTextureRec(source.texture, {0, 0, width, preserveOrientation ? -height : height}, {0, 0}, WHITE);
+
         EndShaderMode();
+        if (region) EndScissorMode();
         EndTextureMode();
     }
 
+    void Postprocessing::postprocess(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture, float globalTime, float screenWidth, float screenHeight,
+                                     const std::optional<Rectangle> &region) {
+        const auto &passes = chain.empty() ? passthrough : chain;
+
+        if (passes.size() > 1) {
+            ensureIntermediates(baseTexture.texture.width, baseTexture.texture.height);
+        }
+
+        const auto *source = &baseTexture;
+
+        for (size_t i = 0; i < passes.size(); ++i) {
+            const auto last = i + 1 == passes.size();
+            const auto &target = last ? renderTexture : intermediates[i % 2];
+
+            runEffect(programs.at(passes[i]), *source, target, !last, globalTime, screenWidth, screenHeight, region);
+
+            source = &target;
+        }
+    }
+
+    bool Postprocessing::isTimeDependent() const {
+        return std::any_of(chain.begin(), chain.end(), [this](const uint64_t key) {
+            return programs.at(key).globalTimeLoc != -1;
+        });
+    }
+
 } // renderer
-// blipcade
\ No newline at end of file
+// blipcade
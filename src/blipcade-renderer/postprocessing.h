@@ -4,7 +4,12 @@
 
 #ifndef POSTPROCESSING_H
 #define POSTPROCESSING_H
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <raylib.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -15,19 +20,47 @@ public:
     Postprocessing();
     ~Postprocessing();
 
+    // Replaces the chain with a single effect
     void changeShader(const std::string &code);
 
+    // Effects run in order, each reading the previous one's output
+    void setChain(const std::vector<std::string> &codes);
+
+    // Compiles an effect ahead of time so a later changeShader/setChain with the same code does not stall
+    void precompile(const std::string &code);
+
+    // `region`, when given, limits the shader pass to that part of the target (top-left origin)
     void postprocess(const RenderTexture2D &baseTexture, const RenderTexture2D &renderTexture, float globalTime, float screenWidth, float
-                     screenHeight);
+                     screenHeight, const std::optional<Rectangle> &region = std::nullopt);
+
+    // Whether any effect in the chain reads TIME, i.e. its output changes even when the frame does not
+    [[nodiscard]] bool isTimeDependent() const;
 
 private:
-    std::vector<std::string> m_shaders;
-    Shader postprocessingShader;
-    int baseTextureLoc;
-    int globalTimeLoc;
+    struct Program {
+        Shader shader;
+        int baseTextureLoc;
+        int globalTimeLoc;
+        int screenWidthLoc;
+        int screenHeightLoc;
+    };
+
+    // Compiled effects keyed by a hash of their code, kept for the lifetime of the runtime
+    std::unordered_map<uint64_t, Program> programs;
+    std::vector<uint64_t> chain;
+    // Runs in place of an empty chain so the target is still written
+    std::vector<uint64_t> passthrough;
+
+    // Ping-pong targets between effects, allocated once a chain has more than one effect
+    std::array<RenderTexture2D, 2> intermediates{};
+
+    const Program &compile(const std::string &code, uint64_t &key);
+
+    void runEffect(const Program &program, const RenderTexture2D &source, const RenderTexture2D &target,
+                   bool preserveOrientation, float globalTime, float screenWidth, float screenHeight,
+                   const std::optional<Rectangle> &region) const;
 
-    int screenWidthLoc = 0;
-    int screenHeightLoc = 0;
+    void ensureIntermediates(int width, int height);
 };
 
 } // renderer
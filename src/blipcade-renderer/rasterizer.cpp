@@ -0,0 +1,331 @@
+// rasterizer.cpp
+
+#include "rasterizer.h"
+
+#include "blit.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace blipcade::graphics {
+    IndexedRasterizer::IndexedRasterizer(uint8_t *pixels, const uint32_t width, const uint32_t height)
+        : pixels(nullptr), width(0), height(0) {
+        setTarget(pixels, width, height);
+    }
+
+    void IndexedRasterizer::setTarget(uint8_t *pixels, const uint32_t width, const uint32_t height) {
+        this->pixels = pixels;
+        this->width = width;
+        this->height = height;
+        setClipRect({0, 0, 0, 0});
+    }
+
+    void IndexedRasterizer::setClipRect(const Rect &rect) {
+        const auto targetWidth = static_cast<int32_t>(width);
+        const auto targetHeight = static_cast<int32_t>(height);
+
+        if (rect.width <= 0 || rect.height <= 0) {
+            clipMinX = 0;
+            clipMinY = 0;
+            clipMaxX = targetWidth;
+            clipMaxY = targetHeight;
+            return;
+        }
+
+        clipMinX = std::clamp(rect.x, 0, targetWidth);
+        clipMinY = std::clamp(rect.y, 0, targetHeight);
+        clipMaxX = std::clamp(rect.x + rect.width, clipMinX, targetWidth);
+        clipMaxY = std::clamp(rect.y + rect.height, clipMinY, targetHeight);
+    }
+
+    void IndexedRasterizer::setTransparentIndex(const uint8_t index) {
+        transparentIndex = index;
+    }
+
+    void IndexedRasterizer::fill(const uint8_t color) {
+        std::memset(pixels, color, static_cast<size_t>(width) * height);
+    }
+
+    void IndexedRasterizer::pixel(const int32_t x, const int32_t y, const uint8_t color) {
+        if (x < clipMinX || x >= clipMaxX || y < clipMinY || y >= clipMaxY) {
+            return;
+        }
+
+        pixels[static_cast<size_t>(y) * width + x] = color;
+    }
+
+    void IndexedRasterizer::horizontalSpan(int32_t x0, int32_t x1, const int32_t y, const uint8_t color) {
+        if (y < clipMinY || y >= clipMaxY) {
+            return;
+        }
+
+        if (x0 > x1) {
+            std::swap(x0, x1);
+        }
+
+        x0 = std::max(x0, clipMinX);
+        x1 = std::min(x1, clipMaxX - 1);
+
+        if (x0 > x1) {
+            return;
+        }
+
+        std::memset(pixels + static_cast<size_t>(y) * width + x0, color, x1 - x0 + 1);
+    }
+
+    void IndexedRasterizer::verticalSpan(const int32_t x, int32_t y0, int32_t y1, const uint8_t color) {
+        if (x < clipMinX || x >= clipMaxX) {
+            return;
+        }
+
+        y0 = std::max(y0, clipMinY);
+        y1 = std::min(y1, clipMaxY - 1);
+
+        for (auto y = y0; y <= y1; ++y) {
+            pixels[static_cast<size_t>(y) * width + x] = color;
+        }
+    }
+
+    void IndexedRasterizer::line(int32_t x0, int32_t y0, const int32_t x1, const int32_t y1, const uint8_t color) {
+        if (y0 == y1) {
+            horizontalSpan(x0, x1, y0, color);
+            return;
+        }
+
+        if (x0 == x1) {
+            verticalSpan(x0, std::min(y0, y1), std::max(y0, y1), color);
+            return;
+        }
+
+        // Bresenham
+        const auto dx = std::abs(x1 - x0);
+        const auto dy = -std::abs(y1 - y0);
+        const auto stepX = x0 < x1 ? 1 : -1;
+        const auto stepY = y0 < y1 ? 1 : -1;
+        auto error = dx + dy;
+
+        while (true) {
+            pixel(x0, y0, color);
+
+            if (x0 == x1 && y0 == y1) {
+                break;
+            }
+
+            const auto error2 = 2 * error;
+            if (error2 >= dy) {
+                error += dy;
+                x0 += stepX;
+            }
+            if (error2 <= dx) {
+                error += dx;
+                y0 += stepY;
+            }
+        }
+    }
+
+    void IndexedRasterizer::rect(const int32_t x, const int32_t y, const int32_t width, const int32_t height,
+                                 const uint8_t color) {
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        const auto right = x + width - 1;
+        const auto bottom = y + height - 1;
+
+        horizontalSpan(x, right, y, color);
+        horizontalSpan(x, right, bottom, color);
+        verticalSpan(x, y + 1, bottom - 1, color);
+        verticalSpan(right, y + 1, bottom - 1, color);
+    }
+
+    void IndexedRasterizer::filledRect(const int32_t x, const int32_t y, const int32_t width, const int32_t height,
+                                       const uint8_t color) {
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        const auto top = std::max(y, clipMinY);
+        const auto bottom = std::min(y + height, clipMaxY);
+
+        for (auto row = top; row < bottom; ++row) {
+            horizontalSpan(x, x + width - 1, row, color);
+        }
+    }
+
+    void IndexedRasterizer::circle(const int32_t centerX, const int32_t centerY, const uint32_t radius,
+                                   const uint8_t color) {
+        // Midpoint circle, one octant mirrored eight ways
+        auto x = static_cast<int32_t>(radius);
+        auto y = 0;
+        auto error = 1 - x;
+
+        while (x >= y) {
+            pixel(centerX + x, centerY + y, color);
+            pixel(centerX - x, centerY + y, color);
+            pixel(centerX + x, centerY - y, color);
+            pixel(centerX - x, centerY - y, color);
+            pixel(centerX + y, centerY + x, color);
+            pixel(centerX - y, centerY + x, color);
+            pixel(centerX + y, centerY - x, color);
+            pixel(centerX - y, centerY - x, color);
+
+            ++y;
+            if (error < 0) {
+                error += 2 * y + 1;
+            } else {
+                --x;
+                error += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    void IndexedRasterizer::filledCircle(const int32_t centerX, const int32_t centerY, const uint32_t radius,
+                                         const uint8_t color) {
+        const auto r = static_cast<int32_t>(radius);
+        const auto radiusSqr = r * r;
+
+        // Walk the half-width inwards as rows move away from the center
+        auto halfWidth = r;
+        for (auto dy = 0; dy <= r; ++dy) {
+            while (halfWidth > 0 && halfWidth * halfWidth + dy * dy > radiusSqr) {
+                --halfWidth;
+            }
+
+            horizontalSpan(centerX - halfWidth, centerX + halfWidth, centerY + dy, color);
+            if (dy != 0) {
+                horizontalSpan(centerX - halfWidth, centerX + halfWidth, centerY - dy, color);
+            }
+        }
+    }
+
+    Sprite IndexedRasterizer::clampToSheet(const Spritesheet &spritesheet, const Sprite &sprite) {
+        auto clamped = sprite;
+
+        clamped.x = std::min(sprite.x, spritesheet.width);
+        clamped.y = std::min(sprite.y, spritesheet.height);
+        clamped.width = std::min(sprite.width, spritesheet.width - clamped.x);
+        clamped.height = std::min(sprite.height, spritesheet.height - clamped.y);
+
+        if (spritesheet.pixelBuffer.size() < static_cast<size_t>(spritesheet.width) * spritesheet.height) {
+            clamped.width = 0;
+            clamped.height = 0;
+        }
+
+        return clamped;
+    }
+
+    void IndexedRasterizer::blit(const Spritesheet &spritesheet, const Sprite &sprite, const int32_t x,
+                                 const int32_t y, const bool flipX, const bool flipY,
+                                 const std::array<uint8_t, 256> *remap) {
+        const auto source = clampToSheet(spritesheet, sprite);
+        const auto spriteWidth = static_cast<int32_t>(source.width);
+        const auto spriteHeight = static_cast<int32_t>(source.height);
+
+        const auto left = std::max(x, clipMinX);
+        const auto top = std::max(y, clipMinY);
+        const auto right = std::min(x + spriteWidth, clipMaxX);
+        const auto bottom = std::min(y + spriteHeight, clipMaxY);
+
+        if (left >= right || top >= bottom) {
+            return;
+        }
+
+        const auto *sheet = spritesheet.pixelBuffer.data();
+
+        for (auto row = top; row < bottom; ++row) {
+            const auto localY = row - y;
+            const auto sourceY = source.y + (flipY ? spriteHeight - 1 - localY : localY);
+            const auto *sourceRow = sheet + static_cast<size_t>(sourceY) * spritesheet.width + source.x;
+            auto *destRow = pixels + static_cast<size_t>(row) * width + left;
+
+            // Flipped rows read the mirrored span of the source and reverse it
+            const auto *span = sourceRow + (flipX ? x + spriteWidth - right : left - x);
+            const auto count = static_cast<size_t>(right - left);
+
+            if (remap) {
+                blitRemappedRow(destRow, span, count, transparentIndex, flipX, *remap);
+            } else if (flipX) {
+                blitMaskedRowReversed(destRow, span, count, transparentIndex);
+            } else {
+                blitMaskedRow(destRow, span, count, transparentIndex);
+            }
+        }
+    }
+
+    void IndexedRasterizer::blitBuffer(const uint8_t *source, const uint32_t sourceWidth,
+                                       const uint32_t sourceHeight, const int32_t x, const int32_t y) {
+        const auto left = std::max(x, clipMinX);
+        const auto top = std::max(y, clipMinY);
+        const auto right = std::min(x + static_cast<int32_t>(sourceWidth), clipMaxX);
+        const auto bottom = std::min(y + static_cast<int32_t>(sourceHeight), clipMaxY);
+
+        if (left >= right || top >= bottom) {
+            return;
+        }
+
+        for (auto row = top; row < bottom; ++row) {
+            const auto *span = source + static_cast<size_t>(row - y) * sourceWidth + (left - x);
+            auto *destRow = pixels + static_cast<size_t>(row) * width + left;
+
+            blitMaskedRow(destRow, span, static_cast<size_t>(right - left), transparentIndex);
+        }
+    }
+
+    void IndexedRasterizer::blitScaled(const Spritesheet &spritesheet, const Sprite &sprite, const Rect &dest,
+                                       const bool flipX, const bool flipY,
+                                       const std::array<uint8_t, 256> *remap) {
+        const auto source = clampToSheet(spritesheet, sprite);
+        const auto spriteWidth = static_cast<int32_t>(source.width);
+        const auto spriteHeight = static_cast<int32_t>(source.height);
+
+        if (dest.width <= 0 || dest.height <= 0 || spriteWidth == 0 || spriteHeight == 0) {
+            return;
+        }
+
+        const auto left = std::max(dest.x, clipMinX);
+        const auto top = std::max(dest.y, clipMinY);
+        const auto right = std::min(dest.x + dest.width, clipMaxX);
+        const auto bottom = std::min(dest.y + dest.height, clipMaxY);
+
+        if (left >= right || top >= bottom) {
+            return;
+        }
+
+        const auto *sheet = spritesheet.pixelBuffer.data();
+        const auto count = static_cast<size_t>(right - left);
+
+        // Source column of every destination column, shared by all rows
+        columnMap.resize(count);
+        for (auto column = left; column < right; ++column) {
+            const auto localX = static_cast<int32_t>(static_cast<int64_t>(column - dest.x) * spriteWidth / dest.width);
+            columnMap[column - left] = static_cast<uint32_t>(flipX ? spriteWidth - 1 - localX : localX);
+        }
+
+        // Each sampled source row is stretched once into the scratch row and reused while the scale repeats it
+        scaledRow.resize(count);
+        auto lastSourceY = -1;
+
+        for (auto row = top; row < bottom; ++row) {
+            const auto localY = static_cast<int32_t>(static_cast<int64_t>(row - dest.y) * spriteHeight / dest.height);
+            const auto sourceY = static_cast<int32_t>(source.y) + (flipY ? spriteHeight - 1 - localY : localY);
+
+            if (sourceY != lastSourceY) {
+                const auto *sourceRow = sheet + static_cast<size_t>(sourceY) * spritesheet.width + source.x;
+                for (size_t i = 0; i < count; ++i) {
+                    scaledRow[i] = sourceRow[columnMap[i]];
+                }
+                lastSourceY = sourceY;
+            }
+
+            auto *destRow = pixels + static_cast<size_t>(row) * width + left;
+
+            if (remap) {
+                blitRemappedRow(destRow, scaledRow.data(), count, transparentIndex, false, *remap);
+            } else {
+                blitMaskedRow(destRow, scaledRow.data(), count, transparentIndex);
+            }
+        }
+    }
+} // graphics
+// blipcade
@@ -0,0 +1,80 @@
+// rasterizer.h
+
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "graphics_types.h"
+#include "spritesheet.h"
+
+namespace blipcade::graphics {
+    // CPU rasterizer writing palette indices into an 8-bit framebuffer.
+    // Coordinates are target pixels; camera offsets are applied by the caller. Every write is clipped to the
+    // clip rect, and sprite pixels equal to the transparent index are skipped.
+    class IndexedRasterizer {
+    public:
+        IndexedRasterizer(uint8_t *pixels, uint32_t width, uint32_t height);
+
+        void setTarget(uint8_t *pixels, uint32_t width, uint32_t height);
+
+        // Zero width or height clips to the whole target
+        void setClipRect(const Rect &rect);
+
+        void setTransparentIndex(uint8_t index);
+
+        void fill(uint8_t color);
+
+        void pixel(int32_t x, int32_t y, uint8_t color);
+
+        void line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t color);
+
+        void rect(int32_t x, int32_t y, int32_t width, int32_t height, uint8_t color);
+
+        void filledRect(int32_t x, int32_t y, int32_t width, int32_t height, uint8_t color);
+
+        void circle(int32_t centerX, int32_t centerY, uint32_t radius, uint8_t color);
+
+        void filledCircle(int32_t centerX, int32_t centerY, uint32_t radius, uint8_t color);
+
+        // Copies the sprite with its top-left corner at (x, y). `remap`, when given, maps sheet indices before writing.
+        void blit(const Spritesheet &spritesheet, const Sprite &sprite, int32_t x, int32_t y, bool flipX, bool flipY,
+                  const std::array<uint8_t, 256> *remap = nullptr);
+
+        // Copies a whole indexed buffer (e.g. a cached layer) with its top-left corner at (x, y)
+        void blitBuffer(const uint8_t *source, uint32_t sourceWidth, uint32_t sourceHeight, int32_t x, int32_t y);
+
+        // Nearest-neighbour stretch of the sprite into `dest`
+        void blitScaled(const Spritesheet &spritesheet, const Sprite &sprite, const Rect &dest, bool flipX, bool flipY,
+                        const std::array<uint8_t, 256> *remap = nullptr);
+
+    private:
+        uint8_t *pixels;
+        uint32_t width;
+        uint32_t height;
+
+        uint8_t transparentIndex = 255;
+
+        // Clip bounds, max exclusive
+        int32_t clipMinX = 0;
+        int32_t clipMinY = 0;
+        int32_t clipMaxX = 0;
+        int32_t clipMaxY = 0;
+
+        // Scratch for scaled blits
+        std::vector<uint32_t> columnMap;
+        std::vector<uint8_t> scaledRow;
+
+        void horizontalSpan(int32_t x0, int32_t x1, int32_t y, uint8_t color);
+
+        void verticalSpan(int32_t x, int32_t y0, int32_t y1, uint8_t color);
+
+        // Sprite rect clamped to the sheet, so reads never leave the pixel buffer
+        static Sprite clampToSheet(const Spritesheet &spritesheet, const Sprite &sprite);
+    };
+} // graphics
+// blipcade
+
+#endif // RASTERIZER_H
@@ -1,10 +1,16 @@
 in vec2 fragTexCoord;
 out vec4 finalColor;
 
+#define MAX_LIGHTS 8                    // Per pass; keep in sync with Canvas::MAX_LIGHTS_PER_PASS
+
 uniform sampler2D baseTexture;
-uniform sampler2D maskTexture;      // Mask defining the lighting area
-uniform vec4 tintColor;             // The tint color (RGBA)
-uniform float opacity;              // Opacity of the tint
+uniform sampler2D maskAtlas;            // One mask per light, in a grid filled column by column
+uniform ivec2 maskGrid;                 // Columns and rows of the atlas grid
+uniform int firstMask;                  // Atlas slot of this pass's first light
+uniform int flipMask;                   // Set when baseTexture is sampled upside down relative to the masks
+uniform vec4 lightTints[MAX_LIGHTS];    // The tint color (RGBA) of each light
+uniform float lightOpacities[MAX_LIGHTS];
+uniform int lightCount;
 
 float blendOverlay(float base, float blend) {
     return base<0.5?(2.0*base*blend):(1.0-2.0*(1.0-base)*(1.0-blend));
@@ -21,9 +27,24 @@ vec3 blendOverlay(vec3 base, vec3 blend, float opacity) {
 void main()
 {
     vec4 baseColor = texture(baseTexture, fragTexCoord);
-    float mask = texture(maskTexture, fragTexCoord).r; // Assuming mask is grayscale
+    vec3 color = baseColor.rgb;
+
+    // Keep samples half a texel inside the slot so filtering never reads the neighbouring mask
+    vec2 grid = vec2(maskGrid);
+    vec2 slotTexel = grid / vec2(textureSize(maskAtlas, 0));
+    vec2 slotCoord = vec2(fragTexCoord.x, flipMask != 0 ? 1.0 - fragTexCoord.y : fragTexCoord.y);
+    slotCoord = clamp(slotCoord, 0.5 * slotTexel, 1.0 - 0.5 * slotTexel);
+
+    for (int i = 0; i < MAX_LIGHTS; i++) {
+        if (i >= lightCount) break;
+
+        int slot = firstMask + i;
+        vec2 cell = vec2(float(slot / maskGrid.y), float(slot - slot / maskGrid.y * maskGrid.y));
+        vec2 maskCoord = (cell + slotCoord) / grid;
+        float mask = texture(maskAtlas, maskCoord).r; // Assuming mask is grayscale
 
-    vec3 tintedColor = blendOverlay(baseColor.rgb, tintColor.rgb, mask * opacity);
+        color = blendOverlay(color, lightTints[i].rgb, mask * lightOpacities[i]);
+    }
 
-    finalColor = vec4(tintedColor, baseColor.a);
+    finalColor = vec4(color, baseColor.a);
 }
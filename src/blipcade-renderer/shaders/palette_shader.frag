@@ -1,13 +1,15 @@
 in vec2 fragTexCoord;
+in vec4 fragColor;
 out vec4 finalColor;
 
 uniform sampler2D texture0;
-uniform vec4 palette[256];
+uniform sampler2D palette; // 256 x rows atlas, texel (i, row) holds the color of palette index i in that row
 
 void main()
 {
     float index = texture(texture0, fragTexCoord).r; // Read palette index (normalized 0.0 - 1.0)
     int paletteIndex = int(index * 255.0 + 0.5);     // Convert to integer index [0, 255]
+    int paletteRow = int(fragColor.r * 255.0 + 0.5); // Palette row carried in the vertex color
 
-    finalColor = palette[paletteIndex];
-}
\ No newline at end of file
+    finalColor = texelFetch(palette, ivec2(paletteIndex, paletteRow), 0);
+}
@@ -99,6 +99,10 @@ namespace blipcade::graphics {
     }
 
     void Spritesheet::createTexture() {
+        if (!IsWindowReady()) {
+            return;
+        }
+
         Image image;
         image.data = pixelBuffer.data();
         image.width = static_cast<int>(width);
@@ -43,7 +43,8 @@ namespace blipcade::graphics {
         uint32_t width;
         uint32_t height;
 
-        Texture2D texture;
+        // Only created when there is a window (and so a GL context); the software backend blits from pixelBuffer
+        Texture2D texture{};
         void createTexture();
 
         std::vector<Color> colorData;
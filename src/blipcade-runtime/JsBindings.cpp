@@ -6,14 +6,21 @@
 
 #include <audio.h>
 #include <canvas.h>
+#include <cmath>
 #include <codecvt>
 #include <collider.h>
+#include <collisionworld.h>
+#include <compressor.h>
+#include <echo.h>
 #include <fstream>
 #include <iostream>
+#include <lowpass.h>
 #include <navmesh.h>
+#include <nlohmann/json.hpp>
 #include <pathfinding.h>
 #include <postprocessing.h>
 #include <project.h>
+#include <reverb.h>
 
 #include "runtime.h"
 
@@ -201,8 +208,16 @@ namespace blipcade::runtime {
         bindDrawFilledRectangle(global);
         bindDrawSprite(global);
         bindDrawSpriteEx(global);
+        bindCreatePaletteRemap(global);
+        bindBeginLayer(global);
+        bindEndLayer(global);
+        bindDrawLayer(global);
+        bindInvalidateLayer(global);
+        bindSetPartialRedraw(global);
 
         bindSetPostprocessingShader(global);
+        bindSetPostprocessingChain(global);
+        bindPrecompilePostprocessingShader(global);
     }
 
     /**
@@ -279,6 +294,7 @@ namespace blipcade::runtime {
      * @param {string} [spriteSheet=""] - The path of the sprite sheet to use.
      * @param {boolean} [flipX=false] - Whether to flip the sprite horizontally.
      * @param {boolean} [flipY=false] - Whether to flip the sprite vertically.
+     * @param {number} [paletteRow=0] - The palette remap to draw with, as returned by `createPaletteRemap`.
      *
      * @description Draws a sprite on the canvas.
      *
@@ -294,6 +310,7 @@ namespace blipcade::runtime {
             int32_t x = 0, y = 0, spriteIndex = 0;
             std::string spriteSheetIndex = "0";
             bool flipX = false, flipY = false;
+            uint8_t paletteRow = 0;
 
             if (argsCount >= 1) x = a[0].as_int32();
             if (argsCount >= 2) y = a[1].as_int32();
@@ -301,6 +318,7 @@ namespace blipcade::runtime {
             if (argsCount >= 4) spriteSheetIndex = a[3].as_cstring().c_str();
             if (argsCount >= 5) flipX = a[4].as_int32();
             if (argsCount >= 6) flipY = a[5].as_int32();
+            if (argsCount >= 7) paletteRow = a[6].as_int32();
 
             const auto spritesheets = m_runtime.getSpritesheets();
 
@@ -310,9 +328,9 @@ namespace blipcade::runtime {
                 m_runtime.getSpritesheets()->insert({spriteSheetIndex, spritesht});
             }
 
-            const auto spritesheet = spritesheets->at(spriteSheetIndex);
+            const auto &spritesheet = spritesheets->at(spriteSheetIndex);
 
-            m_runtime.getCanvas()->drawSprite(x, y, flipX, flipY, spritesheet, spriteIndex);
+            m_runtime.getCanvas()->drawSprite(x, y, flipX, flipY, spritesheet, spriteIndex, paletteRow);
         });
     }
 
@@ -336,6 +354,7 @@ namespace blipcade::runtime {
      *
      * @param {number} [originX=0.5] - The x origin of the sprite, from 0 to 1, where 0 is the left and 1 is the right.
      * @param {number} [originY=0.5] - The y origin of the sprite, from 0 to 1, where 0 is the top and 1 is the bottom.
+     * @param {number} [paletteRow=0] - The palette remap to draw with, as returned by `createPaletteRemap`.
      *
      * @description Draws a sprite on the canvas.
      *
@@ -352,6 +371,7 @@ namespace blipcade::runtime {
             std::string spriteSheetIndex = "";
             bool flipX = false, flipY = false;
             float scale = 1.0, originX = 0.5, originY = 0.5;
+            uint8_t paletteRow = 0;
 
             if (argsCount >= 1) x = a[0].as_int32();
             if (argsCount >= 2) y = a[1].as_int32();
@@ -362,6 +382,7 @@ namespace blipcade::runtime {
             if (argsCount >= 7) scale = a[6].as_double();
             if (argsCount >= 8) originX = a[7].as_double();
             if (argsCount >= 9) originY = a[8].as_double();
+            if (argsCount >= 10) paletteRow = a[9].as_int32();
 
             const auto spritesheets = m_runtime.getSpritesheets();
 
@@ -371,9 +392,169 @@ namespace blipcade::runtime {
                 m_runtime.getSpritesheets()->insert({spriteSheetIndex, spritesht});
             }
 
-            const auto spritesheet = spritesheets->at(spriteSheetIndex);
+            const auto &spritesheet = spritesheets->at(spriteSheetIndex);
 
-            m_runtime.getCanvas()->drawSpriteEx(x, y, flipX, flipY, scale, originX, originY, spritesheet, spriteIndex);
+            m_runtime.getCanvas()->drawSpriteEx(x, y, flipX, flipY, scale, originX, originY, spritesheet, spriteIndex,
+                                                paletteRow);
+        });
+    }
+
+    /**
+     * @function beginLayer
+     *
+     * @param {number} layer - The layer id.
+     * @param {number} [x=0] - The world x-coordinate of the layer's top-left corner.
+     * @param {number} [y=0] - The world y-coordinate of the layer's top-left corner.
+     * @param {number} [width=0] - The layer width; 0 uses the canvas size.
+     * @param {number} [height=0] - The layer height; 0 uses the canvas size.
+     *
+     * @description Starts recording a cached layer. Draw calls until `endLayer` go into the layer, in world coordinates. Returns `false` while the layer still holds valid content, in which case nothing should be drawn and `endLayer` need not be called. Changing the layer rect invalidates it.
+     *
+     * @returns {boolean} - `true` if the layer needs to be redrawn.
+     *
+     * @example if (Graphics.beginLayer(1)) { drawBackground(); Graphics.endLayer(); } Graphics.drawLayer(1);
+     */
+    void JSBindings::bindBeginLayer(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("beginLayer", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("beginLayer: Missing argument(s).");
+            }
+
+            const uint32_t layer = a[0].as_uint32();
+            graphics::Rect bounds = {0, 0, 0, 0};
+
+            if (argsCount >= 2) bounds.x = a[1].as_int32();
+            if (argsCount >= 3) bounds.y = a[2].as_int32();
+            if (argsCount >= 4) bounds.width = a[3].as_int32();
+            if (argsCount >= 5) bounds.height = a[4].as_int32();
+
+            return {*ctx, m_runtime.getCanvas()->beginLayer(layer, bounds)};
+        });
+    }
+
+    /**
+     * @function endLayer
+     *
+     * @description Finishes recording the layer started by `beginLayer`; later draw calls go to the screen again.
+     *
+     * @example Graphics.endLayer();
+     */
+    void JSBindings::bindEndLayer(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("endLayer", [this](const quickjs::args &a) {
+            m_runtime.getCanvas()->endLayer();
+        });
+    }
+
+    /**
+     * @function drawLayer
+     *
+     * @param {number} layer - The layer id.
+     *
+     * @description Draws a cached layer at its world position, offset by the camera. Does nothing if the layer has not been recorded.
+     *
+     * @example Graphics.drawLayer(1);
+     */
+    void JSBindings::bindDrawLayer(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("drawLayer", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("drawLayer: Missing argument(s).");
+            }
+
+            m_runtime.getCanvas()->drawLayer(a[0].as_uint32());
+        });
+    }
+
+    /**
+     * @function invalidateLayer
+     *
+     * @param {number} [layer] - The layer id. Omit to invalidate every layer.
+     *
+     * @description Marks a cached layer as stale, so the next `beginLayer` records it again.
+     *
+     * @example Graphics.invalidateLayer(1);
+     */
+    void JSBindings::bindInvalidateLayer(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("invalidateLayer", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                m_runtime.getCanvas()->invalidateLayers();
+                return;
+            }
+
+            m_runtime.getCanvas()->invalidateLayer(a[0].as_uint32());
+        });
+    }
+
+    /**
+     * @function setPartialRedraw
+     *
+     * @param {boolean} [enabled=true] - Whether to enable partial redraw.
+     *
+     * @description Only re-composites the parts of the frame whose draw calls changed since the previous frame. `draw()` still runs every frame; lighting, post-processing (unless the shader uses `TIME`) and the software canvas upload are limited to the changed region, and skipped entirely when nothing changed. Suited to mostly static screens.
+     *
+     * @example Graphics.setPartialRedraw(true);
+     */
+    void JSBindings::bindSetPartialRedraw(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("setPartialRedraw", [this](const quickjs::args &a) {
+            bool enabled = true;
+
+            if (a.size() >= 1) enabled = a[0].as_int32();
+
+            m_runtime.setPartialRedraw(enabled);
+        });
+    }
+
+    /**
+     * @function createPaletteRemap
+     *
+     * @param {Array} pairs - `[from, to]` palette index pairs; indices not listed keep their color.
+     *
+     * @description Registers a palette remap and returns its palette row, to be passed to `drawSprite`/`drawSpriteEx`. Identical remaps share a row, so sprites drawn with different remaps still batch together. Up to 64 rows exist; past that the least recently used row is handed to the new remap, so a kept row can end up showing another remap. Asking again each frame is cheap and always safe. A row that was never returned draws with the plain palette.
+     *
+     * @returns {number} - The palette row.
+     *
+     * @example function draw() { const flash = Graphics.createPaletteRemap([[0x12, 0xfe], [0x13, 0xfe]]); Graphics.drawSprite(10, 10, 0, sheet, false, false, flash); }
+     */
+    void JSBindings::bindCreatePaletteRemap(quickjs::value &global) {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("createPaletteRemap", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 1) {
+                throw std::runtime_error("createPaletteRemap: Missing argument(s).");
+            }
+
+            std::array<uint8_t, 256> remap{};
+            for (int i = 0; i < 256; ++i) {
+                remap[i] = static_cast<uint8_t>(i);
+            }
+
+            quickjs::value pairs = a[0];
+            const uint32_t length = pairs.get_property("length").as_uint32();
+
+            for (uint32_t i = 0; i < length; ++i) {
+                quickjs::value pair = pairs.get_property(i);
+
+                const auto from = static_cast<uint8_t>(pair.get_property(0u).as_int32());
+                const auto to = static_cast<uint8_t>(pair.get_property(1u).as_int32());
+                remap[from] = to;
+            }
+
+            return {*ctx, static_cast<int32_t>(m_runtime.getCanvas()->getPaletteRow(remap))};
         });
     }
 
@@ -534,13 +715,29 @@ namespace blipcade::runtime {
         });
     }
 
+    std::string JSBindings::loadPostprocessingShader(const std::string &shaderPath, const std::string &caller) const {
+        const auto path = shaderPath.substr(6);
+
+        std::filesystem::path fullPath = std::filesystem::path(m_runtime.getProject()->getDirectory()) / path;
+
+        // load file
+        std::ifstream file(fullPath);
+        if (!file.is_open()) {
+            std::cerr << "Error: Failed to open file: " << fullPath << std::endl;
+            throw std::runtime_error(caller + ": Failed to open file.");
+        }
+
+        return {std::istreambuf_iterator(file), std::istreambuf_iterator<char>()};
+    }
+
     /**
      *
      * @function setPostprocessingShader
      *
      * @param {string} shaderPath - The path to the postprocessing shader.
      *
-     * @description Sets the postprocessing shader.
+     * @description Sets the postprocessing shader, replacing any chain. Compiled shaders are cached, so switching
+     * back to a shader that was used or precompiled before does not recompile it.
      *
      * @example Graphics.setPostprocessingShader("res://shaders/postprocessing.frag");
      */
@@ -556,20 +753,82 @@ namespace blipcade::runtime {
 
             std::string shaderPath = a[0].as_cstring().c_str();
 
-            const auto path = shaderPath.substr(6);
+            // Headless runs have no GL context and nothing to post-process
+            const auto postprocessing = m_runtime.getPostprocessing();
+            if (!postprocessing) {
+                return;
+            }
+
+            postprocessing->changeShader(loadPostprocessingShader(shaderPath, "setPostprocessingShader"));
+            // Regions left clean by partial redraw still hold the old shader's output
+            m_runtime.getCanvas()->invalidate();
+        });
+    }
+
+    /**
+     * @function setPostprocessingChain
+     *
+     * @param {Array} shaderPaths - The postprocessing shaders, in the order they run.
+     *
+     * @description Runs several postprocessing shaders one after another, each reading the previous one's output.
+     * An empty array shows the frame unchanged.
+     *
+     * @example Graphics.setPostprocessingChain(["res://shaders/bloom.frag", "res://shaders/crt.frag"]);
+     */
+    void JSBindings::bindSetPostprocessingChain(quickjs::value &global) const {
+        auto graphics = global.get_property("Graphics");
+
+        graphics.set_property("setPostprocessingChain", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("setPostprocessingChain: Missing argument.");
+            }
+
+            const auto postprocessing = m_runtime.getPostprocessing();
+            if (!postprocessing) {
+                return;
+            }
+
+            quickjs::value paths = a[0];
+            const uint32_t length = paths.get_property("length").as_uint32();
+
+            std::vector<std::string> codes;
+            codes.reserve(length);
+
+            for (uint32_t i = 0; i < length; ++i) {
+                std::string shaderPath = paths.get_property(i).as_cstring().c_str();
+                codes.push_back(loadPostprocessingShader(shaderPath, "setPostprocessingChain"));
+            }
+
+            postprocessing->setChain(codes);
+            m_runtime.getCanvas()->invalidate();
+        });
+    }
 
-            std::filesystem::path fullPath = std::filesystem::path(m_runtime.getProject()->getDirectory()) / path;
+    /**
+     * @function precompilePostprocessingShader
+     *
+     * @param {string} shaderPath - The path to the postprocessing shader.
+     *
+     * @description Compiles a postprocessing shader without using it, so a later `setPostprocessingShader` or
+     * `setPostprocessingChain` with it is instant. Call it at load time.
+     *
+     * @example Graphics.precompilePostprocessingShader("res://shaders/damage.frag");
+     */
+    void JSBindings::bindPrecompilePostprocessingShader(quickjs::value &global) const {
+        auto graphics = global.get_property("Graphics");
 
-            // load file
-            std::ifstream file(fullPath);
-            if (!file.is_open()) {
-                std::cerr << "Error: Failed to open file: " << fullPath << std::endl;
-                throw std::runtime_error("setPostprocessingShader: Failed to open file.");
+        graphics.set_property("precompilePostprocessingShader", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("precompilePostprocessingShader: Missing argument.");
             }
 
-            std::string shaderCode((std::istreambuf_iterator(file)), std::istreambuf_iterator<char>());
+            const auto postprocessing = m_runtime.getPostprocessing();
+            if (!postprocessing) {
+                return;
+            }
 
-            m_runtime.getPostprocessing()->changeShader(shaderCode);
+            std::string shaderPath = a[0].as_cstring().c_str();
+            postprocessing->precompile(loadPostprocessingShader(shaderPath, "precompilePostprocessingShader"));
         });
     }
 
@@ -641,11 +900,15 @@ namespace blipcade::runtime {
                 255
             };
 
-            // Load mask texture
-            Texture2D maskTexture = LoadTexture(maskImagePath.c_str());
-            if (maskTexture.id == 0) {
-                std::cerr << "Error: Failed to load mask texture from path: " << maskImagePath << std::endl;
-                throw std::runtime_error("addLightEffect: Failed to load mask texture.");
+            // Headless runs have no GL context to load the mask into. Lighting is only composited on the GPU, so the
+            // light is kept without one.
+            Texture2D maskTexture{};
+            if (IsWindowReady()) {
+                maskTexture = LoadTexture(maskImagePath.c_str());
+                if (maskTexture.id == 0) {
+                    std::cerr << "Error: Failed to load mask texture from path: " << maskImagePath << std::endl;
+                    throw std::runtime_error("addLightEffect: Failed to load mask texture.");
+                }
             }
             // Create LightEffect
             graphics::LightEffect effect = {
@@ -747,7 +1010,7 @@ namespace blipcade::runtime {
 
             // Load mask texture if provided
             Texture2D maskTexture;
-            if (!maskImagePath.empty()) {
+            if (!maskImagePath.empty() && IsWindowReady()) {
                 maskTexture = LoadTexture(maskImagePath.c_str());
             } else {
                 // Retrieve existing mask texture or set a default
@@ -1157,6 +1420,14 @@ namespace blipcade::runtime {
         bindGetCollider(global);
         // bindCheckCollision(global);
         bindCheckCollisionPoint(global);
+        bindCheckCollisionPoints(global);
+        bindAddBody(global);
+        bindRemoveBody(global);
+        bindSetBodyPosition(global);
+        bindClearBodies(global);
+        bindQueryPoint(global);
+        bindQueryRect(global);
+        bindQuerySegment(global);
         // bindCheckCollisionCircle(global);
         // bindCheckCollisionCircleRec(global);
         // bindCheckCollisionRecs(global);
@@ -1284,283 +1555,1523 @@ namespace blipcade::runtime {
     }
 
     /**
-     * @namespace Pathfinding
-     *
-     * @description Provides pathfinding-related functionalities.
-     */
-    void JSBindings::bindPathfindingMethods(quickjs::value &global) {
-        createNamespace(global, "Pathfinding");
-
-        bindFindPath(global);
-        bindGetNavMesh(global);
-    }
-
-    /**
-     * @function findPath
+     * @function checkCollisionPoints
      *
-     * @param {number} startX - The x-coordinate of the starting point.
-     * @param {number} startY - The y-coordinate of the starting point.
-     * @param {number} endX - The x-coordinate of the ending point.
-     * @param {number} endY - The y-coordinate of the ending point.
-     * @param {string} navigationMeshPath - The path the navigation mesh resource to use.
+     * @param {Array} points - The points to check. Each point is an object with `x` and `y` properties.
+     * @param {string} resourcePath - The path of the resource of the collider to check.
      *
-     * @description Finds a path from the starting point to the ending point using the specified navigation mesh.
+     * @description Checks many points against one collider in a single call.
      *
-     * @returns {Array} - An array of points representing the path. Each point is an object with `x` and `y` properties.
+     * @returns {Array} - An array of booleans, `true` where the point at the same index collides with the collider.
      *
-     * @example Pathfinding.findPath(0, 0, 100, 100, "res://navmesh.json"); // Finds a path from (0, 0) to (100, 100) using the navigation mesh with the specified path.
+     * @example const hits = Collision.checkCollisionPoints(particles, "res://colliders/bookshelf.json");
      */
-    void JSBindings::bindFindPath(quickjs::value &global) {
-        auto pathfinding = global.get_property("Pathfinding");
+    void JSBindings::bindCheckCollisionPoints(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
 
-        pathfinding.set_property("findPath", [this](const quickjs::args &a) -> quickjs::value {
+        collision.set_property("checkCollisionPoints", [this](const quickjs::args &a) -> quickjs::value {
             std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
 
-            auto argsCount = a.size();
+            if (a.size() < 2) {
+                throw std::runtime_error("checkCollisionPoints: Missing arguments.");
+            }
 
-            if (argsCount < 5) {
-                std::cout << "argsCount: " << argsCount << std::endl;
-                throw std::runtime_error("findPath: Missing arguments.");
+            quickjs::value pointsValue = a[0];
+
+            if (!pointsValue.is_array()) {
+                throw quickjs::throw_exception(
+                    quickjs::value::type_error(a.get_context(), "First argument must be an array.")
+                );
             }
 
-            auto startX = a[0].as_int32();
-            auto startY = a[1].as_int32();
-            auto endX = a[2].as_int32();
-            auto endY = a[3].as_int32();
-            auto navigationMeshId = a[4].as_cstring().c_str();
+            const std::string colliderIndex = a[1].as_cstring().c_str();
 
-            auto navmeshes = m_runtime.getNavmeshes();
+            auto colliders = m_runtime.getColliders();
 
-            if (navmeshes->find(navigationMeshId) == navmeshes->end()) {
-                // throw std::runtime_error("findPath: Navigation mesh not found.");
-                std::cout << "findPath: Loading navmesh from resource: " << navigationMeshId << std::endl;
-                auto nm = collision::NavMesh::fromResource(navigationMeshId, m_runtime.getProject()->getDirectory());
-                m_runtime.getNavmeshes()->insert({navigationMeshId, nm});
+            if (colliders->find(colliderIndex) == colliders->end()) {
+                std::cout << "checkCollisionPoints: Loading collider from resource: " << colliderIndex << std::endl;
+                auto collider = collision::Collider::fromResource(colliderIndex, m_runtime.getProject()->getDirectory());
+                colliders->insert({colliderIndex, collider});
             }
 
-            auto navMesh = navmeshes->at(navigationMeshId);
+            const auto &collider = colliders->at(colliderIndex);
 
-            auto path = collision::Pathfinding::pathfind(startX, startY, endX, endY, navMesh, true);
+            uint32_t length = pointsValue.get_property("length").as_uint32();
 
-            quickjs::value Object = ctx->get_global_object().get_property("Object");
-            quickjs::value Array = ctx->get_global_object().get_property("Array");
-            quickjs::value pathArray = Array.call_member("from", 0);
-            for (const auto &point : path) {
-                quickjs::value pointObj = Object.call_member("create", quickjs::value::null(*ctx));
+            std::vector<Vector2> points;
+            points.reserve(length);
+            for (uint32_t i = 0; i < length; ++i) {
+                quickjs::value point = pointsValue.get_property(i);
 
-                pointObj.set_property("x", static_cast<double>(point.x));
-                pointObj.set_property("y", static_cast<double>(point.y));
+                points.push_back(Vector2{
+                    static_cast<float>(point.get_property("x").as_double()),
+                    static_cast<float>(point.get_property("y").as_double())
+                });
+            }
 
-                pathArray.call_member("push", pointObj);
+            std::vector<uint8_t> results(points.size());
+            collider.checkCollisionPoints(points.data(), points.size(), results.data());
+
+            quickjs::value Array = ctx->get_global_object().get_property("Array");
+            quickjs::value resultArray = Array.call_member("from", 0);
+
+            for (const auto result: results) {
+                resultArray.call_member("push", quickjs::value(*ctx, result != 0));
             }
 
-            return pathArray;
+            return resultArray;
         });
     }
 
     /**
-     * @function getNavMesh
+     * @function addBody
      *
-     * @param {string} resourcePath - The ID of the navigation mesh to get.
+     * @param {string} resourcePath - The path of the resource of the collider to place.
+     * @param {number} [x=0] - The x-offset of the collider in the world.
+     * @param {number} [y=0] - The y-offset of the collider in the world.
      *
-     * @description Gets the navigation mesh with the specified path.
+     * @description Places a collider into the collision world, so it can be found by `queryPoint`, `queryRect` and `querySegment`. The same collider resource can be placed several times.
      *
-     * @returns {Array} - An array of regions in the navigation mesh. Each region is an object with a `vertices` property containing an array of points.
+     * @returns {number} - The body id.
      *
-     * @example Pathfinding.getNavMesh("res://navmesh/navmesh.json"); // Gets the navigation mesh with the specified path.
+     * @example const body = Collision.addBody("res://colliders/door.json", 0, 0);
      */
-    void JSBindings::bindGetNavMesh(quickjs::value &global) {
-        auto pathfinding = global.get_property("Pathfinding");
+    void JSBindings::bindAddBody(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
 
-        pathfinding.set_property("getNavMesh", [this](const quickjs::args &a) -> quickjs::value {
+        collision.set_property("addBody", [this](const quickjs::args &a) -> quickjs::value {
             std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
 
             if (a.size() < 1) {
-                throw std::runtime_error("getNavMesh: Missing argument.");
+                throw std::runtime_error("addBody: Missing argument.");
             }
 
-            auto navMeshes = m_runtime.getNavmeshes();
-            auto const navMeshId = a[0].as_cstring();
-            auto const navMesh = navMeshes->at(navMeshId);
-
-            auto const regions = navMesh.regions;
-
-            quickjs::value Object = ctx->get_global_object().get_property("Object");
-
-            quickjs::value Array = ctx->get_global_object().get_property("Array");
-            quickjs::value pathArray = Array.call_member("from", 0);
+            const std::string colliderIndex = a[0].as_cstring().c_str();
+            auto x = a.size() > 1 ? a[1].as_double() : 0.0;
+            auto y = a.size() > 2 ? a[2].as_double() : 0.0;
 
-            for (const auto &region : regions) {
-                quickjs::value regionObj = Object.call_member("create", quickjs::value::null(*ctx));
-                quickjs::value verticesArray = Array.call_member("from", 0);
+            auto colliders = m_runtime.getColliders();
 
-                for (const auto &vertex : region->vertices) {
-                    quickjs::value vertexObj = Object.call_member("create", quickjs::value::null(*ctx));
+            if (colliders->find(colliderIndex) == colliders->end()) {
+                std::cout << "addBody: Loading collider from resource: " << colliderIndex << std::endl;
+                auto collider = collision::Collider::fromResource(colliderIndex, m_runtime.getProject()->getDirectory());
+                colliders->insert({colliderIndex, collider});
+            }
 
-                    vertexObj.set_property("x", static_cast<double>(vertex.x));
-                    vertexObj.set_property("y", static_cast<double>(vertex.y));
+            auto const id = m_runtime.getCollisionWorld()->addBody(
+                colliders->at(colliderIndex), Vector2{static_cast<float>(x), static_cast<float>(y)});
 
-                    verticesArray.call_member("push", vertexObj);
-                }
+            return {*ctx, id};
+        });
+    }
 
-                regionObj.set_property("vertices", verticesArray);
+    /**
+     * @function removeBody
+     *
+     * @param {number} id - The body id returned by `addBody`.
+     *
+     * @description Removes a body from the collision world.
+     *
+     * @example Collision.removeBody(body);
+     */
+    void JSBindings::bindRemoveBody(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
 
-                pathArray.call_member("push", regionObj);
+        collision.set_property("removeBody", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("removeBody: Missing argument.");
             }
 
-            return pathArray;
+            m_runtime.getCollisionWorld()->removeBody(a[0].as_uint32());
         });
     }
 
     /**
-     * @namespace Sound
+     * @function setBodyPosition
      *
-     * @description Provides sound-related functionalities.
+     * @param {number} id - The body id returned by `addBody`.
+     * @param {number} x - The new x-offset of the collider.
+     * @param {number} y - The new y-offset of the collider.
+     *
+     * @description Moves a body in the collision world.
+     *
+     * @example Collision.setBodyPosition(body, player.x, player.y);
      */
-    void JSBindings::bindSoundMethods(quickjs::value &global) {
-        createNamespace(global, "Sound");
+    void JSBindings::bindSetBodyPosition(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
 
-        bindLoadSound(global);
-        bindPlaySound(global);
-        bindStopSound(global);
-        bindToggleSound(global);
+        collision.set_property("setBodyPosition", [this](const quickjs::args &a) {
+            if (a.size() < 3) {
+                throw std::runtime_error("setBodyPosition: Missing arguments.");
+            }
 
-        bindSetSoundVolume(global);
+            auto const id = a[0].as_uint32();
+            auto const x = static_cast<float>(a[1].as_double());
+            auto const y = static_cast<float>(a[2].as_double());
+
+            m_runtime.getCollisionWorld()->setBodyPosition(id, Vector2{x, y});
+        });
     }
 
     /**
-     * @function loadSound
+     * @function clearBodies
      *
-     * @param {string} path - The path to the sound file.
+     * @description Removes every body from the collision world, e.g. when a level is unloaded.
      *
-     * @description Loads a sound file.
+     * @example Collision.clearBodies();
+     */
+    void JSBindings::bindClearBodies(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
+
+        collision.set_property("clearBodies", [this](const quickjs::args &a) {
+            m_runtime.getCollisionWorld()->clear();
+        });
+    }
+
+    /**
+     * @function queryPoint
+     *
+     * @param {number} x - The x-coordinate of the point.
+     * @param {number} y - The y-coordinate of the point.
+     *
+     * @description Finds every body in the collision world containing the point.
+     *
+     * @returns {Array} - The ids of the hit bodies, in ascending order.
+     *
+     * @example const hits = Collision.queryPoint(mouse.x, mouse.y);
+     */
+    void JSBindings::bindQueryPoint(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
+
+        collision.set_property("queryPoint", [this](const quickjs::args &a) -> quickjs::value {
+            if (a.size() < 2) {
+                throw std::runtime_error("queryPoint: Missing arguments.");
+            }
+
+            auto const x = static_cast<float>(a[0].as_double());
+            auto const y = static_cast<float>(a[1].as_double());
+
+            return makeBodyIdArray(m_runtime.getCollisionWorld()->queryPoint(Vector2{x, y}));
+        });
+    }
+
+    /**
+     * @function queryRect
+     *
+     * @param {number} x - The x-coordinate of the rectangle.
+     * @param {number} y - The y-coordinate of the rectangle.
+     * @param {number} width - The width of the rectangle.
+     * @param {number} height - The height of the rectangle.
+     *
+     * @description Finds every body in the collision world overlapping the rectangle.
+     *
+     * @returns {Array} - The ids of the hit bodies, in ascending order.
+     *
+     * @example const hits = Collision.queryRect(player.x - 8, player.y - 8, 16, 16);
+     */
+    void JSBindings::bindQueryRect(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
+
+        collision.set_property("queryRect", [this](const quickjs::args &a) -> quickjs::value {
+            if (a.size() < 4) {
+                throw std::runtime_error("queryRect: Missing arguments.");
+            }
+
+            auto const rec = Rectangle{
+                static_cast<float>(a[0].as_double()), static_cast<float>(a[1].as_double()),
+                static_cast<float>(a[2].as_double()), static_cast<float>(a[3].as_double())
+            };
+
+            return makeBodyIdArray(m_runtime.getCollisionWorld()->queryRec(rec));
+        });
+    }
+
+    /**
+     * @function querySegment
+     *
+     * @param {number} x1 - The x-coordinate of the segment start.
+     * @param {number} y1 - The y-coordinate of the segment start.
+     * @param {number} x2 - The x-coordinate of the segment end.
+     * @param {number} y2 - The y-coordinate of the segment end.
+     *
+     * @description Finds every body in the collision world touched by the segment.
+     *
+     * @returns {Array} - The ids of the hit bodies, in ascending order.
+     *
+     * @example const hits = Collision.querySegment(npc.x, npc.y, player.x, player.y);
+     */
+    void JSBindings::bindQuerySegment(quickjs::value &global) {
+        auto collision = global.get_property("Collision");
+
+        collision.set_property("querySegment", [this](const quickjs::args &a) -> quickjs::value {
+            if (a.size() < 4) {
+                throw std::runtime_error("querySegment: Missing arguments.");
+            }
+
+            auto const start = Vector2{static_cast<float>(a[0].as_double()), static_cast<float>(a[1].as_double())};
+            auto const end = Vector2{static_cast<float>(a[2].as_double()), static_cast<float>(a[3].as_double())};
+
+            return makeBodyIdArray(m_runtime.getCollisionWorld()->querySegment(start, end));
+        });
+    }
+
+    quickjs::value JSBindings::makeBodyIdArray(const std::vector<uint32_t> &ids) const {
+        std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+        quickjs::value Array = ctx->get_global_object().get_property("Array");
+        quickjs::value idArray = Array.call_member("from", 0);
+
+        for (const auto id: ids) {
+            idArray.call_member("push", quickjs::value(*ctx, id));
+        }
+
+        return idArray;
+    }
+
+    /**
+     * @namespace Pathfinding
+     *
+     * @description Provides pathfinding-related functionalities.
+     */
+    void JSBindings::bindPathfindingMethods(quickjs::value &global) {
+        createNamespace(global, "Pathfinding");
+
+        bindFindPath(global);
+        bindGetNavMesh(global);
+        bindGetPathCacheStats(global);
+        bindBuildNavMeshHierarchy(global);
+        bindRaycastNavMesh(global);
+        bindHasLineOfSight(global);
+        bindSweepCircleNavMesh(global);
+    }
+
+    /**
+     * @function findPath
+     *
+     * @param {number} startX - The x-coordinate of the starting point.
+     * @param {number} startY - The y-coordinate of the starting point.
+     * @param {number} endX - The x-coordinate of the ending point.
+     * @param {number} endY - The y-coordinate of the ending point.
+     * @param {string} navigationMeshPath - The path the navigation mesh resource to use.
+     *
+     * @description Finds a path from the starting point to the ending point using the specified navigation mesh.
+     *
+     * @returns {Array} - An array of points representing the path. Each point is an object with `x` and `y` properties.
+     *
+     * @example Pathfinding.findPath(0, 0, 100, 100, "res://navmesh.json"); // Finds a path from (0, 0) to (100, 100) using the navigation mesh with the specified path.
+     */
+    void JSBindings::bindFindPath(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("findPath", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            auto argsCount = a.size();
+
+            if (argsCount < 5) {
+                std::cout << "argsCount: " << argsCount << std::endl;
+                throw std::runtime_error("findPath: Missing arguments.");
+            }
+
+            auto startX = a[0].as_int32();
+            auto startY = a[1].as_int32();
+            auto endX = a[2].as_int32();
+            auto endY = a[3].as_int32();
+            const std::string navigationMeshId = a[4].as_cstring().c_str();
+
+            // Take a reference: the navmesh owns the path cache, a copy would start cold every call
+            const auto &navMesh = loadNavMesh(navigationMeshId);
+
+            auto path = collision::Pathfinding::pathfind(startX, startY, endX, endY, navMesh, true);
+
+            quickjs::value Object = ctx->get_global_object().get_property("Object");
+            quickjs::value Array = ctx->get_global_object().get_property("Array");
+            quickjs::value pathArray = Array.call_member("from", 0);
+            for (const auto &point : path) {
+                quickjs::value pointObj = Object.call_member("create", quickjs::value::null(*ctx));
+
+                pointObj.set_property("x", static_cast<double>(point.x));
+                pointObj.set_property("y", static_cast<double>(point.y));
+
+                pathArray.call_member("push", pointObj);
+            }
+
+            return pathArray;
+        });
+    }
+
+    /**
+     * @function getNavMesh
+     *
+     * @param {string} resourcePath - The ID of the navigation mesh to get.
+     *
+     * @description Gets the navigation mesh with the specified path.
+     *
+     * @returns {Array} - An array of regions in the navigation mesh. Each region is an object with a `vertices` property containing an array of points.
+     *
+     * @example Pathfinding.getNavMesh("res://navmesh/navmesh.json"); // Gets the navigation mesh with the specified path.
+     */
+    void JSBindings::bindGetNavMesh(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("getNavMesh", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 1) {
+                throw std::runtime_error("getNavMesh: Missing argument.");
+            }
+
+            auto navMeshes = m_runtime.getNavmeshes();
+            auto const navMeshId = a[0].as_cstring();
+            auto const navMesh = navMeshes->at(navMeshId);
+
+            auto const regions = navMesh.regions;
+
+            quickjs::value Object = ctx->get_global_object().get_property("Object");
+
+            quickjs::value Array = ctx->get_global_object().get_property("Array");
+            quickjs::value pathArray = Array.call_member("from", 0);
+
+            for (const auto &region : regions) {
+                quickjs::value regionObj = Object.call_member("create", quickjs::value::null(*ctx));
+                quickjs::value verticesArray = Array.call_member("from", 0);
+
+                for (const auto &vertex : region->vertices) {
+                    quickjs::value vertexObj = Object.call_member("create", quickjs::value::null(*ctx));
+
+                    vertexObj.set_property("x", static_cast<double>(vertex.x));
+                    vertexObj.set_property("y", static_cast<double>(vertex.y));
+
+                    verticesArray.call_member("push", vertexObj);
+                }
+
+                regionObj.set_property("vertices", verticesArray);
+
+                pathArray.call_member("push", regionObj);
+            }
+
+            return pathArray;
+        });
+    }
+
+    /**
+     * @function getPathCacheStats
+     *
+     * @param {string} navigationMeshPath - The path of the navigation mesh resource.
+     *
+     * @description Gets the path cache counters of the navigation mesh. Repeated `findPath` queries between the same regions and points are served from this cache.
+     *
+     * @returns {object} - An object with `hits`, `misses`, `evictions`, `invalidations`, `size` and `capacity` properties.
+     *
+     * @example const stats = Pathfinding.getPathCacheStats("res://navmesh.json"); log(`${stats.hits}/${stats.misses}`);
+     */
+    void JSBindings::bindGetPathCacheStats(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("getPathCacheStats", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 1) {
+                throw std::runtime_error("getPathCacheStats: Missing argument.");
+            }
+
+            auto const &navMesh = loadNavMesh(a[0].as_cstring().c_str());
+
+            auto const stats = navMesh.getPathCache().getStats();
+
+            quickjs::value Object = ctx->get_global_object().get_property("Object");
+            quickjs::value statsObj = Object.call_member("create", quickjs::value::null(*ctx));
+
+            statsObj.set_property("hits", static_cast<double>(stats.hits));
+            statsObj.set_property("misses", static_cast<double>(stats.misses));
+            statsObj.set_property("evictions", static_cast<double>(stats.evictions));
+            statsObj.set_property("invalidations", static_cast<double>(stats.invalidations));
+            statsObj.set_property("size", static_cast<double>(stats.size));
+            statsObj.set_property("capacity", static_cast<double>(stats.capacity));
+
+            return statsObj;
+        });
+    }
+
+    /**
+     * @function buildNavMeshHierarchy
+     *
+     * @param {string} navigationMeshPath - The path of the navigation mesh resource.
+     * @param {number} [maxClusterSize=16] - The maximum number of regions grouped into one cluster.
+     *
+     * @description Builds the hierarchical layer of the navigation mesh. Long-distance `findPath` queries then search the cluster graph first and refine locally. Meshes with 64 or more regions get one automatically on load.
+     *
+     * @returns {number} - The number of clusters built.
+     *
+     * @example Pathfinding.buildNavMeshHierarchy("res://navmesh.json", 8);
+     */
+    void JSBindings::bindBuildNavMeshHierarchy(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("buildNavMeshHierarchy", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 1) {
+                throw std::runtime_error("buildNavMeshHierarchy: Missing argument.");
+            }
+
+            auto &navMesh = loadNavMesh(a[0].as_cstring().c_str());
+
+            auto const maxClusterSize = a.size() > 1 ? a[1].as_uint32() : 16;
+
+            navMesh.buildHierarchy(maxClusterSize);
+
+            return quickjs::value(*ctx, static_cast<uint32_t>(navMesh.getHierarchy()->getClusterCount()));
+        });
+    }
+
+    /**
+     * @function raycastNavMesh
+     *
+     * @param {number} x1 - The x-coordinate of the ray start.
+     * @param {number} y1 - The y-coordinate of the ray start.
+     * @param {number} x2 - The x-coordinate of the ray end.
+     * @param {number} y2 - The y-coordinate of the ray end.
+     * @param {string} navigationMeshPath - The path of the navigation mesh resource.
+     *
+     * @description Finds the first navigation mesh boundary edge crossed between the two points.
+     *
+     * @returns {object} - `null` when nothing is hit, otherwise an object with `x`, `y`, `normalX`, `normalY` and `distance` properties.
+     *
+     * @example const hit = Pathfinding.raycastNavMesh(npc.x, npc.y, player.x, player.y, "res://navmesh.json");
+     */
+    void JSBindings::bindRaycastNavMesh(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("raycastNavMesh", [this](const quickjs::args &a) -> quickjs::value {
+            if (a.size() < 5) {
+                throw std::runtime_error("raycastNavMesh: Missing arguments.");
+            }
+
+            auto const start = Vector2{static_cast<float>(a[0].as_double()), static_cast<float>(a[1].as_double())};
+            auto const end = Vector2{static_cast<float>(a[2].as_double()), static_cast<float>(a[3].as_double())};
+            const std::string navigationMeshId = a[4].as_cstring().c_str();
+
+            auto const hit = loadNavMesh(navigationMeshId).raycastOutline(start, end);
+
+            return makeOutlineHit(hit ? &*hit : nullptr, Vector2Distance(start, end));
+        });
+    }
+
+    /**
+     * @function hasLineOfSight
+     *
+     * @param {number} x1 - The x-coordinate of the first point.
+     * @param {number} y1 - The y-coordinate of the first point.
+     * @param {number} x2 - The x-coordinate of the second point.
+     * @param {number} y2 - The y-coordinate of the second point.
+     * @param {string} navigationMeshPath - The path of the navigation mesh resource.
+     *
+     * @description Checks whether the straight segment between the two points stays clear of the navigation mesh boundary.
+     *
+     * @returns {boolean} - `true` if no boundary edge is crossed, `false` otherwise.
+     *
+     * @example if (Pathfinding.hasLineOfSight(npc.x, npc.y, player.x, player.y, "res://navmesh.json")) { chase(); }
+     */
+    void JSBindings::bindHasLineOfSight(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("hasLineOfSight", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 5) {
+                throw std::runtime_error("hasLineOfSight: Missing arguments.");
+            }
+
+            auto const start = Vector2{static_cast<float>(a[0].as_double()), static_cast<float>(a[1].as_double())};
+            auto const end = Vector2{static_cast<float>(a[2].as_double()), static_cast<float>(a[3].as_double())};
+            const std::string navigationMeshId = a[4].as_cstring().c_str();
+
+            auto const crossing = loadNavMesh(navigationMeshId).isSegmentCrossingOutline(start, end);
+
+            return {*ctx, !crossing};
+        });
+    }
+
+    /**
+     * @function sweepCircleNavMesh
+     *
+     * @param {number} x1 - The x-coordinate of the circle start.
+     * @param {number} y1 - The y-coordinate of the circle start.
+     * @param {number} x2 - The x-coordinate of the circle end.
+     * @param {number} y2 - The y-coordinate of the circle end.
+     * @param {number} radius - The radius of the circle.
+     * @param {string} navigationMeshPath - The path of the navigation mesh resource.
+     *
+     * @description Moves a circle from the start to the end point and finds where it first touches the navigation mesh boundary.
+     *
+     * @returns {object} - `null` when the move is clear, otherwise an object with `x`, `y` (circle center at contact), `normalX`, `normalY` and `distance` properties.
+     *
+     * @example const hit = Pathfinding.sweepCircleNavMesh(x, y, x + dx, y + dy, 4, "res://navmesh.json");
+     */
+    void JSBindings::bindSweepCircleNavMesh(quickjs::value &global) {
+        auto pathfinding = global.get_property("Pathfinding");
+
+        pathfinding.set_property("sweepCircleNavMesh", [this](const quickjs::args &a) -> quickjs::value {
+            if (a.size() < 6) {
+                throw std::runtime_error("sweepCircleNavMesh: Missing arguments.");
+            }
+
+            auto const start = Vector2{static_cast<float>(a[0].as_double()), static_cast<float>(a[1].as_double())};
+            auto const end = Vector2{static_cast<float>(a[2].as_double()), static_cast<float>(a[3].as_double())};
+            auto const radius = static_cast<float>(a[4].as_double());
+            const std::string navigationMeshId = a[5].as_cstring().c_str();
+
+            auto const hit = loadNavMesh(navigationMeshId).sweepCircleOutline(start, end, radius);
+
+            return makeOutlineHit(hit ? &*hit : nullptr, Vector2Distance(start, end));
+        });
+    }
+
+    collision::NavMesh &JSBindings::loadNavMesh(const std::string &navigationMeshId) {
+        auto navmeshes = m_runtime.getNavmeshes();
+
+        if (navmeshes->find(navigationMeshId) == navmeshes->end()) {
+            std::cout << "Loading navmesh from resource: " << navigationMeshId << std::endl;
+            auto nm = collision::NavMesh::fromResource(navigationMeshId, m_runtime.getProject()->getDirectory());
+            navmeshes->insert({navigationMeshId, nm});
+        }
+
+        return navmeshes->at(navigationMeshId);
+    }
+
+    quickjs::value JSBindings::makeOutlineHit(const collision::OutlineHit *hit, const float length) const {
+        std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+        if (hit == nullptr) {
+            return quickjs::value::null(*ctx);
+        }
+
+        quickjs::value Object = ctx->get_global_object().get_property("Object");
+        quickjs::value hitObj = Object.call_member("create", quickjs::value::null(*ctx));
+
+        hitObj.set_property("x", static_cast<double>(hit->point.x));
+        hitObj.set_property("y", static_cast<double>(hit->point.y));
+        hitObj.set_property("normalX", static_cast<double>(hit->normal.x));
+        hitObj.set_property("normalY", static_cast<double>(hit->normal.y));
+        hitObj.set_property("distance", static_cast<double>(hit->t * length));
+
+        return hitObj;
+    }
+
+    /**
+     * @namespace Sound
+     *
+     * @description Provides sound-related functionalities.
+     */
+    void JSBindings::bindSoundMethods(quickjs::value &global) {
+        createNamespace(global, "Sound");
+
+        bindLoadSound(global);
+        bindPlaySound(global);
+        bindPlaySoundAt(global);
+        bindStopSound(global);
+        bindToggleSound(global);
+        bindStopVoice(global);
+
+        bindSetSoundVolume(global);
+        bindSetVoiceParams(global);
+        bindSetVoicePosition(global);
+
+        bindCreateBus(global);
+        bindGetBus(global);
+        bindSetBusVolume(global);
+        bindAddBusEffect(global);
+        bindClearBusEffects(global);
+        bindSetSoundBus(global);
+        bindSetSoundSend(global);
+        bindSetVoiceSend(global);
+
+        bindPlayMusic(global);
+        bindStopMusic(global);
+        bindSetMusicVolume(global);
+        bindIsMusicPlaying(global);
+
+        bindCreateInstrument(global);
+        bindPlayNote(global);
+        bindPlaySequence(global);
+
+        bindGetAudioStats(global);
+        bindResetAudioStats(global);
+    }
+
+    /**
+     * @function getStats
+     *
+     * @description Gets what the audio engine measured about itself since it started or was last reset. Times are in
+     * milliseconds. `callbackHistogram` counts mixer callbacks by the share of their budget they took (the time their
+     * audio takes to play): each bucket holds callbacks `below` its bound, the last one those over budget. `load` is
+     * mixing time over mixed time, `underruns` the callbacks over budget (heard as gaps), `streamUnderruns` the
+     * blocks music ran short, and `buses` the effect time of every bus. `JSON.stringify` the result to log it.
+     *
+     * @returns {object} - An object with `callbacks`, `mixedTime`, `callbackHistogram`, `lastCallbackTime`,
+     * `worstCallbackTime`, `load`, `underruns`, `streamUnderruns`, `activeVoices`, `peakVoices`, `culledVoices`,
+     * `maxVoices`, `stolenVoices`, `droppedVoices`, `droppedCommands`, `headless`, `musicPlaying` and `buses`.
+     *
+     * @example const stats = Sound.getStats(); if (stats.underruns > 0) log(JSON.stringify(stats));
+     */
+    void JSBindings::bindGetAudioStats(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("getStats", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            const auto stats = m_runtime.getAudio()->GetStatsJson().dump();
+
+            quickjs::value json = ctx->get_global_object().get_property("JSON");
+            return json.call_member("parse", stats);
+        });
+    }
+
+    /**
+     * @function resetStats
+     *
+     * @description Zeroes the audio engine's counters, histogram and peaks, e.g. to measure one scene on its own.
+     *
+     * @example Sound.resetStats();
+     */
+    void JSBindings::bindResetAudioStats(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("resetStats", [this](const quickjs::args &a) {
+            m_runtime.getAudio()->ResetStats();
+        });
+    }
+
+    /**
+     * @function loadSound
+     *
+     * @param {string} path - The path to the sound file.
+     *
+     * @description Loads a sound file.
+     *
+     * @returns {number} - The ID of the loaded sound.
+     *
+     * @example const sound = Sound.loadSound("assets/sounds/jump.wav"); // Loads the sound file.
+     */
+    void JSBindings::bindLoadSound(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("loadSound", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("loadSound: Missing argument.");
+            }
+
+
+            std::string path = a[0].as_cstring().c_str();
+
+            // If path starts with 'res://', load from project directory
+            if (path.find("res://") == 0) {
+                path = m_runtime.getProject()->getDirectory() / path.substr(6);
+                std::cout << "Loading sound from project directory: " << path << std::endl;
+            }
+
+            auto soundId = m_runtime.getAudio()->LoadSound(path);
+
+            return {*ctx, static_cast<double>(soundId)};
+        });
+    }
+
+    /**
+     * @function playSound
+     *
+     * @param {number} soundId - The ID of the sound to play.
+     * @param {number} [volume=1] - The volume of this instance (0.0 to 1.0).
+     * @param {number} [pan=0] - Stereo position, from -1 (left) to 1 (right).
+     * @param {number} [pitch=1] - Playback rate; 2 plays an octave higher. Clamped to 0.01-8.
+     * @param {boolean} [loop=false] - Whether the instance repeats until stopped.
+     * @param {number} [delay=0] - Seconds to wait before starting, timed to the sample on the audio thread.
+     *
+     * @description Plays a sound. Each call starts a new instance, so the same sound can overlap itself.
+     *
+     * @returns {number} - The ID of the playing instance, or 0 if no voice was free.
+     *
+     * @example const voice = Sound.playSound(soundId, 0.8, -0.5); // Plays the sound slightly to the left.
+     */
+    void JSBindings::bindPlaySound(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("playSound", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("playSound: Missing argument.");
+            }
+
+            auto soundId = a[0].as_uint32();
+
+            audio::VoiceParams params;
+            if (argsCount >= 2) params.gain = static_cast<float>(a[1].as_double());
+            if (argsCount >= 3) params.pan = static_cast<float>(a[2].as_double());
+            if (argsCount >= 4) params.pitch = static_cast<float>(a[3].as_double());
+            if (argsCount >= 5) params.loop = a[4].as_bool();
+
+            float delay = 0.0f;
+            if (argsCount >= 6) delay = static_cast<float>(a[5].as_double());
+
+            const auto voice = m_runtime.getAudio()->PlaySound(soundId, params, delay);
+
+            return {*ctx, static_cast<double>(voice)};
+        });
+    }
+
+    /**
+     * @function playSoundAt
+     *
+     * @param {number} soundId - The ID of the sound to play.
+     * @param {number} x - The x-coordinate of the sound in the world.
+     * @param {number} y - The y-coordinate of the sound in the world.
+     * @param {number} radius - Distance from the listener at which the sound can no longer be heard.
+     * @param {number} [falloff=1] - How quickly the sound fades with distance; 1 is linear, higher is steeper.
+     * @param {number} [volume=1] - The volume of this instance (0.0 to 1.0).
+     * @param {boolean} [loop=false] - Whether the instance repeats until stopped.
+     *
+     * @description Plays a sound at a point in the world. It is louder the closer it is to the middle of the screen
+     * and panned to the side it is on, following the camera. Out of range it costs no mixing time. Entities with an
+     * `AudioEmitter` component (`{sound, x, y, radius, falloff, volume, loop}`, `radius` defaulting to the canvas width)
+     * get such a voice automatically; a looping one is restarted if another sound steals its voice, trying again
+     * every 30 frames while none is free.
+     *
+     * @returns {number} - The ID of the playing instance, or 0 if no voice was free.
+     *
+     * @example const fire = Sound.playSoundAt(crackle, 120, 180, 160, 2, 1, true);
+     */
+    void JSBindings::bindPlaySoundAt(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("playSoundAt", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            auto argsCount = a.size();
+
+            if (argsCount < 4) {
+                throw std::runtime_error("playSoundAt: Missing argument(s).");
+            }
+
+            auto soundId = a[0].as_uint32();
+
+            audio::Emitter emitter;
+            emitter.x = static_cast<float>(a[1].as_double());
+            emitter.y = static_cast<float>(a[2].as_double());
+            emitter.radius = static_cast<float>(a[3].as_double());
+            if (argsCount >= 5) emitter.falloff = static_cast<float>(a[4].as_double());
+
+            audio::VoiceParams params;
+            if (argsCount >= 6) params.gain = static_cast<float>(a[5].as_double());
+            if (argsCount >= 7) params.loop = a[6].as_bool();
+
+            const auto voice = m_runtime.getAudio()->PlaySoundAt(soundId, emitter, params);
+
+            return {*ctx, static_cast<double>(voice)};
+        });
+    }
+
+    /**
+     * @function stopSound
+     *
+     * @param {number} soundId - The ID of the sound to stop.
+     *
+     * @description Stops a sound.
+     *
+     * @example Sound.stopSound(soundId); // Stops the sound with the given ID.
+     */
+    void JSBindings::bindStopSound(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("stopSound", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("stopSound: Missing argument.");
+            }
+
+            auto soundId = a[0].as_uint32();
+            m_runtime.getAudio()->StopSound(soundId);
+        });
+    }
+
+    /**
+     * @function toggleSound
+     *
+     * @param {number} soundId - The ID of the sound to toggle.
+     *
+     * @description Toggles a sound.
+     *
+     * @example Sound.toggleSound(soundId); // Toggles the sound with the given ID.
+     */
+    void JSBindings::bindToggleSound(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("toggleSound", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("toggleSound: Missing argument.");
+            }
+
+            auto soundId = a[0].as_uint32();
+            m_runtime.getAudio()->ToggleSound(soundId);
+        });
+    }
+
+    /**
+     * @function stopVoice
+     *
+     * @param {number} voiceId - The instance ID returned by `playSound`.
+     *
+     * @description Stops one playing instance of a sound. Does nothing if it already ended.
+     *
+     * @example Sound.stopVoice(voice);
+     */
+    void JSBindings::bindStopVoice(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("stopVoice", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("stopVoice: Missing argument.");
+            }
+
+            m_runtime.getAudio()->StopVoice(a[0].as_uint32());
+        });
+    }
+
+    /**
+     * @function setVoiceParams
+     *
+     * @param {number} voiceId - The instance ID returned by `playSound`.
+     * @param {number} volume - The volume of this instance (0.0 to 1.0).
+     * @param {number} [pan=0] - Stereo position, from -1 (left) to 1 (right).
+     * @param {number} [pitch=1] - Playback rate; 2 plays an octave higher. Clamped to 0.01-8.
+     *
+     * @description Changes one playing instance of a sound. Does nothing if it already ended.
+     *
+     * @example Sound.setVoiceParams(voice, 0.5, 1.0, 1.0); // Half volume, hard right.
+     */
+    void JSBindings::bindSetVoiceParams(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setVoiceParams", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 2) {
+                throw std::runtime_error("setVoiceParams: Missing arguments.");
+            }
+
+            auto voiceId = a[0].as_uint32();
+            auto volume = static_cast<float>(a[1].as_double());
+            auto pan = argsCount >= 3 ? static_cast<float>(a[2].as_double()) : 0.0f;
+            auto pitch = argsCount >= 4 ? static_cast<float>(a[3].as_double()) : 1.0f;
+
+            m_runtime.getAudio()->SetVoiceParams(voiceId, volume, pan, pitch);
+        });
+    }
+
+    /**
+     * @function setVoicePosition
+     *
+     * @param {number} voiceId - The instance ID returned by `playSoundAt`.
+     * @param {number} x - The new x-coordinate in the world.
+     * @param {number} y - The new y-coordinate in the world.
+     *
+     * @description Moves a sound played with `playSoundAt`. Does nothing for other instances or if it already ended.
+     *
+     * @example Sound.setVoicePosition(engine, car.x, car.y);
+     */
+    void JSBindings::bindSetVoicePosition(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setVoicePosition", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 3) {
+                throw std::runtime_error("setVoicePosition: Missing arguments.");
+            }
+
+            auto voiceId = a[0].as_uint32();
+            auto x = static_cast<float>(a[1].as_double());
+            auto y = static_cast<float>(a[2].as_double());
+
+            m_runtime.getAudio()->SetVoicePosition(voiceId, x, y);
+        });
+    }
+
+    /**
+     * @function setSoundVolume
+     *
+     * @param {number} soundId - The ID of the sound to set the volume for.
+     * @param {number} volume - The volume to set (0.0 to 1.0).
      *
-     * @returns {number} - The ID of the loaded sound.
+     * @description Sets the volume of a sound.
      *
-     * @example const sound = Sound.loadSound("assets/sounds/jump.wav"); // Loads the sound file.
+     * @example Sound.setSoundVolume(soundId, 0.5); // Sets the volume of the sound with the given ID to 0.5.
      */
-    void JSBindings::bindLoadSound(quickjs::value &global) {
+    void JSBindings::bindSetSoundVolume(quickjs::value &global) {
         auto sound = global.get_property("Sound");
 
-        sound.set_property("loadSound", [this](const quickjs::args &a) -> quickjs::value {
+        sound.set_property("setSoundVolume", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 2) {
+                throw std::runtime_error("setSoundVolume: Missing arguments.");
+            }
+
+            auto soundId = a[0].as_uint32();
+            auto volume = a[1].as_double();
+            m_runtime.getAudio()->SetSoundVolume(soundId, volume);
+        });
+    }
+
+    uint32_t JSBindings::resolveBus(const quickjs::value &bus, const std::string &caller) const {
+        if (!bus.is_string()) {
+            return bus.as_uint32();
+        }
+
+        const std::string name = bus.as_cstring().c_str();
+        const auto handle = m_runtime.getAudio()->FindBus(name);
+
+        if (handle == audio::NO_BUS) {
+            throw std::runtime_error(caller + ": Unknown bus '" + name + "'.");
+        }
+
+        return handle;
+    }
+
+    /**
+     * @function createBus
+     *
+     * @param {string} name - The name of the bus.
+     *
+     * @description Creates a mixer bus, e.g. a shared room reverb that sounds send to. `music`, `sfx`, `ambience` and
+     * `ui` always exist. Creating a bus whose name is taken returns the existing one.
+     *
+     * @returns {number} - The ID of the bus.
+     *
+     * @example const cave = Sound.createBus("cave");
+     */
+    void JSBindings::bindCreateBus(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("createBus", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            if (a.size() < 1) {
+                throw std::runtime_error("createBus: Missing argument.");
+            }
+
+            const auto bus = m_runtime.getAudio()->CreateBus(a[0].as_cstring().c_str());
+            if (bus == audio::NO_BUS) {
+                throw std::runtime_error("createBus: Too many buses.");
+            }
+
+            return {*ctx, static_cast<double>(bus)};
+        });
+    }
+
+    /**
+     * @function getBus
+     *
+     * @param {string} name - The name of the bus: `music`, `sfx`, `ambience`, `ui`, `master` or a created bus.
+     *
+     * @description Looks up a mixer bus by name. Every function taking a bus also accepts its name directly.
+     *
+     * @returns {number} - The ID of the bus, or -1 if there is none.
+     *
+     * @example const music = Sound.getBus("music");
+     */
+    void JSBindings::bindGetBus(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("getBus", [this](const quickjs::args &a) -> quickjs::value {
             std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
 
+            if (a.size() < 1) {
+                throw std::runtime_error("getBus: Missing argument.");
+            }
+
+            const auto bus = m_runtime.getAudio()->FindBus(a[0].as_cstring().c_str());
+
+            return {*ctx, bus == audio::NO_BUS ? -1.0 : static_cast<double>(bus)};
+        });
+    }
+
+    /**
+     * @function setBusVolume
+     *
+     * @param {number|string} bus - The bus ID or name.
+     * @param {number} volume - The volume to set (0.0 to 1.0).
+     *
+     * @description Sets the volume of everything playing through a bus.
+     *
+     * @example Sound.setBusVolume("music", 0.4);
+     */
+    void JSBindings::bindSetBusVolume(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setBusVolume", [this](const quickjs::args &a) {
+            if (a.size() < 2) {
+                throw std::runtime_error("setBusVolume: Missing arguments.");
+            }
+
+            const auto bus = resolveBus(a[0], "setBusVolume");
+            m_runtime.getAudio()->SetBusVolume(bus, static_cast<float>(a[1].as_double()));
+        });
+    }
+
+    /**
+     * @function addBusEffect
+     *
+     * @param {number|string} bus - The bus ID or name.
+     * @param {string} type - `reverb`, `echo`, `lowpass` or `compressor`.
+     * @param {object} [params={}] - Effect parameters. reverb: `mix` (0 to 1), `feedback` (-0.95 to 0.95).
+     * echo: `delay` (seconds, up to 2), `feedback` (-0.95 to 0.95), `mix` (0 to 1). lowpass: `cutoff` (Hz).
+     * compressor: `threshold` (dB), `ratio`, `attack` and `release` (seconds), `makeup` (dB).
+     *
+     * @description Appends an effect to a bus. Effects run in the order they were added. Out-of-range parameters are
+     * clamped; parameters that are not finite numbers throw.
+     *
+     * @example Sound.addBusEffect("ambience", "lowpass", { cutoff: 800 });
+     */
+    void JSBindings::bindAddBusEffect(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("addBusEffect", [this](const quickjs::args &a) {
             auto argsCount = a.size();
 
-            if (argsCount < 1) {
-                throw std::runtime_error("loadSound: Missing argument.");
+            if (argsCount < 2) {
+                throw std::runtime_error("addBusEffect: Missing arguments.");
+            }
+
+            const auto bus = resolveBus(a[0], "addBusEffect");
+            const std::string type = a[1].as_cstring().c_str();
+
+            quickjs::value params = argsCount >= 3 ? a[2] : quickjs::value();
+            const auto param = [&params](const char *name, const float fallback) {
+                if (!params.is_object()) {
+                    return fallback;
+                }
+
+                quickjs::value value = params.get_property(name);
+                if (value.is_undefined()) {
+                    return fallback;
+                }
+
+                const auto number = value.as_double();
+                if (!std::isfinite(number)) {
+                    throw std::runtime_error(std::string("addBusEffect: Parameter '") + name +
+                                             "' must be a finite number.");
+                }
+                return static_cast<float>(number);
+            };
+
+            std::unique_ptr<audio::Effect> effect;
+
+            if (type == "reverb") {
+                effect = std::make_unique<audio::Reverb>(param("mix", 0.3f), param("feedback", 0.5f));
+            } else if (type == "echo") {
+                effect = std::make_unique<audio::Echo>(param("delay", 0.3f), param("feedback", 0.5f),
+                                                       param("mix", 0.3f));
+            } else if (type == "lowpass") {
+                effect = std::make_unique<audio::LowPass>(param("cutoff", 1000.0f));
+            } else if (type == "compressor") {
+                effect = std::make_unique<audio::Compressor>(param("threshold", -12.0f), param("ratio", 4.0f),
+                                                             param("attack", 0.005f), param("release", 0.1f),
+                                                             param("makeup", 0.0f));
+            } else {
+                throw std::runtime_error("addBusEffect: Unknown effect type '" + type + "'.");
+            }
+
+            m_runtime.getAudio()->AddBusEffect(bus, std::move(effect));
+        });
+    }
+
+    /**
+     * @function clearBusEffects
+     *
+     * @param {number|string} bus - The bus ID or name.
+     *
+     * @description Removes every effect from a bus.
+     *
+     * @example Sound.clearBusEffects("ambience");
+     */
+    void JSBindings::bindClearBusEffects(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("clearBusEffects", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("clearBusEffects: Missing argument.");
+            }
+
+            m_runtime.getAudio()->ClearBusEffects(resolveBus(a[0], "clearBusEffects"));
+        });
+    }
+
+    /**
+     * @function setSoundBus
+     *
+     * @param {number} soundId - The ID of the sound.
+     * @param {number|string} bus - The bus ID or name.
+     *
+     * @description Routes future instances of a sound to a bus. Sounds start on `sfx`.
+     *
+     * @example Sound.setSoundBus(musicId, "music");
+     */
+    void JSBindings::bindSetSoundBus(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setSoundBus", [this](const quickjs::args &a) {
+            if (a.size() < 2) {
+                throw std::runtime_error("setSoundBus: Missing arguments.");
+            }
+
+            m_runtime.getAudio()->SetSoundBus(a[0].as_uint32(), resolveBus(a[1], "setSoundBus"));
+        });
+    }
+
+    /**
+     * @function setSoundSend
+     *
+     * @param {number} soundId - The ID of the sound.
+     * @param {number|string} bus - The bus ID or name to send to.
+     * @param {number} level - How much of the sound to send (0.0 to 1.0); 0 removes the send.
+     *
+     * @description Sends future instances of a sound to a second bus as well, e.g. a room reverb shared by all
+     * sounds in the room.
+     *
+     * @example Sound.setSoundSend(stepsId, cave, 0.5);
+     */
+    void JSBindings::bindSetSoundSend(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setSoundSend", [this](const quickjs::args &a) {
+            if (a.size() < 3) {
+                throw std::runtime_error("setSoundSend: Missing arguments.");
+            }
+
+            m_runtime.getAudio()->SetSoundSend(a[0].as_uint32(), resolveBus(a[1], "setSoundSend"),
+                                               static_cast<float>(a[2].as_double()));
+        });
+    }
+
+    /**
+     * @function setVoiceSend
+     *
+     * @param {number} voiceId - The instance ID returned by `playSound`.
+     * @param {number|string} bus - The bus ID or name to send to.
+     * @param {number} level - How much of the instance to send (0.0 to 1.0); 0 removes the send.
+     *
+     * @description Changes a send of one playing instance.
+     *
+     * @example Sound.setVoiceSend(voice, cave, 0.8);
+     */
+    void JSBindings::bindSetVoiceSend(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setVoiceSend", [this](const quickjs::args &a) {
+            if (a.size() < 3) {
+                throw std::runtime_error("setVoiceSend: Missing arguments.");
             }
 
+            m_runtime.getAudio()->SetVoiceSend(a[0].as_uint32(), resolveBus(a[1], "setVoiceSend"),
+                                               static_cast<float>(a[2].as_double()));
+        });
+    }
+
+    /**
+     * @function playMusic
+     *
+     * @param {string} path - The path to a WAV, MP3 or OGG file.
+     * @param {boolean} [loop=true] - Whether the track repeats without a gap.
+     * @param {number} [fade=0] - Seconds to crossfade from the track already playing.
+     * @param {number} [volume=1] - The volume of the track (0.0 to 1.0).
+     *
+     * @description Streams a music track on the music bus, decoding it in the background instead of loading it
+     * whole. Replaces the current track.
+     *
+     * @example Sound.playMusic("res://music/level1.ogg", true, 1.5); // Crossfades to the level music.
+     */
+    void JSBindings::bindPlayMusic(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("playMusic", [this](const quickjs::args &a) {
+            auto argsCount = a.size();
+
+            if (argsCount < 1) {
+                throw std::runtime_error("playMusic: Missing argument.");
+            }
 
             std::string path = a[0].as_cstring().c_str();
 
             // If path starts with 'res://', load from project directory
             if (path.find("res://") == 0) {
                 path = m_runtime.getProject()->getDirectory() / path.substr(6);
-                std::cout << "Loading sound from project directory: " << path << std::endl;
             }
 
-            auto soundId = m_runtime.getAudio()->LoadSound(path);
+            const auto loop = argsCount >= 2 ? a[1].as_bool() : true;
+            const auto fade = argsCount >= 3 ? static_cast<float>(a[2].as_double()) : 0.0f;
+            const auto volume = argsCount >= 4 ? static_cast<float>(a[3].as_double()) : 1.0f;
 
-            return {*ctx, static_cast<double>(soundId)};
+            m_runtime.getAudio()->PlayMusic(path, loop, fade, volume);
         });
     }
 
     /**
-     * @function playSound
+     * @function stopMusic
      *
-     * @param {number} soundId - The ID of the sound to play.
+     * @param {number} [fade=0] - Seconds to fade out over.
      *
-     * @description Plays a sound.
+     * @description Stops the current music track.
      *
-     * @example Sound.playSound(soundId); // Plays the sound with the given ID.
+     * @example Sound.stopMusic(2); // Fades the music out over two seconds.
      */
-    void JSBindings::bindPlaySound(quickjs::value &global) {
+    void JSBindings::bindStopMusic(quickjs::value &global) {
         auto sound = global.get_property("Sound");
 
-        sound.set_property("playSound", [this](const quickjs::args &a) {
-            auto argsCount = a.size();
+        sound.set_property("stopMusic", [this](const quickjs::args &a) {
+            const auto fade = a.size() >= 1 ? static_cast<float>(a[0].as_double()) : 0.0f;
+            m_runtime.getAudio()->StopMusic(fade);
+        });
+    }
 
-            if (argsCount < 1) {
-                throw std::runtime_error("playSound: Missing argument.");
+    /**
+     * @function setMusicVolume
+     *
+     * @param {number} volume - The volume of the current track (0.0 to 1.0).
+     *
+     * @description Changes the volume of the current music track.
+     *
+     * @example Sound.setMusicVolume(0.5);
+     */
+    void JSBindings::bindSetMusicVolume(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("setMusicVolume", [this](const quickjs::args &a) {
+            if (a.size() < 1) {
+                throw std::runtime_error("setMusicVolume: Missing argument.");
             }
 
-            auto soundId = a[0].as_uint32();
-            m_runtime.getAudio()->PlaySound(soundId);
+            m_runtime.getAudio()->SetMusicVolume(static_cast<float>(a[0].as_double()));
         });
     }
 
     /**
-     * @function stopSound
+     * @function isMusicPlaying
      *
-     * @param {number} soundId - The ID of the sound to stop.
+     * @description Checks whether a music track is playing.
      *
-     * @description Stops a sound.
+     * @returns {boolean} - `true` until the track is stopped or, without looping, has played out.
      *
-     * @example Sound.stopSound(soundId); // Stops the sound with the given ID.
+     * @example if (!Sound.isMusicPlaying()) Sound.playMusic("res://music/menu.ogg");
      */
-    void JSBindings::bindStopSound(quickjs::value &global) {
+    void JSBindings::bindIsMusicPlaying(quickjs::value &global) {
         auto sound = global.get_property("Sound");
 
-        sound.set_property("stopSound", [this](const quickjs::args &a) {
-            auto argsCount = a.size();
+        sound.set_property("isMusicPlaying", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+            return {*ctx, m_runtime.getAudio()->IsMusicPlaying()};
+        });
+    }
 
-            if (argsCount < 1) {
-                throw std::runtime_error("stopSound: Missing argument.");
+    float JSBindings::resolveNote(const quickjs::value &note, const std::string &caller) const {
+        if (!note.is_string()) {
+            return static_cast<float>(note.as_double());
+        }
+
+        const std::string name = note.as_cstring().c_str();
+        const auto number = audio::parseNote(name);
+
+        if (!number) {
+            throw std::runtime_error(caller + ": Unknown note '" + name + "'.");
+        }
+
+        return *number;
+    }
+
+    /**
+     * @function createInstrument
+     *
+     * @param {object} [params={}] - Instrument settings: `waveform` (`square`, `triangle`, `saw` or `noise`),
+     * `duty` (share of a square period spent high, 0.01 to 0.99), `attack`, `decay` and `release` (seconds, up to
+     * 30), `sustain` (level, 0 to 1), `slide` (semitones per second), `arpeggio` (Array of up to 8 semitone offsets),
+     * `arpeggioRate` (steps per second, up to 1000), `volume` and `bus` (ID or name, `sfx` by default).
+     *
+     * @description Creates a synth instrument. Its notes are generated by the mixer, so sound effects need no sample
+     * files. Out-of-range settings are clamped; settings that are not finite numbers throw.
+     *
+     * @returns {number} - The ID of the instrument.
+     *
+     * @example const zap = Sound.createInstrument({ waveform: "saw", slide: -36, release: 0.2 });
+     */
+    void JSBindings::bindCreateInstrument(quickjs::value &global) {
+        auto sound = global.get_property("Sound");
+
+        sound.set_property("createInstrument", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
+            quickjs::value params = a.size() >= 1 ? a[0] : quickjs::value();
+            const auto property = [&params](const char *name) {
+                return params.is_object() ? params.get_property(name) : quickjs::value();
+            };
+            const auto finite = [](const double number, const char *name) {
+                if (!std::isfinite(number)) {
+                    throw std::runtime_error(std::string("createInstrument: Parameter '") + name +
+                                             "' must be a finite number.");
+                }
+                return static_cast<float>(number);
+            };
+            const auto param = [&property, &finite](const char *name, const float fallback) {
+                quickjs::value value = property(name);
+                return value.is_undefined() ? fallback : finite(value.as_double(), name);
+            };
+
+            audio::Instrument instrument;
+
+            if (quickjs::value waveform = property("waveform"); !waveform.is_undefined()) {
+                const std::string name = waveform.as_cstring().c_str();
+
+                if (name == "square") {
+                    instrument.waveform = audio::Waveform::Square;
+                } else if (name == "triangle") {
+                    instrument.waveform = audio::Waveform::Triangle;
+                } else if (name == "saw") {
+                    instrument.waveform = audio::Waveform::Saw;
+                } else if (name == "noise") {
+                    instrument.waveform = audio::Waveform::Noise;
+                } else {
+                    throw std::runtime_error("createInstrument: Unknown waveform '" + name + "'.");
+                }
             }
 
-            auto soundId = a[0].as_uint32();
-            m_runtime.getAudio()->StopSound(soundId);
+            instrument.duty = param("duty", instrument.duty);
+            instrument.attack = param("attack", instrument.attack);
+            instrument.decay = param("decay", instrument.decay);
+            instrument.sustain = param("sustain", instrument.sustain);
+            instrument.release = param("release", instrument.release);
+            instrument.slide = param("slide", instrument.slide);
+            instrument.arpeggioRate = param("arpeggioRate", instrument.arpeggioRate);
+            instrument.gain = param("volume", instrument.gain);
+
+            if (quickjs::value arpeggio = property("arpeggio"); arpeggio.is_array()) {
+                const auto length = std::min(arpeggio.get_property("length").as_uint32(),
+                                             audio::Instrument::MAX_ARPEGGIO);
+
+                for (uint32_t i = 0; i < length; ++i) {
+                    instrument.arpeggio[i] = finite(arpeggio.get_property(i).as_double(), "arpeggio");
+                }
+                instrument.arpeggioLength = length;
+            }
+
+            auto bus = audio::BUS_SFX;
+            if (quickjs::value busValue = property("bus"); !busValue.is_undefined()) {
+                bus = resolveBus(busValue, "createInstrument");
+            }
+
+            const auto id = m_runtime.getAudio()->CreateInstrument(instrument, bus);
+
+            return {*ctx, static_cast<double>(id)};
         });
     }
 
     /**
-     * @function toggleSound
+     * @function playNote
      *
-     * @param {number} soundId - The ID of the sound to toggle.
+     * @param {number} instrumentId - The ID of the instrument.
+     * @param {number|string} note - A MIDI note number (60 is middle C) or a name such as `C4`, `F#3` or `Bb5`.
+     * @param {number} [duration=0.25] - Seconds before the note is released; 0 holds it until `stopVoice`.
+     * @param {number} [volume=1] - The volume of this note (0.0 to 1.0).
+     * @param {number} [pan=0] - Stereo position, from -1 (left) to 1 (right).
+     * @param {number} [delay=0] - Seconds to wait before starting, timed to the sample.
      *
-     * @description Toggles a sound.
+     * @description Plays a note on a synth instrument.
      *
-     * @example Sound.toggleSound(soundId); // Toggles the sound with the given ID.
+     * @returns {number} - The ID of the playing note, usable with `stopVoice` and `setVoiceParams`.
+     *
+     * @example Sound.playNote(lead, "E5", 0.1);
      */
-    void JSBindings::bindToggleSound(quickjs::value &global) {
+    void JSBindings::bindPlayNote(quickjs::value &global) {
         auto sound = global.get_property("Sound");
 
-        sound.set_property("toggleSound", [this](const quickjs::args &a) {
+        sound.set_property("playNote", [this](const quickjs::args &a) -> quickjs::value {
+            std::shared_ptr<quickjs::context> ctx = m_runtime.getContext();
+
             auto argsCount = a.size();
 
-            if (argsCount < 1) {
-                throw std::runtime_error("toggleSound: Missing argument.");
+            if (argsCount < 2) {
+                throw std::runtime_error("playNote: Missing arguments.");
             }
 
-            auto soundId = a[0].as_uint32();
-            m_runtime.getAudio()->ToggleSound(soundId);
+            const auto instrument = a[0].as_uint32();
+            const auto note = resolveNote(a[1], "playNote");
+            const auto duration = argsCount >= 3 ? static_cast<float>(a[2].as_double()) : 0.25f;
+
+            audio::VoiceParams params;
+            if (argsCount >= 4) params.gain = static_cast<float>(a[3].as_double());
+            if (argsCount >= 5) params.pan = static_cast<float>(a[4].as_double());
+
+            const auto delay = argsCount >= 6 ? static_cast<float>(a[5].as_double()) : 0.0f;
+
+            const auto voice = m_runtime.getAudio()->PlayNote(instrument, note, duration, params, delay);
+
+            return {*ctx, static_cast<double>(voice)};
         });
     }
 
     /**
-     * @function setSoundVolume
+     * @function playSequence
      *
-     * @param {number} soundId - The ID of the sound to set the volume for.
-     * @param {number} volume - The volume to set (0.0 to 1.0).
+     * @param {number} instrumentId - The ID of the instrument.
+     * @param {Array} notes - Note numbers or names, one per step; `null` is a rest.
+     * @param {number} [step=0.125] - Seconds per step.
+     * @param {number} [volume=1] - The volume of the notes (0.0 to 1.0).
+     * @param {number} [delay=0] - Seconds to wait before the first step.
      *
-     * @description Sets the volume of a sound.
+     * @description Plays a run of notes, each scheduled to the sample, like a fantasy console sound effect.
      *
-     * @example Sound.setSoundVolume(soundId, 0.5); // Sets the volume of the sound with the given ID to 0.5.
+     * @example Sound.playSequence(coin, ["B5", "E6"], 0.06);
      */
-    void JSBindings::bindSetSoundVolume(quickjs::value &global) {
+    void JSBindings::bindPlaySequence(quickjs::value &global) {
         auto sound = global.get_property("Sound");
 
-        sound.set_property("setSoundVolume", [this](const quickjs::args &a) {
+        sound.set_property("playSequence", [this](const quickjs::args &a) {
             auto argsCount = a.size();
 
             if (argsCount < 2) {
-                throw std::runtime_error("setSoundVolume: Missing arguments.");
+                throw std::runtime_error("playSequence: Missing arguments.");
             }
 
-            auto soundId = a[0].as_uint32();
-            auto volume = a[1].as_double();
-            m_runtime.getAudio()->SetSoundVolume(soundId, volume);
+            if (!a[1].is_array()) {
+                throw std::runtime_error("playSequence: Notes must be an array.");
+            }
+
+            const auto instrument = a[0].as_uint32();
+            const auto length = a[1].get_property("length").as_uint32();
+
+            std::vector<float> notes(length, -1.0f);
+            for (uint32_t i = 0; i < length; ++i) {
+                quickjs::value note = a[1].get_property(i);
+                if (!note.is_null() && !note.is_undefined()) {
+                    notes[i] = resolveNote(note, "playSequence");
+                }
+            }
+
+            const auto step = argsCount >= 3 ? static_cast<float>(a[2].as_double()) : 0.125f;
+
+            audio::VoiceParams params;
+            if (argsCount >= 4) params.gain = static_cast<float>(a[3].as_double());
+
+            const auto delay = argsCount >= 5 ? static_cast<float>(a[4].as_double()) : 0.0f;
+
+            m_runtime.getAudio()->PlaySequence(instrument, notes, step, params, delay);
         });
     }
 
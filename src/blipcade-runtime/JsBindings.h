@@ -44,6 +44,12 @@ namespace blipcade {
 
             void bindSetPostprocessingShader(quickjs::value &global) const;
 
+            void bindSetPostprocessingChain(quickjs::value &global) const;
+
+            void bindPrecompilePostprocessingShader(quickjs::value &global) const;
+
+            std::string loadPostprocessingShader(const std::string &shaderPath, const std::string &caller) const;
+
             void bindDrawFilledRectangle(quickjs::value &global);
 
             void bindLightingGlobalObject(quickjs::value &global);
@@ -70,6 +76,18 @@ namespace blipcade {
 
             void bindDrawSpriteEx(quickjs::value &global);
 
+            void bindCreatePaletteRemap(quickjs::value &global);
+
+            void bindBeginLayer(quickjs::value &global);
+
+            void bindEndLayer(quickjs::value &global);
+
+            void bindDrawLayer(quickjs::value &global);
+
+            void bindInvalidateLayer(quickjs::value &global);
+
+            void bindSetPartialRedraw(quickjs::value &global);
+
             void createNamespace(quickjs::value &global, const std::string &name);
 
             void bindECSMethods(quickjs::value &global, ecs::ECS &ecs);
@@ -92,23 +110,101 @@ namespace blipcade {
 
             void bindCheckCollisionPoint(quickjs::value &global);
 
+            void bindCheckCollisionPoints(quickjs::value &global);
+
+            void bindAddBody(quickjs::value &global);
+
+            void bindRemoveBody(quickjs::value &global);
+
+            void bindSetBodyPosition(quickjs::value &global);
+
+            void bindClearBodies(quickjs::value &global);
+
+            void bindQueryPoint(quickjs::value &global);
+
+            void bindQueryRect(quickjs::value &global);
+
+            void bindQuerySegment(quickjs::value &global);
+
+            quickjs::value makeBodyIdArray(const std::vector<uint32_t> &ids) const;
+
             void bindPathfindingMethods(quickjs::value &global);
 
             void bindFindPath(quickjs::value &global);
 
             void bindGetNavMesh(quickjs::value &global);
 
+            void bindGetPathCacheStats(quickjs::value &global);
+
+            void bindBuildNavMeshHierarchy(quickjs::value &global);
+
+            void bindRaycastNavMesh(quickjs::value &global);
+
+            void bindHasLineOfSight(quickjs::value &global);
+
+            void bindSweepCircleNavMesh(quickjs::value &global);
+
+            collision::NavMesh &loadNavMesh(const std::string &navigationMeshId);
+
+            quickjs::value makeOutlineHit(const collision::OutlineHit *hit, float length) const;
+
             void bindSoundMethods(quickjs::value &global);
 
             void bindLoadSound(quickjs::value &global);
 
             void bindPlaySound(quickjs::value &global);
 
+            void bindPlaySoundAt(quickjs::value &global);
+
             void bindStopSound(quickjs::value &global);
 
             void bindToggleSound(quickjs::value &global);
 
             void bindSetSoundVolume(quickjs::value &global);
+
+            void bindStopVoice(quickjs::value &global);
+
+            void bindSetVoiceParams(quickjs::value &global);
+
+            void bindSetVoicePosition(quickjs::value &global);
+
+            void bindGetAudioStats(quickjs::value &global);
+
+            void bindResetAudioStats(quickjs::value &global);
+
+            void bindCreateBus(quickjs::value &global);
+
+            void bindGetBus(quickjs::value &global);
+
+            void bindSetBusVolume(quickjs::value &global);
+
+            void bindAddBusEffect(quickjs::value &global);
+
+            void bindClearBusEffects(quickjs::value &global);
+
+            void bindSetSoundBus(quickjs::value &global);
+
+            void bindSetSoundSend(quickjs::value &global);
+
+            void bindSetVoiceSend(quickjs::value &global);
+
+            void bindPlayMusic(quickjs::value &global);
+
+            void bindStopMusic(quickjs::value &global);
+
+            void bindSetMusicVolume(quickjs::value &global);
+
+            void bindIsMusicPlaying(quickjs::value &global);
+
+            void bindCreateInstrument(quickjs::value &global);
+
+            void bindPlayNote(quickjs::value &global);
+
+            void bindPlaySequence(quickjs::value &global);
+
+            uint32_t resolveBus(const quickjs::value &bus, const std::string &caller) const;
+
+            float resolveNote(const quickjs::value &note, const std::string &caller) const;
         };
     }
 }
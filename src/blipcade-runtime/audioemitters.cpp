@@ -0,0 +1,116 @@
+// audioemitters.cpp
+
+#include "audioemitters.h"
+
+#include "audio.h"
+
+namespace blipcade::runtime {
+    namespace {
+        float number(const quickjs::value &object, const char *name, const float fallback) {
+            const auto value = object.get_property(name);
+            return value.is_number() ? static_cast<float>(value.as_double()) : fallback;
+        }
+    }
+
+    void AudioEmitters::setDefaultRadius(const float radius) {
+        defaultRadius = radius;
+    }
+
+    audio::VoiceHandle AudioEmitters::start(audio::Audio &audio, const quickjs::value &component,
+                                            const Playing &emitter) const {
+        audio::Emitter position;
+        position.x = emitter.x;
+        position.y = emitter.y;
+        position.radius = number(component, "radius", defaultRadius);
+        position.falloff = number(component, "falloff", 1.0f);
+
+        audio::VoiceParams params;
+        params.gain = number(component, "volume", 1.0f);
+        params.loop = emitter.loop;
+
+        return audio.PlaySoundAt(emitter.sound, position, params);
+    }
+
+    void AudioEmitters::update(ecs::ECS &ecs, audio::Audio &audio) {
+        for (auto &[entity, emitter]: playing) {
+            emitter.seen = false;
+        }
+
+        const auto &typeIDs = ecs.getComponentTypeIDs();
+
+        // Without the type no entity has the component, though voices started earlier are still stopped below
+        if (const auto type = typeIDs.find(COMPONENT); type != typeIDs.end()) {
+            for (const auto entity: ecs.getActiveEntities()) {
+                const auto &components = ecs.getComponents(entity);
+                const auto component = components.find(type->second);
+                if (component == components.end() || !component->second.is_object()) {
+                    continue;
+                }
+
+                const auto &value = component->second;
+                const auto soundValue = value.get_property("sound");
+                if (!soundValue.is_number()) {
+                    continue;
+                }
+
+                const auto sound = soundValue.as_uint32();
+                const auto x = number(value, "x", 0.0f);
+                const auto y = number(value, "y", 0.0f);
+
+                auto existing = playing.find(entity);
+                if (existing != playing.end() && existing->second.sound != sound) {
+                    audio.StopVoice(existing->second.voice);
+                    playing.erase(existing);
+                    existing = playing.end();
+                }
+
+                if (existing == playing.end()) {
+                    const auto loop = value.get_property("loop");
+
+                    Playing emitter{sound, audio::NO_VOICE, x, y, loop.is_bool() ? loop.as_bool() : true};
+                    emitter.voice = start(audio, value, emitter);
+                    emitter.retryIn = RETRY_FRAMES;
+                    emitter.seen = true;
+                    playing[entity] = emitter;
+                    continue;
+                }
+
+                auto &emitter = existing->second;
+                emitter.seen = true;
+
+                if (emitter.x != x || emitter.y != y) {
+                    audio.SetVoicePosition(emitter.voice, x, y);
+                    emitter.x = x;
+                    emitter.y = y;
+                }
+
+                if (emitter.retryIn > 0) {
+                    --emitter.retryIn;
+                }
+
+                // Stolen by a newer voice, or never started because none was free. A one-shot that has played out
+                // is done instead, and forgets its handle so it is not asked again.
+                if (emitter.voice != audio::NO_VOICE || emitter.loop) {
+                    if (!audio.IsVoicePlaying(emitter.voice)) {
+                        if (!emitter.loop) {
+                            emitter.voice = audio::NO_VOICE;
+                        } else if (emitter.retryIn == 0) {
+                            emitter.voice = start(audio, value, emitter);
+                            emitter.retryIn = RETRY_FRAMES;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::erase_if(playing, [&audio](const auto &entry) {
+            if (entry.second.seen) {
+                return false;
+            }
+
+            audio.StopVoice(entry.second.voice);
+            return true;
+        });
+    }
+} // runtime
+// blipcade
@@ -0,0 +1,60 @@
+// audioemitters.h
+
+#ifndef AUDIOEMITTERS_H
+#define AUDIOEMITTERS_H
+
+#include <unordered_map>
+
+#include "ECS.h"
+#include "mixer.h"
+
+namespace blipcade::audio {
+    class Audio;
+}
+
+namespace blipcade::runtime {
+    // Gives every entity with an AudioEmitter component a positional voice. The component is a plain object:
+    //
+    //     { sound, x, y, radius = default radius, falloff = 1, volume = 1, loop = true }
+    //
+    // The voice starts when the component appears and follows `x` and `y` from then on; the other fields are read
+    // once, when it starts. Changing `sound` restarts it, and removing the component or its entity stops it. A
+    // looping voice that gets stolen is started again, at most once every RETRY_FRAMES; a one-shot that has played out
+    // stays silent until `sound` changes.
+    class AudioEmitters {
+    public:
+        static constexpr const char *COMPONENT = "AudioEmitter";
+
+        // Frames between starts of the same looping voice. With the pool full every start steals a voice, which would
+        // otherwise be taken back the next frame.
+        static constexpr uint32_t RETRY_FRAMES = 30;
+
+        // Used for components without a `radius`; the runtime sets it to the canvas width
+        void setDefaultRadius(float radius);
+
+        // Once per frame, after the game has moved its entities
+        void update(ecs::ECS &ecs, audio::Audio &audio);
+
+    private:
+        struct Playing {
+            audio::SoundHandle sound = 0;
+            audio::VoiceHandle voice = audio::NO_VOICE;
+            float x = 0.0f;
+            float y = 0.0f;
+            bool loop = true;
+            // Frames left until a looping voice that stopped may be started again
+            uint32_t retryIn = 0;
+            // Whether the component was still there this frame
+            bool seen = false;
+        };
+
+        float defaultRadius = 0.0f;
+        std::unordered_map<ecs::Entity, Playing> playing;
+
+        [[nodiscard]] audio::VoiceHandle start(audio::Audio &audio, const quickjs::value &component,
+                                               const Playing &emitter) const;
+    };
+} // runtime
+// blipcade
+
+#endif // AUDIOEMITTERS_H
@@ -12,6 +12,7 @@
 extern "C" {
     #include <cutils.h>
 }
+#include <algorithm>
 #include <iostream>
 #include <json_cart_data.hpp>
 #include <quickjs-libc.h>
@@ -22,24 +23,33 @@ extern "C" {
 #include "JsBindings.h"
 #include "keystate.h"
 #include "collider.h"
+#include "collisionworld.h"
 #include "audio.h"
 
 auto const WIDTH = 320;
 auto const HEIGHT = 240;
 
 namespace blipcade::runtime {
-    Runtime::Runtime(uint32_t width, uint32_t height): cartridge(nullptr), canvas(nullptr),
+    Runtime::Runtime(uint32_t width, uint32_t height, const graphics::CanvasBackend canvasBackend): cartridge(nullptr),
+                                                       canvas(nullptr),
                                                        key_flags(std::make_shared<Keystate>()),
                                                        mouse_state(std::make_shared<Mousestate>()), font(nullptr),
                                                        js_bindings(std::make_unique<JSBindings>(*this)),
                                                        canvasWidth(width), canvasHeight(height), audio(nullptr),
                                                        navmeshes(nullptr) {
-        canvas = std::make_shared<graphics::Canvas>(canvasWidth, canvasHeight);
+        canvas = std::make_shared<graphics::Canvas>(canvasWidth, canvasHeight, canvasBackend);
         spritesheets = std::make_shared<std::unordered_map<std::string, graphics::Spritesheet> >();
         colliders = std::make_shared<std::unordered_map<std::string, collision::Collider> >();
         navmeshes = std::make_shared<std::unordered_map<std::string, collision::NavMesh> >();
+        collisionWorld = std::make_shared<collision::CollisionWorld>();
         audio = std::make_shared<audio::Audio>();
-        postprocessing = std::make_shared<renderer::Postprocessing>();
+        // Until the game moves the camera the listener sits in the middle of the canvas
+        audio->SetListener(canvasWidth / 2.0f, canvasHeight / 2.0f, canvasWidth / 2.0f);
+        // Emitters without a radius are heard across the screen and fade out half a screen past its sides
+        audioEmitters.setDefaultRadius(static_cast<float>(canvasWidth));
+        if (IsWindowReady()) {
+            postprocessing = std::make_shared<renderer::Postprocessing>();
+        }
 
         // std::string fontHeader = "40 24 04 06";
         // std::string fontData =
@@ -110,6 +120,9 @@ namespace blipcade::runtime {
         offsetY = y;
 
         canvas->setCamera(x, y);
+
+        // The offset moves the world, so the point of it on the middle of the screen is the opposite way
+        audio->SetListener(canvasWidth / 2.0f - x, canvasHeight / 2.0f - y, canvasWidth / 2.0f);
     }
 
 
@@ -142,6 +155,10 @@ namespace blipcade::runtime {
         return navmeshes;
     }
 
+    std::shared_ptr<collision::CollisionWorld> Runtime::getCollisionWorld() const {
+        return collisionWorld;
+    }
+
     std::shared_ptr<ecs::ECS> Runtime::getECS() const {
         return ecs;
     }
@@ -306,24 +323,83 @@ namespace blipcade::runtime {
         const std::chrono::duration<float> deltaTime = currentTime - lastTime;
         lastTime = currentTime;
 
+        update(deltaTime.count());
+    }
+
+    void Runtime::update(const float deltaTime) {
         // Update globalTime with the elapsed time
-        globalTime += deltaTime.count();
+        globalTime += deltaTime;
 
+        audio->Update(deltaTime);
 
         evalWithStacktrace("update()");
+
+        if (ecs) {
+            audioEmitters.update(*ecs, *audio);
+        }
     }
 
     void Runtime::draw(const RenderTexture2D &renderTexture) const {
+        canvas->setFrameTarget(renderTexture);
+        draw();
+
+        if (canvas->getBackend() == graphics::CanvasBackend::Software) {
+            canvas->present(renderTexture);
+        }
+    }
+
+    void Runtime::draw() const {
         evalWithStacktrace("draw()");
+        canvas->endLayer();
+        canvas->flush();
+        canvas->endFrame();
     }
 
     void Runtime::postProcess(const RenderTexture2D &postProcessTexture, const RenderTexture2D &renderTexture,
                               const Rectangle &srcRect, const Rectangle &destRect,
                               const Vector2 &origin, float rotation, const Color &tint) const {
         // I don't like that this is happening here. Need to rethink the pipeline.
-        getCanvas()->applyLighting(postProcessTexture, renderTexture);
+        if (!canvas->isPartialRedraw()) {
+            canvas->applyLighting(postProcessTexture, renderTexture);
+            postprocessing->postprocess(postProcessTexture, renderTexture, globalTime, canvasWidth, canvasHeight);
+            return;
+        }
+
+        // Partial redraw: render texture content outside the dirty region is still valid from earlier frames
+        const auto &dirty = canvas->getDirtyRects();
+        std::optional<graphics::Rect> region;
+        std::optional<Rectangle> postprocessRegion;
+
+        if (!dirty.isFullyDirty()) {
+            const auto bounds = dirty.getDirtyBounds();
+            region = bounds;
+
+            // Post-processing shaders sample around each pixel, so pixels just outside the bounds can change too
+            const auto left = std::max(0, bounds.x - POSTPROCESS_MARGIN);
+            const auto top = std::max(0, bounds.y - POSTPROCESS_MARGIN);
+            const auto right = std::min(static_cast<int32_t>(canvasWidth), bounds.x + bounds.width + POSTPROCESS_MARGIN);
+            const auto bottom = std::min(static_cast<int32_t>(canvasHeight), bounds.y + bounds.height + POSTPROCESS_MARGIN);
+            postprocessRegion = Rectangle{
+                static_cast<float>(left), static_cast<float>(top),
+                static_cast<float>(right - left), static_cast<float>(bottom - top)
+            };
+        }
+
+        if (!dirty.isClean()) {
+            canvas->applyLighting(postProcessTexture, renderTexture, region);
+        }
+
+        // Animated shaders still run over the whole frame
+        if (postprocessing->isTimeDependent()) {
+            postprocessing->postprocess(postProcessTexture, renderTexture, globalTime, canvasWidth, canvasHeight);
+        } else if (!dirty.isClean()) {
+            postprocessing->postprocess(postProcessTexture, renderTexture, globalTime, canvasWidth, canvasHeight,
+                                        postprocessRegion);
+        }
+    }
 
-        postprocessing->postprocess(postProcessTexture, renderTexture, globalTime, canvasWidth, canvasHeight);
+    void Runtime::setPartialRedraw(const bool enabled) const {
+        canvas->setPartialRedraw(enabled);
     }
 
     // TODO: I am not sure this works correctly in all the cases. Perhaps it would be better to handle it with C api directly.
@@ -5,11 +5,13 @@
 #ifndef RUNTIME_H
 #define RUNTIME_H
 #include <collision.h>
+#include <graphics_types.h>
 #include <memory>
 #include <optional>
 #include <raylib.h>
 #include <string>
 
+#include "audioemitters.h"
 #include "keystate.h"
 #include "mousestate.h"
 
@@ -30,7 +32,9 @@ namespace blipcade {
 
     namespace collision {
         class Collider;
+        class CollisionWorld;
         class NavMesh;
+        struct OutlineHit;
     }
 
     class Cartridge;
@@ -78,7 +82,8 @@ namespace blipcade::runtime {
     public:
         Runtime(
             uint32_t width,
-            uint32_t height
+            uint32_t height,
+            graphics::CanvasBackend canvasBackend = graphics::CanvasBackend::Gpu
         );
 
         void evalWithStacktrace(const char *code) const;
@@ -101,14 +106,25 @@ namespace blipcade::runtime {
 
         void init();
 
+        // Steps by the wall-clock time since the last update
         void update();
 
+        // Steps by a fixed `deltaTime` seconds, for runs that should not depend on how fast frames are produced
+        void update(float deltaTime);
+
         void draw(const RenderTexture2D &renderTexture) const;
 
+        // Runs the cart's draw() without a render target. Software backend only; read the frame with
+        // getCanvas()->resolve().
+        void draw() const;
+
         void postProcess(const RenderTexture2D &postProcessTexture, const RenderTexture2D &renderTexture,
                          const Rectangle &srcRect,
                          const Rectangle &destRect, const Vector2 &origin, float rotation, const Color &tint) const;
 
+        // Re-composites (lighting, post-processing, software upload) only the parts of the frame that changed
+        void setPartialRedraw(bool enabled) const;
+
         [[nodiscard]] std::shared_ptr<quickjs::context> getContext() const;
 
         [[nodiscard]] std::shared_ptr<loader::Project> getProject() const;
@@ -125,8 +141,11 @@ namespace blipcade::runtime {
 
         [[nodiscard]] std::shared_ptr<std::unordered_map<std::string, collision::NavMesh> > getNavmeshes() const;
 
+        [[nodiscard]] std::shared_ptr<collision::CollisionWorld> getCollisionWorld() const;
+
         [[nodiscard]] std::shared_ptr<ecs::ECS> getECS() const;
 
+        // Null without a window, since there is no GL context to run the shaders on
         [[nodiscard]] std::shared_ptr<renderer::Postprocessing> getPostprocessing() const;
 
         void setCartridge(std::shared_ptr<Cartridge>);
@@ -148,11 +167,13 @@ namespace blipcade::runtime {
         std::shared_ptr<std::unordered_map<std::string, graphics::Spritesheet> > spritesheets;
         std::shared_ptr<std::unordered_map<std::string, collision::Collider> > colliders;
         std::shared_ptr<std::unordered_map<std::string, collision::NavMesh> > navmeshes;
+        std::shared_ptr<collision::CollisionWorld> collisionWorld;
         std::shared_ptr<std::string> code;
         std::shared_ptr<Keystate> key_flags;
         std::shared_ptr<Mousestate> mouse_state;
         std::shared_ptr<graphics::Font> font;
         std::shared_ptr<audio::Audio> audio;
+        AudioEmitters audioEmitters;
 
         std::shared_ptr<renderer::Postprocessing> postprocessing;
 
@@ -169,6 +190,9 @@ namespace blipcade::runtime {
         uint32_t canvasWidth;
         uint32_t canvasHeight;
 
+        // Extra pixels post-processed around the dirty bounds, for shaders sampling neighbours
+        static constexpr int32_t POSTPROCESS_MARGIN = 8;
+
         float globalTime = 0;
         std::chrono::steady_clock::time_point lastTime;
 
@@ -47,6 +47,7 @@ export class Entities {
                 walk: {
                     soundId: walkSoundHandle,
                     volume: 1.0,
+                    loop: true,
                     isPlaying: false,
                     isStopping: false,
                 }
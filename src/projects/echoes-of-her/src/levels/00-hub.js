@@ -19,7 +19,7 @@ export const hub = {
         },
         {
             type: "music",
-            musicId: Sound.loadSound('res://sounds/hub/main.mp3'),
+            path: 'res://sounds/hub/main.mp3',
             volume: 0.2
         },
         {
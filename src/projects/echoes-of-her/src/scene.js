@@ -26,6 +26,9 @@ export function init() {
 
     Graphics.setTransparentColor(255);
 
+    // Adventure scenes are mostly static; only re-composite what changes
+    Graphics.setPartialRedraw(true);
+
     state.frameCount = 0;
     state.lastFPSUpdate = Date.now();
     state.currentFPS = 0;
@@ -7,8 +7,16 @@ export const RenderLayer = {
     Foreground: 3
 }
 
+// Background and foreground rarely change, so they are drawn once into cached canvas layers and only
+// redrawn when their contents move or change
+const CachedLayers = [RenderLayer.Background, RenderLayer.Foreground];
+
 class DrawSystem {
     renderLayers = {};
+    // Items each cached layer was last recorded from. They are rebuilt every update and never changed afterwards,
+    // so the previous frame's array can be compared against as it is.
+    recordedItems = {};
+    layerBounds = {};
 
     constructor() {
         this.initRenderLayers();
@@ -100,6 +108,86 @@ class DrawSystem {
         this.renderLayers[RenderLayer.Entities].sort((a, b) => {
             return (a.properties.y) - (b.properties.y);
         });
+
+        CachedLayers.forEach(layer => this.updateCachedLayer(layer));
+    }
+
+    updateCachedLayer(layer) {
+        const items = this.renderLayers[layer];
+        const previous = this.recordedItems[layer];
+
+        this.recordedItems[layer] = items;
+
+        if (previous && this.isSameLayer(previous, items)) {
+            return;
+        }
+
+        this.layerBounds[layer] = this.getLayerBounds(layer, items);
+        Graphics.invalidateLayer(layer);
+    }
+
+    // Compared field by field, so an unchanged layer costs no allocations
+    isSameLayer(previous, items) {
+        if (previous.length !== items.length) {
+            return false;
+        }
+
+        for (let i = 0; i < items.length; i++) {
+            const a = previous[i];
+            const b = items[i];
+
+            if (a.entity !== b.entity) {
+                return false;
+            }
+
+            const p = a.properties;
+            const q = b.properties;
+
+            if (p.x !== q.x || p.y !== q.y || p.spriteIndex !== q.spriteIndex || p.spriteSheet !== q.spriteSheet ||
+                p.flipX !== q.flipX) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    getLayerBounds(layer, items) {
+        if (items.length === 0) {
+            return null;
+        }
+
+        let left = Infinity, top = Infinity, right = -Infinity, bottom = -Infinity;
+
+        items.forEach(({properties: {x, y, width, height, ox, oy}}) => {
+            // Background sprites are drawn from their top-left corner, foreground ones around their origin
+            const x0 = layer === RenderLayer.Background ? x : x - Math.round(ox * width);
+            const y0 = layer === RenderLayer.Background ? y : y - Math.round(oy * height);
+
+            left = Math.min(left, x0);
+            top = Math.min(top, y0);
+            right = Math.max(right, x0 + width);
+            bottom = Math.max(bottom, y0 + height);
+        });
+
+        left = Math.floor(left);
+        top = Math.floor(top);
+
+        return {x: left, y: top, width: Math.ceil(right) - left, height: Math.ceil(bottom) - top};
+    }
+
+    drawCachedLayer(layer, drawItem) {
+        const bounds = this.layerBounds[layer];
+        if (!bounds) {
+            return;
+        }
+
+        if (Graphics.beginLayer(layer, bounds.x, bounds.y, bounds.width, bounds.height)) {
+            this.renderLayers[layer].forEach(drawItem);
+            Graphics.endLayer();
+        }
+
+        Graphics.drawLayer(layer);
     }
 
     draw() {
@@ -107,7 +195,7 @@ class DrawSystem {
 
 
         // Render background
-        this.renderLayers[RenderLayer.Background].forEach(({entity, properties: {x, y, spriteIndex, spriteSheet, flipX, ox, oy}}) => {
+        this.drawCachedLayer(RenderLayer.Background, ({entity, properties: {x, y, spriteIndex, spriteSheet, flipX, ox, oy}}) => {
             Graphics.drawSprite(x, y, spriteIndex, spriteSheet.toString(), flipX);
         });
 
@@ -161,7 +249,7 @@ class DrawSystem {
         });
 
         // Render foreground
-        this.renderLayers[RenderLayer.Foreground].forEach(({entity, properties: {x, y, spriteIndex, spriteSheet, flipX, ox, oy}}) => {
+        this.drawCachedLayer(RenderLayer.Foreground, ({entity, properties: {x, y, spriteIndex, spriteSheet, flipX, ox, oy}}) => {
             Graphics.drawSpriteEx(x, y, spriteIndex, spriteSheet, flipX, false, 1, ox, oy);
         });
     }
@@ -36,7 +36,7 @@ const scenes = [
             },
             {
                 type: "music",
-                musicId: Sound.loadSound('resources/music-1.mp3'),
+                path: 'resources/music-1.mp3',
                 volume: 0.5
             },
             {
@@ -102,7 +102,7 @@ const scenes = [
             },
             {
                 type: "music",
-                musicId: Sound.loadSound('resources/music-2.wav'),
+                path: 'resources/music-2.wav',
                 volume: 0.5
             },
             {
@@ -517,11 +517,10 @@ class LevelSystem {
 
             if (obj.type === "music") {
                 ECS.addComponent(entity, "Music", {
-                    musicId: obj.musicId
+                    path: obj.path
                 });
 
-                Sound.playSound(obj.musicId);
-                Sound.setSoundVolume(obj.musicId, obj.volume);
+                Sound.playMusic(obj.path, true, 1, obj.volume);
             }
 
             if (obj.type === "particleEmitter") {
@@ -587,7 +586,7 @@ class LevelSystem {
 
         ECS.forEachEntity([], (entity) => {
             if (ECS.getComponent(entity, "Music")) {
-                Sound.stopSound(ECS.getComponent(entity, "Music").musicId);
+                Sound.stopMusic(1);
             }
 
             if (ECS.getComponent(entity, "Sound")) {
@@ -597,6 +596,7 @@ class LevelSystem {
 
                     Sound.stopSound(soundData.soundId);
                     soundData.isStopping = false;
+                    soundData.voiceId = 0;
                 }
             }
 
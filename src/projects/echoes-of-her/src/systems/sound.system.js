@@ -6,6 +6,21 @@ class SoundSystem {
             for (const soundKey in soundComponent.sounds) {
                 const soundData = soundComponent.sounds[soundKey];
 
+                // Looping sounds stay requested while isPlaying is set; playSound starts a new voice on every
+                // call, so only start one when none is running
+                if (soundData.loop) {
+                    if (soundData.isPlaying && !soundData.voiceId) {
+                        soundData.voiceId = Sound.playSound(soundData.soundId, soundData.volume, 0, 1, true);
+                    } else if (soundData.isStopping) {
+                        if (soundData.voiceId) {
+                            Sound.stopVoice(soundData.voiceId);
+                        }
+                        soundData.voiceId = 0;
+                        soundData.isStopping = false;
+                    }
+                    continue;
+                }
+
                 if (soundData.isPlaying) {
                     Sound.playSound(soundData.soundId);
                     soundData.isPlaying = false;
@@ -29,11 +44,6 @@ class SoundSystem {
                 toggleSoundComponent.isPlaying = false;
             }
         });
-
-        ECS.forEachEntity(['Music'], (entity, musicComponent) => {
-            Sound.playSound(musicComponent.musicId);
-            Sound.setSoundVolume(musicComponent.musicId, 0.5);
-        });
     }
 }
 
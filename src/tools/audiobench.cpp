@@ -0,0 +1,211 @@
+// audiobench.cpp
+//
+// Exercises the mixer without an audio device.
+//
+//   blipcade_audio_bench render <out.wav> [seconds]
+//     Renders a fixed scene of sampled and synth voices through every effect type and writes a float WAV. The
+//     printed hash changes whenever the mixed output does, so it can be compared across commits.
+//
+//   blipcade_audio_bench bench [seconds]
+//     Measures how many seconds of audio the mixer renders per second of wall time across voice and effect counts.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "compressor.h"
+#include "echo.h"
+#include "lowpass.h"
+#include "mixer.h"
+#include "offline.h"
+#include "reverb.h"
+
+using namespace blipcade::audio;
+
+namespace {
+    constexpr uint32_t BLOCK_FRAMES = 512;
+
+    // Half a second of decaying stereo tone, so the tool needs no files
+    SoundHandle addTone(Mixer &mixer, const float frequency) {
+        constexpr uint32_t frames = Mixer::SAMPLE_RATE / 2;
+        std::vector<float> samples(frames * 2);
+
+        for (uint32_t i = 0; i < frames; ++i) {
+            const auto t = static_cast<float>(i) / Mixer::SAMPLE_RATE;
+            const auto value = std::sin(6.2831853f * frequency * t) * std::exp(-4.0f * t) * 0.5f;
+            samples[i * 2] = value;
+            samples[i * 2 + 1] = value * 0.8f;
+        }
+
+        return mixer.addSound(samples.data(), frames, 2, Mixer::SAMPLE_RATE);
+    }
+
+    std::unique_ptr<Effect> makeEffect(const uint32_t index) {
+        switch (index % 4) {
+            case 0: return std::make_unique<Reverb>();
+            case 1: return std::make_unique<Echo>(0.25f, 0.4f, 0.3f);
+            case 2: return std::make_unique<LowPass>(2000.0f);
+            default: return std::make_unique<Compressor>();
+        }
+    }
+
+    uint64_t hashSamples(const std::vector<float> &samples) {
+        // FNV-1a over the raw bits
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const auto sample: samples) {
+            uint32_t bits;
+            std::memcpy(&bits, &sample, sizeof(bits));
+            for (int i = 0; i < 4; ++i) {
+                hash ^= (bits >> (i * 8)) & 0xff;
+                hash *= 0x100000001b3ull;
+            }
+        }
+        return hash;
+    }
+
+    int render(const std::string &path, const double seconds) {
+        Mixer mixer;
+        OfflineRenderer renderer(mixer, BLOCK_FRAMES);
+        renderer.setCapture(true);
+
+        const auto low = addTone(mixer, 220.0f);
+        const auto high = addTone(mixer, 660.0f);
+        mixer.setSoundSend(high, BUS_AMBIENCE, 0.5f);
+
+        Instrument lead;
+        lead.waveform = Waveform::Square;
+        lead.duty = 0.25f;
+        lead.arpeggio = {0.0f, 4.0f, 7.0f};
+        lead.arpeggioLength = 3;
+        const auto leadId = mixer.addInstrument(lead);
+
+        Instrument zap;
+        zap.waveform = Waveform::Saw;
+        zap.slide = -36.0f;
+        zap.release = 0.2f;
+        const auto zapId = mixer.addInstrument(zap);
+
+        Instrument hat;
+        hat.waveform = Waveform::Noise;
+        hat.decay = 0.03f;
+        hat.sustain = 0.0f;
+        const auto hatId = mixer.addInstrument(hat, BUS_UI);
+
+        mixer.addBusEffect(BUS_SFX, std::make_unique<Compressor>());
+        mixer.addBusEffect(BUS_AMBIENCE, std::make_unique<Reverb>());
+        mixer.addBusEffect(BUS_UI, std::make_unique<LowPass>(4000.0f));
+        mixer.addBusEffect(MASTER_BUS, std::make_unique<Echo>(0.3f, 0.3f, 0.2f));
+
+        // One bar every second, scheduled on the mixer clock so the result does not depend on block timing
+        constexpr uint64_t beat = Mixer::SAMPLE_RATE / 4;
+        const auto bars = static_cast<uint64_t>(std::ceil(seconds));
+
+        for (uint64_t bar = 0; bar < bars; ++bar) {
+            const auto start = bar * beat * 4;
+
+            mixer.play(low, {0.8f, -0.3f, 1.0f, false}, start);
+            mixer.play(high, {0.5f, 0.4f, bar % 2 ? 1.5f : 1.0f, false}, start + beat * 2);
+            mixer.playNote(zapId, 84.0f, 0.1f, {}, start + beat * 3);
+
+            for (uint64_t step = 0; step < 4; ++step) {
+                mixer.playNote(leadId, 60.0f + static_cast<float>(step * 2), 0.2f, {0.6f}, start + step * beat);
+                mixer.playNote(hatId, 100.0f, 0.02f, {0.3f, 0.5f}, start + step * beat + beat / 2);
+            }
+
+            // The queue is drained as the renderer goes, one bar ahead of it
+            renderer.advance(std::min(1.0, seconds - static_cast<double>(bar)));
+        }
+
+        // The blocks stop short of the requested length by up to one block
+        renderer.flush();
+
+        const auto &samples = renderer.getCapture();
+        const auto frames = samples.size() / Mixer::CHANNELS;
+
+        if (!writeWav(path, samples.data(), frames, Mixer::CHANNELS, Mixer::SAMPLE_RATE)) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return 1;
+        }
+
+        std::printf("%s: %llu frames, hash %016llx\n", path.c_str(), static_cast<unsigned long long>(frames),
+                    static_cast<unsigned long long>(hashSamples(samples)));
+        return 0;
+    }
+
+    double measure(const uint32_t voiceCount, const uint32_t effectCount, const double seconds) {
+        Mixer mixer;
+        OfflineRenderer renderer(mixer, BLOCK_FRAMES);
+
+        const auto tone = addTone(mixer, 440.0f);
+        Instrument instrument;
+
+        // Half sampled, half synth, spread over the default buses
+        for (uint32_t voice = 0; voice < voiceCount; ++voice) {
+            const auto bus = voice % 4;
+
+            if (voice % 2 == 0) {
+                mixer.setSoundBus(tone, bus);
+                mixer.play(tone, {0.1f, 0.0f, 1.0f + static_cast<float>(voice) * 0.01f, true});
+            } else {
+                mixer.playNote(mixer.addInstrument(instrument, bus), 48.0f + static_cast<float>(voice), 0.0f, {0.1f});
+            }
+        }
+
+        for (uint32_t effect = 0; effect < effectCount; ++effect) {
+            mixer.addBusEffect(effect % 4, makeEffect(effect));
+        }
+
+        // Warm up, then time
+        renderer.renderFrames(Mixer::SAMPLE_RATE / 10);
+
+        const auto started = std::chrono::steady_clock::now();
+        renderer.renderFrames(static_cast<uint64_t>(seconds * Mixer::SAMPLE_RATE));
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+        return seconds / elapsed.count();
+    }
+
+    int bench(const double seconds) {
+        constexpr uint32_t voiceCounts[] = {1, 8, 16, 32};
+        constexpr uint32_t effectCounts[] = {0, 4, 8, 16};
+
+        std::printf("Seconds of audio per wall second (x realtime), %u-frame blocks at %u Hz\n\n", BLOCK_FRAMES,
+                    Mixer::SAMPLE_RATE);
+        std::printf("voices \\ effects");
+        for (const auto effects: effectCounts) {
+            std::printf("%10u", effects);
+        }
+        std::printf("\n");
+
+        for (const auto voices: voiceCounts) {
+            std::printf("%16u", voices);
+            for (const auto effects: effectCounts) {
+                std::printf("%10.0f", measure(voices, effects, seconds));
+            }
+            std::printf("\n");
+        }
+
+        return 0;
+    }
+}
+
+int main(const int argc, char **argv) {
+    const std::string mode = argc >= 2 ? argv[1] : "";
+
+    if (mode == "render" && argc >= 3) {
+        return render(argv[2], argc >= 4 ? std::atof(argv[3]) : 8.0);
+    }
+
+    if (mode == "bench") {
+        return bench(argc >= 3 ? std::atof(argv[2]) : 10.0);
+    }
+
+    std::fprintf(stderr, "Usage: %s render <out.wav> [seconds] | bench [seconds]\n", argv[0]);
+    return 1;
+}
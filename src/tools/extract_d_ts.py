@@ -137,7 +137,7 @@ def parse_param(line):
     """
     param_regex = re.compile(
         r'@param\s+'
-        r'(?:\{([\w\[\]]+)\}\s+)?'                  # Optional {type}, supports array types like number[]
+        r'(?:\{([\w\[\]|]+)\}\s+)?'                 # Optional {type}, supports number[] and unions like number|string
         r'(?:\[(?:([\w.\-]+))(?:=([^\]]+))?\]|\b([\w.\-]+))'  # [name=default] or name, allowing dots and hyphens
         r'(?:\s*-\s*)?'                             # Optional - separator
         r'(.*)'                                      # Description
@@ -235,6 +235,9 @@ def map_type(jsdoc_type):
         'promise': 'Promise<any>',
         # Add more mappings as needed
     }
+    # Handle unions like number|string
+    if '|' in jsdoc_type:
+        return ' | '.join(map_type(part) for part in jsdoc_type.split('|'))
     # Handle array types like number[]
     array_match = re.match(r'(\w+)\[\]', jsdoc_type)
     if array_match:
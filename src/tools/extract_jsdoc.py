@@ -90,7 +90,7 @@ def parse_jsdoc(comment):
             # Existing param handling
             param_regex = re.compile(
                 r'@param\s+'
-                r'(?:\{(\w+)\}\s+)?'                  # Optional {type}
+                r'(?:\{([\w|]+)\}\s+)?'               # Optional {type}, unions like number|string
                 r'(?:\[(?:([\w.]+))(?:=([^\]]+))?\]|\b([\w.]+))'  # [name=default] or name, allowing dots
                 r'(?:\s*-\s*)?'                       # Optional - separator
                 r'(.*)'                                # Description
@@ -0,0 +1,129 @@
+// renderbench.cpp
+//
+// Times the software renderer's row kernels and palette resolve at every SIMD level this CPU supports, on a fixed
+// 320x240 frame.
+//
+//   blipcade_render_bench [iterations]
+//     Prints microseconds per full frame for each kernel and level. Every level's output is checked against the
+//     scalar one, so a mismatch is reported rather than timed.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "blit.h"
+#include "cpufeatures.h"
+#include "paletteresolver.h"
+
+using namespace blipcade::graphics;
+
+namespace {
+    constexpr std::size_t WIDTH = 320;
+    constexpr std::size_t HEIGHT = 240;
+    constexpr uint8_t TRANSPARENT = 0;
+
+    // Roughly a third transparent, in runs, like a sprite sheet
+    std::vector<uint8_t> makeSource() {
+        std::vector<uint8_t> pixels(WIDTH * HEIGHT);
+        uint32_t state = 12345;
+
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            state = state * 1664525u + 1013904223u;
+            const auto run = (i / 7 + (state >> 28)) % 3 == 0;
+            pixels[i] = run ? TRANSPARENT : static_cast<uint8_t>(1 + (state >> 24) % 255);
+        }
+
+        return pixels;
+    }
+
+    // Processes one whole frame into `frame`
+    using Kernel = std::function<void(uint8_t *frame)>;
+
+    struct Result {
+        double microseconds;
+        std::vector<uint8_t> frame;
+    };
+
+    Result measure(const Kernel &kernel, const std::size_t frameBytes, const int iterations) {
+        std::vector<uint8_t> frame(frameBytes, 7);
+
+        // One untimed frame warms the caches and gives the output to compare
+        kernel(frame.data());
+        auto first = frame;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            kernel(frame.data());
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+        return {elapsed.count() / iterations, std::move(first)};
+    }
+}
+
+int main(const int argc, char **argv) {
+    const auto iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    const auto source = makeSource();
+    const auto best = simdLevel();
+    std::array<uint8_t, 256> remap{};
+    std::array<Color, 256> palette{};
+    for (std::size_t i = 0; i < remap.size(); ++i) {
+        remap[i] = static_cast<uint8_t>(255 - i);
+        palette[i] = {static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3), static_cast<uint8_t>(i * 7), 255};
+    }
+
+    const auto rows = [&source](const auto &row) {
+        return [&source, row](uint8_t *frame) {
+            for (std::size_t y = 0; y < HEIGHT; ++y) {
+                row(frame + y * WIDTH, source.data() + y * WIDTH);
+            }
+        };
+    };
+
+    const struct {
+        const char *name;
+        std::size_t bytesPerPixel;
+        Kernel kernel;
+    } kernels[] = {
+        {"masked", 1, rows([](uint8_t *dst, const uint8_t *src) { blitMaskedRow(dst, src, WIDTH, TRANSPARENT); })},
+        {"masked reversed", 1, rows([](uint8_t *dst, const uint8_t *src) {
+            blitMaskedRowReversed(dst, src, WIDTH, TRANSPARENT);
+        })},
+        {"remapped", 1, rows([&remap](uint8_t *dst, const uint8_t *src) {
+            blitRemappedRow(dst, src, WIDTH, TRANSPARENT, false, remap);
+        })},
+        {"palette resolve", sizeof(Color), [&](uint8_t *frame) {
+            PaletteResolver::resolveSpan(source.data(), reinterpret_cast<Color *>(frame), WIDTH * HEIGHT, palette);
+        }},
+    };
+
+    std::printf("%zux%zu frame, %d iterations, cpu supports %s\n", WIDTH, HEIGHT, iterations, simdLevelName(best));
+
+    bool mismatch = false;
+    for (const auto &[name, bytesPerPixel, kernel]: kernels) {
+        const auto frameBytes = WIDTH * HEIGHT * bytesPerPixel;
+
+        setSimdLimit(SimdLevel::Scalar);
+        const auto scalar = measure(kernel, frameBytes, iterations);
+        std::printf("%-16s %-6s %8.2f us\n", name, simdLevelName(SimdLevel::Scalar), scalar.microseconds);
+
+        for (auto level = SimdLevel::Sse2; level <= best; level = static_cast<SimdLevel>(static_cast<int>(level) + 1)) {
+            setSimdLimit(level);
+            const auto result = measure(kernel, frameBytes, iterations);
+            const auto matches = result.frame == scalar.frame;
+            mismatch |= !matches;
+            std::printf("%-16s %-6s %8.2f us  %.1fx%s\n", name, simdLevelName(level), result.microseconds,
+                        scalar.microseconds / result.microseconds, matches ? "" : "  OUTPUT MISMATCH");
+        }
+    }
+
+    return mismatch ? 1 : 0;
+}